@@ -1,8 +1,16 @@
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include "make_unique.h"
 #include "BasicBlock.h"
 #include "MemStream.h"
 #include "offsetof_def.h"
 #include "MipsJitter.h"
 #include "Jitter_CodeGenFactory.h"
+#include "BlockCodeCache.h"
+#include "PerfMap.h"
+#include "string_format.h"
+#include <zlib.h>
 
 #if defined(AOT_BUILD_CACHE) || defined(AOT_USE_CACHE)
 #define AOT_ENABLED
@@ -10,7 +18,6 @@
 
 #ifdef AOT_ENABLED
 
-#include <zlib.h>
 #include "StdStream.h"
 #include "StdStreamUtils.h"
 
@@ -18,7 +25,6 @@
 
 #ifdef VTUNE_ENABLED
 #include <jitprofiling.h>
-#include "string_format.h"
 #endif
 
 #ifdef AOT_USE_CACHE
@@ -42,12 +48,20 @@ CBasicBlock::CBasicBlock(CMIPS& context, uint32 begin, uint32 end)
 : m_begin(begin)
 , m_end(end)
 , m_context(context)
+, m_compiled(false)
 , m_selfLoopCount(0)
 #ifdef AOT_USE_CACHE
 , m_function(nullptr)
 #endif
 {
 	assert(m_end >= m_begin);
+	if(CPerfMap::GetInstance().IsEnabled())
+	{
+		if(auto functionTag = m_context.m_Functions.Find(m_begin))
+		{
+			m_functionTag = functionTag;
+		}
+	}
 }
 
 CBasicBlock::~CBasicBlock()
@@ -55,6 +69,23 @@ CBasicBlock::~CBasicBlock()
 
 }
 
+std::atomic<uint64>		CBasicBlock::m_compiledBlockCount(0);
+std::atomic<uint64>		CBasicBlock::m_compileTime(0);
+
+CBasicBlock::COMPILE_STATS CBasicBlock::GetCompileStats()
+{
+	COMPILE_STATS stats;
+	stats.blockCount = m_compiledBlockCount;
+	stats.compileTime = m_compileTime;
+	return stats;
+}
+
+void CBasicBlock::ResetCompileStats()
+{
+	m_compiledBlockCount = 0;
+	m_compileTime = 0;
+}
+
 #ifdef AOT_BUILD_CACHE
 
 Framework::CStdStream*	CBasicBlock::m_aotBlockOutputStream(nullptr);
@@ -68,40 +99,89 @@ void CBasicBlock::SetAotBlockOutputStream(Framework::CStdStream* outputStream)
 
 #endif
 
-void CBasicBlock::Compile()
+void CBasicBlock::Compile(CBlockCodeCache* codeCache)
 {
+	auto compileStartTime = std::chrono::high_resolution_clock::now();
+
+	FindBranchTarget();
+
 #ifndef AOT_USE_CACHE
 
-	Framework::CMemStream stream;
+	AOT_BLOCK_KEY blockKey = {};
+	CBlockCodeCache::CodeBuffer cachedCode;
+	bool mustVerifyCachedCode = false;
+	if(codeCache)
 	{
-		static
-#ifdef AOT_BUILD_CACHE
-		__declspec(thread)
-#endif
-		CMipsJitter* jitter = nullptr;
-		if(jitter == nullptr)
+		blockKey.crc   = ComputeChecksum();
+		blockKey.begin = m_begin;
+		blockKey.end   = m_end;
+	}
+
+	if(codeCache && codeCache->Find(blockKey, cachedCode, mustVerifyCachedCode) && !mustVerifyCachedCode)
+	{
+		m_function = CMemoryFunction(cachedCode.data(), cachedCode.size());
+	}
+	else
+	{
+		Framework::CMemStream stream;
+		CBlockCodeCache::RelocationArray relocations;
 		{
-			Jitter::CCodeGen* codeGen = Jitter::CreateCodeGen();
-			jitter = new CMipsJitter(codeGen);
+			//Blocks are compiled from more than one thread (IOP thread, compile threads), each one has its own jitter
+			static thread_local std::unique_ptr<CMipsJitter> jitterPtr;
+			if(!jitterPtr)
+			{
+				Jitter::CCodeGen* codeGen = Jitter::CreateCodeGen();
+				jitterPtr = std::make_unique<CMipsJitter>(codeGen);
+
+				for(unsigned int i = 0; i < 4; i++)
+				{
+					jitterPtr->SetVariableAsConstant(
+						offsetof(CMIPS, m_State.nGPR[CMIPS::R0].nV[i]),
+						0
+						);
+				}
+			}
 
-			for(unsigned int i = 0; i < 4; i++)
+			auto jitter = jitterPtr.get();
+			if(codeCache)
+			{
+				//Keep track of the functions called by the block, they need to be relocated when the cache is reloaded
+				jitter->GetCodeGen()->SetExternalSymbolReferencedHandler(
+					[&relocations] (uintptr_t symbol, uint32 offset)
+					{
+						CBlockCodeCache::RELOCATION relocation;
+						relocation.offset = offset;
+						relocation.symbol = symbol;
+						relocations.push_back(relocation);
+					}
+				);
+			}
+			else
 			{
-				jitter->SetVariableAsConstant(
-					offsetof(CMIPS, m_State.nGPR[CMIPS::R0].nV[i]),
-					0
-					);
+				jitter->GetCodeGen()->SetExternalSymbolReferencedHandler(nullptr);
 			}
+
+			jitter->SetStream(&stream);
+			jitter->Begin();
+			CompileRange(jitter);
+//			codeGen.DumpVariables(0);
+//			codeGen.EndQuota();
+			jitter->End();
 		}
 
-		jitter->SetStream(&stream);
-		jitter->Begin();
-		CompileRange(jitter);
-//		codeGen.DumpVariables(0);
-//		codeGen.EndQuota();
-		jitter->End();
-	}
+		//Instructions might have been modified while the block was being compiled on another thread,
+		//don't let the cache keep code that doesn't match the checksum
+		if(codeCache && (ComputeChecksum() == blockKey.crc))
+		{
+			CBlockCodeCache::ApplyRelocations(stream.GetBuffer(), stream.GetSize(), relocations);
+			if(!mustVerifyCachedCode || !codeCache->Verify(cachedCode, stream.GetBuffer(), stream.GetSize()))
+			{
+				codeCache->Insert(blockKey, stream.GetBuffer(), stream.GetSize(), relocations);
+			}
+		}
 
-	m_function = CMemoryFunction(stream.GetBuffer(), stream.GetSize());
+		m_function = CMemoryFunction(stream.GetBuffer(), stream.GetSize());
+	}
 	
 #ifdef VTUNE_ENABLED
 	if(iJIT_IsProfilingActive() == iJIT_SAMPLING_ON)
@@ -115,13 +195,23 @@ void CBasicBlock::Compile()
 		jmethod.method_size = m_function.GetSize();
 		jmethod.line_number_size = 0;
 
-		auto functionName = string_format("BasicBlock_0x%0.8X_0x%0.8X", m_begin, m_end);
+		auto functionName = GetName();
 
 		jmethod.method_name = const_cast<char*>(functionName.c_str());
 		iJIT_NotifyEvent(iJVM_EVENT_TYPE_METHOD_LOAD_FINISHED, reinterpret_cast<void*>(&jmethod));
 	}
 #endif
 
+	if(CPerfMap::GetInstance().IsEnabled())
+	{
+		auto functionName = GetName();
+		if(!m_functionTag.empty())
+		{
+			functionName += " " + m_functionTag;
+		}
+		CPerfMap::GetInstance().AddFunction(m_function.GetCode(), m_function.GetSize(), functionName.c_str());
+	}
+
 #endif
 
 #ifdef AOT_ENABLED
@@ -176,6 +266,37 @@ void CBasicBlock::Compile()
 		m_aotBlockOutputStream->Write(blockData, blockSize * 4);
 	}
 #endif
+
+	auto compileEndTime = std::chrono::high_resolution_clock::now();
+	m_compiledBlockCount++;
+	m_compileTime += std::chrono::duration_cast<std::chrono::microseconds>(compileEndTime - compileStartTime).count();
+
+	m_compiled = true;
+}
+
+void CBasicBlock::FindBranchTarget()
+{
+	//Branches always end a block, so the last static branch we find is the one
+	//that will decide where execution goes when leaving this block
+	m_branchTarget = MIPS_INVALID_PC;
+	for(uint32 address = m_begin; address <= m_end; address += 4)
+	{
+		uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
+		auto branchType = m_context.m_pArch->IsInstructionBranch(&m_context, address, opcode);
+		if(branchType != MIPS_BRANCH_NORMAL) continue;
+		m_branchTarget = m_context.m_pArch->GetInstructionEffectiveAddress(&m_context, address, opcode);
+	}
+}
+
+uint32 CBasicBlock::ComputeChecksum() const
+{
+	uint32 checksum = crc32(0, Z_NULL, 0);
+	for(uint32 address = m_begin; address <= m_end; address += 4)
+	{
+		uint32 opcode = m_context.m_pMemoryMap->GetWord(address);
+		checksum = crc32(checksum, reinterpret_cast<const Bytef*>(&opcode), 4);
+	}
+	return checksum;
 }
 
 void CBasicBlock::CompileRange(CMipsJitter* jitter)
@@ -230,13 +351,14 @@ uint32 CBasicBlock::GetEndAddress() const
 	return m_end;
 }
 
+std::string CBasicBlock::GetName() const
+{
+	return string_format("BasicBlock_0x%0.8X_0x%0.8X", m_begin, m_end);
+}
+
 bool CBasicBlock::IsCompiled() const
 {
-#ifndef AOT_USE_CACHE
-	return !m_function.IsEmpty();
-#else
-	return (m_function != nullptr);
-#endif
+	return m_compiled;
 }
 
 unsigned int CBasicBlock::GetSelfLoopCount() const
@@ -248,3 +370,72 @@ void CBasicBlock::SetSelfLoopCount(unsigned int selfLoopCount)
 {
 	m_selfLoopCount = selfLoopCount;
 }
+
+uint32 CBasicBlock::GetBranchTarget() const
+{
+	return m_branchTarget;
+}
+
+LINK_SLOT CBasicBlock::FindLinkSlot(uint32 address) const
+{
+	for(unsigned int i = 0; i < LINK_SLOT_MAX; i++)
+	{
+		if(m_linkedBlock[i] && (m_linkedBlockAddress[i] == address))
+		{
+			return static_cast<LINK_SLOT>(i);
+		}
+	}
+	return LINK_SLOT_MAX;
+}
+
+CBasicBlock* CBasicBlock::GetLinkedBlock(LINK_SLOT slot) const
+{
+	assert(slot < LINK_SLOT_MAX);
+	return m_linkedBlock[slot];
+}
+
+uint32 CBasicBlock::GetLinkedBlockAddress(LINK_SLOT slot) const
+{
+	assert(slot < LINK_SLOT_MAX);
+	return m_linkedBlockAddress[slot];
+}
+
+void CBasicBlock::SetLinkedBlock(LINK_SLOT slot, uint32 address, CBasicBlock* block)
+{
+	assert(slot < LINK_SLOT_MAX);
+	m_linkedBlock[slot] = block;
+	m_linkedBlockAddress[slot] = address;
+	m_linkUseCount[slot] = 0;
+}
+
+unsigned int CBasicBlock::GetLinkUseCount(LINK_SLOT slot) const
+{
+	assert(slot < LINK_SLOT_MAX);
+	return m_linkUseCount[slot];
+}
+
+unsigned int CBasicBlock::IncrementLinkUseCount(LINK_SLOT slot)
+{
+	assert(slot < LINK_SLOT_MAX);
+	return ++m_linkUseCount[slot];
+}
+
+CBasicBlock* CBasicBlock::GetSuperBlock() const
+{
+	return m_superBlock;
+}
+
+void CBasicBlock::SetSuperBlock(CBasicBlock* superBlock)
+{
+	m_superBlock = superBlock;
+}
+
+uint64 CBasicBlock::GetExecutionCount() const
+{
+	return m_executionCount;
+}
+
+void CBasicBlock::IncrementExecutionCount()
+{
+	m_executionCount++;
+}
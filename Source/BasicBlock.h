@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <string>
 #include "MIPS.h"
 #include "MemoryFunction.h"
 #ifdef AOT_BUILD_CACHE
@@ -35,25 +37,58 @@ struct AOT_BLOCK_KEY
 };
 static_assert(sizeof(AOT_BLOCK_KEY) == 0x0C, "AOT_BLOCK_KEY must be 12 bytes long.");
 
+enum LINK_SLOT
+{
+	LINK_SLOT_NEXT,
+	LINK_SLOT_BRANCH,
+	LINK_SLOT_MAX,
+};
+
 namespace Jitter
 {
 	class CJitter;
 };
 
+class CBlockCodeCache;
+
 class CBasicBlock
 {
 public:
+	struct COMPILE_STATS
+	{
+		uint64		blockCount = 0;
+		uint64		compileTime = 0;	//In microseconds
+	};
+
 									CBasicBlock(CMIPS&, uint32, uint32);
 	virtual							~CBasicBlock();
-	unsigned int					Execute();
-	void							Compile();
+	virtual unsigned int			Execute();
+	void							Compile(CBlockCodeCache* = nullptr);
 
 	uint32							GetBeginAddress() const;
 	uint32							GetEndAddress() const;
+	virtual std::string				GetName() const;
 	bool							IsCompiled() const;
 	unsigned int					GetSelfLoopCount() const;
 	void							SetSelfLoopCount(unsigned int);
 
+	uint32							GetBranchTarget() const;
+	LINK_SLOT						FindLinkSlot(uint32) const;
+	CBasicBlock*					GetLinkedBlock(LINK_SLOT) const;
+	uint32							GetLinkedBlockAddress(LINK_SLOT) const;
+	void							SetLinkedBlock(LINK_SLOT, uint32, CBasicBlock*);
+	unsigned int					GetLinkUseCount(LINK_SLOT) const;
+	unsigned int					IncrementLinkUseCount(LINK_SLOT);
+
+	CBasicBlock*					GetSuperBlock() const;
+	void							SetSuperBlock(CBasicBlock*);
+
+	uint64							GetExecutionCount() const;
+	void							IncrementExecutionCount();
+
+	static COMPILE_STATS			GetCompileStats();
+	static void						ResetCompileStats();
+
 #ifdef AOT_BUILD_CACHE
 	static void						SetAotBlockOutputStream(Framework::CStdStream*);
 #endif
@@ -64,19 +99,39 @@ protected:
 	CMIPS&							m_context;
 
 	virtual void					CompileRange(CMipsJitter*);
+	virtual uint32					ComputeChecksum() const;
+
+#ifndef AOT_USE_CACHE
+	CMemoryFunction					m_function;
+#else
+	void							(*m_function)(void*);
+#endif
 
 private:
+	void							FindBranchTarget();
+
+	static std::atomic<uint64>		m_compiledBlockCount;
+	static std::atomic<uint64>		m_compileTime;
 
 #ifdef AOT_BUILD_CACHE
 	static Framework::CStdStream*	m_aotBlockOutputStream;
 	static std::mutex				m_aotBlockOutputStreamMutex;
 #endif
 
-#ifndef AOT_USE_CACHE
-	CMemoryFunction					m_function;
-#else
-	void							(*m_function)(void*);
-#endif
-
+	//Set once m_function is ready, blocks can be compiled on another thread than the one executing them
+	std::atomic<bool>				m_compiled;
 	unsigned int					m_selfLoopCount;
+
+	uint32							m_branchTarget = MIPS_INVALID_PC;
+	CBasicBlock*					m_linkedBlock[LINK_SLOT_MAX] = {};
+	uint32							m_linkedBlockAddress[LINK_SLOT_MAX] = {};
+	unsigned int					m_linkUseCount[LINK_SLOT_MAX] = {};
+
+	//Superblock starting with this block, executed in its place
+	CBasicBlock*					m_superBlock = nullptr;
+
+	uint64							m_executionCount = 0;
+
+	//Function tags are changed by the emulation thread, keep our own copy for the compile thread
+	std::string						m_functionTag;
 };
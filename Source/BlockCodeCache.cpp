@@ -0,0 +1,260 @@
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include "BlockCodeCache.h"
+#include "MIPS.h"
+#include "offsetof_def.h"
+#include "string_format.h"
+
+#define CODECACHE_MAGIC		(0x4354494A)	//'JITC'
+#define CODECACHE_VERSION	(3)
+
+//Everything called by the generated code lives in the same image as this function
+static void CodeCacheAnchor()
+{
+
+}
+
+bool CBlockCodeCache::IsSupported()
+{
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+	return true;
+#else
+	//ARM code generators emit relative branches to called functions, those can't be relocated
+	//once the code has been moved to a different place in memory
+	return false;
+#endif
+}
+
+void CBlockCodeCache::ApplyRelocations(uint8* code, uint32 size, const RelocationArray& relocations)
+{
+	for(const auto& relocation : relocations)
+	{
+		if((relocation.offset + sizeof(uintptr_t)) > size)
+		{
+			throw std::runtime_error("Relocation is outside of block code.");
+		}
+		memcpy(code + relocation.offset, &relocation.symbol, sizeof(uintptr_t));
+	}
+}
+
+bool CBlockCodeCache::Find(const AOT_BLOCK_KEY& key, CodeBuffer& code, bool& mustVerify)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto blockIterator = m_blocks.find(key);
+	if(blockIterator == std::end(m_blocks))
+	{
+		return false;
+	}
+	code = blockIterator->second.code;
+	//Caller needs to compile the block and give us its code until we know the cache matches what our jitters generate
+	mustVerify = (m_verifiedBlockCount < VERIFY_BLOCK_COUNT);
+	return true;
+}
+
+bool CBlockCodeCache::Verify(const CodeBuffer& cachedCode, const uint8* code, uint32 size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if((cachedCode.size() == size) && (memcmp(cachedCode.data(), code, size) == 0))
+	{
+		m_verifiedBlockCount++;
+		return true;
+	}
+	//Cache was made by a build that generates different code, anything inserted from now on is up to date
+	m_blocks.clear();
+	m_symbols.clear();
+	m_symbolIndices.clear();
+	m_dirty = true;
+	m_verifiedBlockCount = VERIFY_BLOCK_COUNT;
+	return false;
+}
+
+void CBlockCodeCache::Insert(const AOT_BLOCK_KEY& key, const uint8* code, uint32 size, const RelocationArray& relocations)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	BLOCK block;
+	block.code = CodeBuffer(code, code + size);
+	for(const auto& relocation : relocations)
+	{
+		BLOCK_RELOCATION blockRelocation;
+		blockRelocation.offset = relocation.offset;
+		blockRelocation.symbolIndex = GetSymbolIndex(relocation.symbol);
+		block.relocations.push_back(blockRelocation);
+	}
+	m_blocks[key] = std::move(block);
+	m_dirty = true;
+}
+
+void CBlockCodeCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_blocks.clear();
+	m_symbols.clear();
+	m_symbolIndices.clear();
+	m_dirty = false;
+	m_verifiedBlockCount = VERIFY_BLOCK_COUNT;
+}
+
+bool CBlockCodeCache::IsDirty()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_dirty;
+}
+
+uint32 CBlockCodeCache::GetBlockCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return static_cast<uint32>(m_blocks.size());
+}
+
+void CBlockCodeCache::Load(Framework::CStream& stream)
+{
+	uint32 magic = stream.Read32();
+	uint32 version = stream.Read32();
+	uint32 pointerSize = stream.Read32();
+	if((magic != CODECACHE_MAGIC) || (version != CODECACHE_VERSION) || (pointerSize != sizeof(uintptr_t)))
+	{
+		throw std::runtime_error("Unsupported code cache file.");
+	}
+
+	//Make sure the code was generated for the same context layout
+	std::string buildTag(stream.Read32(), 0);
+	stream.Read(&buildTag[0], buildTag.size());
+	if(buildTag != GetBuildTag())
+	{
+		throw std::runtime_error("Code cache was created by a different build.");
+	}
+
+	SymbolArray symbols;
+	SymbolIndexMap symbolIndices;
+	uint32 symbolCount = stream.Read32();
+	for(uint32 i = 0; i < symbolCount; i++)
+	{
+		int64 symbolOffset = static_cast<int64>(stream.Read64());
+		uint8 signature[SYMBOL_SIGNATURE_SIZE];
+		stream.Read(signature, SYMBOL_SIGNATURE_SIZE);
+		uintptr_t symbol = GetAnchorAddress() + static_cast<intptr_t>(symbolOffset);
+		if(memcmp(reinterpret_cast<const void*>(symbol), signature, SYMBOL_SIGNATURE_SIZE) != 0)
+		{
+			throw std::runtime_error("Code cache symbol doesn't match.");
+		}
+		symbolIndices.insert(std::make_pair(symbol, static_cast<uint32>(symbols.size())));
+		symbols.push_back(symbol);
+	}
+
+	BlockMap blocks;
+	uint32 blockCount = stream.Read32();
+	for(uint32 i = 0; i < blockCount; i++)
+	{
+		AOT_BLOCK_KEY key = {};
+		key.crc   = stream.Read32();
+		key.begin = stream.Read32();
+		key.end   = stream.Read32();
+
+		BLOCK block;
+		uint32 codeSize = stream.Read32();
+		block.code.resize(codeSize);
+		if(stream.Read(block.code.data(), codeSize) != codeSize)
+		{
+			throw std::runtime_error("Code cache file is truncated.");
+		}
+
+		RelocationArray relocations;
+		uint32 relocationCount = stream.Read32();
+		for(uint32 j = 0; j < relocationCount; j++)
+		{
+			BLOCK_RELOCATION blockRelocation;
+			blockRelocation.offset      = stream.Read32();
+			blockRelocation.symbolIndex = stream.Read32();
+			if(blockRelocation.symbolIndex >= symbols.size())
+			{
+				throw std::runtime_error("Invalid symbol index in code cache.");
+			}
+			RELOCATION relocation;
+			relocation.offset = blockRelocation.offset;
+			relocation.symbol = symbols[blockRelocation.symbolIndex];
+			relocations.push_back(relocation);
+			block.relocations.push_back(blockRelocation);
+		}
+		ApplyRelocations(block.code.data(), codeSize, relocations);
+
+		blocks[key] = std::move(block);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_blocks = std::move(blocks);
+	m_symbols = std::move(symbols);
+	m_symbolIndices = std::move(symbolIndices);
+	m_dirty = false;
+	m_verifiedBlockCount = 0;
+}
+
+void CBlockCodeCache::Save(Framework::CStream& stream)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	stream.Write32(CODECACHE_MAGIC);
+	stream.Write32(CODECACHE_VERSION);
+	stream.Write32(sizeof(uintptr_t));
+	auto buildTag = GetBuildTag();
+	stream.Write32(static_cast<uint32>(buildTag.size()));
+	stream.Write(buildTag.data(), buildTag.size());
+
+	stream.Write32(static_cast<uint32>(m_symbols.size()));
+	for(const auto& symbol : m_symbols)
+	{
+		stream.Write64(static_cast<uint64>(symbol - GetAnchorAddress()));
+		stream.Write(reinterpret_cast<const void*>(symbol), SYMBOL_SIGNATURE_SIZE);
+	}
+
+	stream.Write32(static_cast<uint32>(m_blocks.size()));
+	for(const auto& blockPair : m_blocks)
+	{
+		const auto& key = blockPair.first;
+		const auto& block = blockPair.second;
+		stream.Write32(key.crc);
+		stream.Write32(key.begin);
+		stream.Write32(key.end);
+		stream.Write32(static_cast<uint32>(block.code.size()));
+		stream.Write(block.code.data(), block.code.size());
+		stream.Write32(static_cast<uint32>(block.relocations.size()));
+		for(const auto& relocation : block.relocations)
+		{
+			stream.Write32(relocation.offset);
+			stream.Write32(relocation.symbolIndex);
+		}
+	}
+
+	m_dirty = false;
+}
+
+uintptr_t CBlockCodeCache::GetAnchorAddress()
+{
+	return reinterpret_cast<uintptr_t>(&CodeCacheAnchor);
+}
+
+std::string CBlockCodeCache::GetBuildTag()
+{
+	//Generated code accesses the context through fixed offsets
+	return string_format("%d:%d:%d:%d:%d:%d:%d",
+		static_cast<int>(sizeof(CMIPS)),
+		static_cast<int>(sizeof(MIPSSTATE)),
+		static_cast<int>(offsetof(CMIPS, m_State)),
+		static_cast<int>(offsetof(CMIPS, m_vuMem)),
+		static_cast<int>(offsetof(CMIPS, m_fastMemRam)),
+		static_cast<int>(offsetof(CMIPS, m_fastMemScratchpad)),
+		static_cast<int>(offsetof(CMIPS, m_superBlockExitIndex)));
+}
+
+uint32 CBlockCodeCache::GetSymbolIndex(uintptr_t symbol)
+{
+	auto symbolIterator = m_symbolIndices.find(symbol);
+	if(symbolIterator != std::end(m_symbolIndices))
+	{
+		return symbolIterator->second;
+	}
+	uint32 symbolIndex = static_cast<uint32>(m_symbols.size());
+	m_symbols.push_back(symbol);
+	m_symbolIndices.insert(std::make_pair(symbol, symbolIndex));
+	return symbolIndex;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <mutex>
+#include "Types.h"
+#include "Stream.h"
+#include "BasicBlock.h"
+
+//Keeps the code generated for basic blocks so it can be saved to disk and reused by later runs.
+//Blocks are identified by their address range and the checksum of their instructions.
+//Addresses of functions called by the generated code are saved relative to the executable's
+//image and are relocated when the cache is loaded. Code from a loaded cache is only trusted once
+//the first blocks found in it were compiled again and matched, the whole cache is dropped otherwise.
+class CBlockCodeCache
+{
+public:
+	typedef std::vector<uint8> CodeBuffer;
+
+	struct RELOCATION
+	{
+		uint32		offset;
+		uintptr_t	symbol;
+	};
+	typedef std::vector<RELOCATION> RelocationArray;
+
+	static bool				IsSupported();
+	static void				ApplyRelocations(uint8*, uint32, const RelocationArray&);
+
+	bool					Find(const AOT_BLOCK_KEY&, CodeBuffer&, bool&);
+	bool					Verify(const CodeBuffer&, const uint8*, uint32);
+	void					Insert(const AOT_BLOCK_KEY&, const uint8*, uint32, const RelocationArray&);
+	void					Clear();
+
+	bool					IsDirty();
+	uint32					GetBlockCount();
+
+	void					Load(Framework::CStream&);
+	void					Save(Framework::CStream&);
+
+private:
+	enum
+	{
+		SYMBOL_SIGNATURE_SIZE = 0x10,
+		VERIFY_BLOCK_COUNT = 0x20,
+	};
+
+	struct BLOCK_RELOCATION
+	{
+		uint32		offset;
+		uint32		symbolIndex;
+	};
+	typedef std::vector<BLOCK_RELOCATION> BlockRelocationArray;
+
+	struct BLOCK
+	{
+		CodeBuffer				code;
+		BlockRelocationArray	relocations;
+	};
+
+	typedef std::map<AOT_BLOCK_KEY, BLOCK> BlockMap;
+	typedef std::vector<uintptr_t> SymbolArray;
+	typedef std::map<uintptr_t, uint32> SymbolIndexMap;
+
+	static uintptr_t		GetAnchorAddress();
+	static std::string		GetBuildTag();
+
+	uint32					GetSymbolIndex(uintptr_t);
+
+	std::mutex				m_mutex;
+	BlockMap				m_blocks;
+	SymbolArray				m_symbols;
+	SymbolIndexMap			m_symbolIndices;
+	bool					m_dirty = false;
+	unsigned int			m_verifiedBlockCount = VERIFY_BLOCK_COUNT;
+};
@@ -0,0 +1,143 @@
+#include <thread>
+#include <cassert>
+#include "CommandRing.h"
+#include "AlignedAlloc.h"
+
+CCommandRing::CCommandRing(uint32 size)
+: m_size(size)
+, m_writePosition(0)
+, m_readPosition(0)
+, m_consumerWaiting(false)
+{
+	//Size must be a power of 2
+	assert((size & (size - 1)) == 0);
+	assert(size >= (COMMAND_ALIGN * 2));
+	m_buffer = reinterpret_cast<uint8*>(framework_aligned_alloc(size, COMMAND_ALIGN));
+}
+
+CCommandRing::~CCommandRing()
+{
+	framework_aligned_free(m_buffer);
+}
+
+uint32 CCommandRing::GetMaxCommandSize() const
+{
+	//Limit the size of commands to make sure we can always fit one, even if we need to wrap around
+	return (m_size / 2) - sizeof(COMMANDHEADER);
+}
+
+uint32 CCommandRing::GetCommandSpace(uint32 size)
+{
+	return (sizeof(COMMANDHEADER) + size + (COMMAND_ALIGN - 1)) & ~(COMMAND_ALIGN - 1);
+}
+
+void* CCommandRing::BeginCommand(uint32 type, uint32 size)
+{
+	//Wait for the consumer to free enough space
+	void* command = nullptr;
+	while((command = TryBeginCommand(type, size)) == nullptr)
+	{
+		std::this_thread::yield();
+	}
+	return command;
+}
+
+void* CCommandRing::TryBeginCommand(uint32 type, uint32 size)
+{
+	assert(type != COMMAND_WRAP);
+	assert(size <= GetMaxCommandSize());
+
+	uint64 writePosition = m_writePosition.load(std::memory_order_relaxed);
+	uint32 writeOffset = static_cast<uint32>(writePosition & (m_size - 1));
+	uint32 commandSpace = GetCommandSpace(size);
+	uint32 wrapSpace = ((writeOffset + commandSpace) > m_size) ? (m_size - writeOffset) : 0;
+
+	if((writePosition + wrapSpace + commandSpace - m_readPosition.load(std::memory_order_acquire)) > m_size)
+	{
+		return nullptr;
+	}
+
+	if(wrapSpace != 0)
+	{
+		auto wrapHeader = reinterpret_cast<COMMANDHEADER*>(m_buffer + writeOffset);
+		wrapHeader->type = COMMAND_WRAP;
+		wrapHeader->size = wrapSpace - sizeof(COMMANDHEADER);
+		writeOffset = 0;
+	}
+
+	auto header = reinterpret_cast<COMMANDHEADER*>(m_buffer + writeOffset);
+	header->type = type;
+	header->size = size;
+
+	m_pendingWritePosition = writePosition + wrapSpace + commandSpace;
+	return header + 1;
+}
+
+bool CCommandRing::EndCommand()
+{
+	m_writePosition.store(m_pendingWritePosition);
+	//Let the caller know that the consumer needs to be woken up
+	return m_consumerWaiting.exchange(false);
+}
+
+uint64 CCommandRing::GetWritePosition() const
+{
+	return m_writePosition.load(std::memory_order_acquire);
+}
+
+uint64 CCommandRing::GetReadPosition() const
+{
+	return m_readPosition.load(std::memory_order_relaxed);
+}
+
+bool CCommandRing::IsEmpty() const
+{
+	return m_readPosition.load(std::memory_order_relaxed) == m_writePosition.load(std::memory_order_acquire);
+}
+
+void* CCommandRing::ReadCommand(uint32& type, uint32& size)
+{
+	uint64 readPosition = m_readPosition.load(std::memory_order_relaxed);
+	uint64 writePosition = m_writePosition.load(std::memory_order_acquire);
+	if(readPosition == writePosition)
+	{
+		return nullptr;
+	}
+
+	auto header = reinterpret_cast<COMMANDHEADER*>(m_buffer + (readPosition & (m_size - 1)));
+	if(header->type == COMMAND_WRAP)
+	{
+		readPosition += GetCommandSpace(header->size);
+		assert((readPosition & (m_size - 1)) == 0);
+		assert(readPosition != writePosition);
+		header = reinterpret_cast<COMMANDHEADER*>(m_buffer);
+	}
+
+	type = header->type;
+	size = header->size;
+	m_pendingReadPosition = readPosition + GetCommandSpace(header->size);
+	return header + 1;
+}
+
+void CCommandRing::ReleaseCommand()
+{
+	m_readPosition.store(m_pendingReadPosition, std::memory_order_release);
+}
+
+bool CCommandRing::BeginWait()
+{
+	//Returns true if the consumer can go to sleep. Producer will
+	//notify the caller through EndCommand's return value when it writes something.
+	m_consumerWaiting.store(true);
+	if(m_readPosition.load(std::memory_order_relaxed) != m_writePosition.load())
+	{
+		m_consumerWaiting.store(false);
+		return false;
+	}
+	return true;
+}
+
+void CCommandRing::EndWait()
+{
+	m_consumerWaiting.store(false);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include "Types.h"
+
+//Single producer, single consumer ring buffer of variable sized commands.
+//Commands are written in place by the producer and read in place by the consumer,
+//the ring's memory is reused, no allocation or locking is involved.
+class CCommandRing
+{
+public:
+						CCommandRing(uint32);
+	virtual				~CCommandRing();
+
+	uint32				GetMaxCommandSize() const;
+
+	//Producer side
+	void*				BeginCommand(uint32, uint32);
+	void*				TryBeginCommand(uint32, uint32);
+	bool				EndCommand();
+
+	//Position past the last command made available to the consumer, can be read from any thread
+	uint64				GetWritePosition() const;
+
+	//Consumer side
+	bool				IsEmpty() const;
+	uint64				GetReadPosition() const;
+	void*				ReadCommand(uint32&, uint32&);
+	void				ReleaseCommand();
+	bool				BeginWait();
+	void				EndWait();
+
+private:
+	enum
+	{
+		COMMAND_ALIGN = 0x10,
+		COMMAND_WRAP = ~0U,
+	};
+
+	struct COMMANDHEADER
+	{
+		uint32			type;
+		uint32			size;
+		uint32			reserved[2];
+	};
+	static_assert(sizeof(COMMANDHEADER) == COMMAND_ALIGN, "COMMANDHEADER must be 16 bytes long.");
+
+	static uint32		GetCommandSpace(uint32);
+
+	uint8*				m_buffer = nullptr;
+	uint32				m_size = 0;
+
+	std::atomic<uint64>	m_writePosition;
+	std::atomic<uint64>	m_readPosition;
+	std::atomic<bool>	m_consumerWaiting;
+
+	//Only accessed by the producer
+	uint64				m_pendingWritePosition = 0;
+
+	//Only accessed by the consumer
+	uint64				m_pendingReadPosition = 0;
+};
@@ -1,7 +1,9 @@
 #include <algorithm>
 #include <stdexcept>
+#include <vector>
 #include <string.h>
 #include <assert.h>
+#include "make_unique.h"
 #include "CsoImageStream.h"
 #include "zlib.h"
 
@@ -21,8 +23,8 @@ struct CsoHeader
 	uint8 reserved[2];
 };
 
-CCsoImageStream::CCsoImageStream(CStream* baseStream)
-	: m_baseStream(baseStream), m_readBuffer(nullptr), m_zlibBuffer(nullptr), m_index(nullptr), m_position(0)
+CCsoImageStream::CCsoImageStream(CStream* baseStream, uint64 cacheSize)
+	: m_baseStream(baseStream), m_readBuffer(nullptr), m_readBufferSize(0), m_index(nullptr), m_position(0)
 {
 	if(baseStream == nullptr)
 	{
@@ -30,13 +32,14 @@ CCsoImageStream::CCsoImageStream(CStream* baseStream)
 	}
 
 	ReadFileHeader();
-	InitializeBuffers();
+	InitializeBuffers(cacheSize);
 }
 
 CCsoImageStream::~CCsoImageStream()
 {
+	// Make sure the prefetch thread is gone before freeing anything it might use.
+	m_frameCache.reset();
 	delete [] m_readBuffer;
-	delete [] m_zlibBuffer;
 	delete [] m_index;
 }
 
@@ -80,21 +83,20 @@ void CCsoImageStream::ReadFileHeader()
 	m_totalSize = hdr.total_bytes;
 }
 
-void CCsoImageStream::InitializeBuffers()
+void CCsoImageStream::InitializeBuffers(uint64 cacheSize)
 {
 	uint32 numFrames = static_cast<uint32>((m_totalSize + m_frameSize - 1) / m_frameSize);
 
 	// We might read a bit of alignment too, so be prepared.
 	if(m_frameSize + (1 << m_indexShift) < CSO_READ_BUFFER_SIZE)
 	{
-		m_readBuffer = new uint8[CSO_READ_BUFFER_SIZE];
+		m_readBufferSize = CSO_READ_BUFFER_SIZE;
 	}
 	else
 	{
-		m_readBuffer = new uint8[m_frameSize + (1 << m_indexShift)];
+		m_readBufferSize = m_frameSize + (1 << m_indexShift);
 	}
-	m_zlibBuffer = new uint8[m_frameSize + (1 << m_indexShift)];
-	m_zlibBufferFrame = numFrames;
+	m_readBuffer = new uint8[m_readBufferSize];
 
 	const uint32 indexSize = numFrames + 1;
 	m_index = new uint32[indexSize];
@@ -102,6 +104,9 @@ void CCsoImageStream::InitializeBuffers()
 	{
 		throw std::runtime_error("Unable to read CSO index.");
 	}
+
+	m_frameCache = std::make_unique<CImageBlockCache>(m_frameSize, numFrames,
+		[this] (uint64 frame, uint8* dest) { DecodeFrame(frame, dest); }, cacheSize);
 }
 
 void CCsoImageStream::Seek(int64 position, Framework::STREAM_SEEK_DIRECTION origin)
@@ -135,10 +140,18 @@ uint64 CCsoImageStream::Read(void* buffer, uint64 size)
 	uint64 remaining = size;
 	uint8* dest = reinterpret_cast<uint8*>(buffer);
 
-	// We read only one frame at a time for now.
 	while(remaining > 0 && !IsEOF())
 	{
-		uint32 bytes = ReadFromNextFrame(dest, remaining);
+		uint64 bytes = 0;
+		// Frame aligned reads spanning whole frames that weren't decompressed yet can be done in batches.
+		if(((m_position & (m_frameSize - 1)) == 0) && (remaining >= m_frameSize) && !m_frameCache->IsCached(m_position >> m_frameShift))
+		{
+			bytes = ReadFullFrames(dest, remaining);
+		}
+		if(bytes == 0)
+		{
+			bytes = ReadFromNextFrame(dest, remaining);
+		}
 		remaining -= bytes;
 		m_position += bytes;
 		dest += bytes;
@@ -171,9 +184,8 @@ uint32 CCsoImageStream::ReadFromNextFrame(uint8* dest, uint64 maxBytes)
 	const uint32 index0 = m_index[frame + 0] & 0x7FFFFFFF;
 	const uint32 index1 = m_index[frame + 1] & 0x7FFFFFFF;
 
-	// Calculate where the compressed payload is (if compressed.)
+	// Calculate where the payload is.
 	const uint64 frameRawPos = static_cast<uint64>(index0) << m_indexShift;
-	const uint64 frameRawSize = (index1 - index0) << m_indexShift;
 
 	if(!compressed)
 	{
@@ -185,23 +197,103 @@ uint32 CCsoImageStream::ReadFromNextFrame(uint8* dest, uint64 maxBytes)
 	}
 	else
 	{
-		// We don't need to decompress if we already did this same frame last time.
-		if(m_zlibBufferFrame != frame)
+		// Decompressed frames are kept in the cache, it will decompress the frame if needed.
+		m_frameCache->Read(frame, offset, dest, bytes);
+	}
+
+	return bytes;
+}
+
+void CCsoImageStream::DecodeFrame(uint64 frame, uint8* dest)
+{
+	// This can be called from the frame cache's prefetch thread.
+	const bool compressed = (m_index[frame + 0] & 0x80000000) == 0;
+	const uint32 index0 = m_index[frame + 0] & 0x7FFFFFFF;
+	const uint32 index1 = m_index[frame + 1] & 0x7FFFFFFF;
+
+	const uint64 frameRawPos = static_cast<uint64>(index0) << m_indexShift;
+	const uint64 frameRawSize = static_cast<uint64>(index1 - index0) << m_indexShift;
+
+	if(!compressed)
+	{
+		const uint64 readBytes = ReadBaseAt(frameRawPos, dest, m_frameSize);
+		memset(dest + readBytes, 0, static_cast<size_t>(m_frameSize - readBytes));
+	}
+	else
+	{
+		// This might be less bytes than frameRawSize in case of padding on the last frame.
+		// This is because the index positions must be aligned.
+		std::vector<uint8> rawFrame(static_cast<size_t>(frameRawSize));
+		const uint64 readRawBytes = ReadBaseAt(frameRawPos, rawFrame.data(), frameRawSize);
+		DecompressFrame(rawFrame.data(), readRawBytes, dest);
+	}
+}
+
+uint64 CCsoImageStream::ReadFullFrames(uint8* dest, uint64 maxBytes)
+{
+	assert((m_position & (m_frameSize - 1)) == 0);
+
+	const uint32 frame = static_cast<uint32>(m_position >> m_frameShift);
+	const uint32 fullFrameCount = static_cast<uint32>(m_totalSize >> m_frameShift);
+	if(frame >= fullFrameCount)
+	{
+		return 0;
+	}
+	const uint32 maxFrameCount = static_cast<uint32>(std::min<uint64>(maxBytes >> m_frameShift, fullFrameCount - frame));
+
+	// Gather as many frames as we can fit in the read buffer, their payloads are contiguous in the base stream.
+	const uint64 runRawPos = static_cast<uint64>(m_index[frame] & 0x7FFFFFFF) << m_indexShift;
+	uint32 frameCount = 0;
+	while(frameCount < maxFrameCount)
+	{
+		if((frameCount != 0) && m_frameCache->IsCached(frame + frameCount)) break;
+		const uint64 frameRawEnd = static_cast<uint64>(m_index[frame + frameCount + 1] & 0x7FFFFFFF) << m_indexShift;
+		if((frameRawEnd - runRawPos) > m_readBufferSize) break;
+		frameCount++;
+	}
+	if(frameCount == 0)
+	{
+		return 0;
+	}
+
+	const uint64 runRawEnd = static_cast<uint64>(m_index[frame + frameCount] & 0x7FFFFFFF) << m_indexShift;
+	// This might be less bytes than requested in case of padding on the last frame.
+	const uint64 readRawBytes = ReadBaseAt(runRawPos, m_readBuffer, runRawEnd - runRawPos);
+
+	for(uint32 i = 0; i < frameCount; i++)
+	{
+		const bool compressed = (m_index[frame + i + 0] & 0x80000000) == 0;
+		const uint64 frameRawPos = (static_cast<uint64>(m_index[frame + i + 0] & 0x7FFFFFFF) << m_indexShift) - runRawPos;
+		const uint64 frameRawEnd = std::min<uint64>((static_cast<uint64>(m_index[frame + i + 1] & 0x7FFFFFFF) << m_indexShift) - runRawPos, readRawBytes);
+		if(frameRawEnd < frameRawPos)
 		{
-			// This might be less bytes than frameRawSize in case of padding on the last frame.
-			// This is because the index positions must be aligned.
-			const uint64 readRawBytes = ReadBaseAt(frameRawPos, m_readBuffer, frameRawSize);
-			DecompressFrame(frame, readRawBytes);
+			throw std::runtime_error("Unable to read frame bytes from CSO.");
 		}
+		const uint64 frameRawSize = frameRawEnd - frameRawPos;
 
-		// Now we just copy the offset data from the cache.
-		memcpy(dest, m_zlibBuffer + offset, bytes);
+		if(!compressed)
+		{
+			if(frameRawSize < m_frameSize)
+			{
+				throw std::runtime_error("Unable to read uncompressed bytes from CSO.");
+			}
+			memcpy(dest, m_readBuffer + frameRawPos, m_frameSize);
+		}
+		else
+		{
+			// Decompress straight into the destination buffer.
+			DecompressFrame(m_readBuffer + frameRawPos, frameRawSize, dest);
+		}
+		dest += m_frameSize;
 	}
 
-	return bytes;
+	// Start decompressing what comes next while the caller deals with this data.
+	m_frameCache->Prefetch(frame + frameCount);
+
+	return static_cast<uint64>(frameCount) << m_frameShift;
 }
 
-void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
+void CCsoImageStream::DecompressFrame(const uint8* src, uint64 srcSize, uint8* dest)
 {
 	z_stream z;
 	z.zalloc = Z_NULL;
@@ -212,9 +304,9 @@ void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
 		throw std::runtime_error("Unable to initialize zlib for CSO decompression.");
 	}
 
-	z.next_in = m_readBuffer;
-	z.avail_in = static_cast<uint32>(readBufferSize);
-	z.next_out = m_zlibBuffer;
+	z.next_in = const_cast<Bytef*>(src);
+	z.avail_in = static_cast<uint32>(srcSize);
+	z.next_out = dest;
 	z.avail_out = m_frameSize;
 
 	int status = inflate(&z, Z_FINISH);
@@ -224,13 +316,11 @@ void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
 		throw std::runtime_error("Unable to decompress CSO frame using zlib.");
 	}
 	inflateEnd(&z);
-
-	// Our buffer now contains this frame.
-	m_zlibBufferFrame = frame;
 }
 
 uint64 CCsoImageStream::ReadBaseAt(uint64 pos, uint8* dest, uint64 bytes)
 {
+	std::lock_guard<std::mutex> baseStreamLock(m_baseStreamMutex);
 	m_baseStream->Seek(pos, Framework::STREAM_SEEK_SET);
 	return m_baseStream->Read(dest, bytes);
 }
@@ -1,12 +1,15 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include "Types.h"
 #include "Stream.h"
+#include "ImageBlockCache.h"
 
 class CCsoImageStream : public Framework::CStream
 {
 public:
-						CCsoImageStream(Framework::CStream* baseStream);
+						CCsoImageStream(Framework::CStream* baseStream, uint64 cacheSize = CImageBlockCache::DEFAULT_MEMORY_BUDGET);
 	virtual				~CCsoImageStream();
 
 	virtual void		Seek(int64 pos, Framework::STREAM_SEEK_DIRECTION whence) override;
@@ -17,20 +20,24 @@ public:
 
 private:
 	void				ReadFileHeader();
-	void				InitializeBuffers();
+	void				InitializeBuffers(uint64 cacheSize);
 	uint64				GetTotalSize() const;
 	uint32				ReadFromNextFrame(uint8* dest, uint64 maxBytes);
+	uint64				ReadFullFrames(uint8* dest, uint64 maxBytes);
 	uint64				ReadBaseAt(uint64 pos, uint8* dest, uint64 bytes);
-	void				DecompressFrame(uint32 frame, uint64 readBufferSize);
+	void				DecodeFrame(uint64 frame, uint8* dest);
+	void				DecompressFrame(const uint8* src, uint64 srcSize, uint8* dest);
 
 	Framework::CStream*	m_baseStream;
+	std::mutex			m_baseStreamMutex;
 	uint32				m_frameSize;
 	uint8				m_frameShift;
 	uint8				m_indexShift;
 	uint8*				m_readBuffer;
-	uint8*				m_zlibBuffer;
-	uint32				m_zlibBufferFrame;
+	uint32				m_readBufferSize;
 	uint32*				m_index;
 	uint64				m_totalSize;
 	uint64				m_position;
+
+	std::unique_ptr<CImageBlockCache>	m_frameCache;
 };
@@ -5,6 +5,7 @@
 #include "DiskUtils.h"
 #include "IszImageStream.h"
 #include "CsoImageStream.h"
+#include "ISO9660/BlockProviderMapped.h"
 #include "StdStream.h"
 #ifdef WIN32
 #include "VolumeStream.h"
@@ -24,7 +25,7 @@ static Framework::CStream* CreateImageStream(const boost::filesystem::path& imag
 #endif
 }
 
-DiskUtils::Iso9660Ptr DiskUtils::CreateDiskImageFromPath(const boost::filesystem::path& imagePath)
+DiskUtils::Iso9660Ptr DiskUtils::CreateDiskImageFromPath(const boost::filesystem::path& imagePath, uint64 imageCacheSize)
 {
 	assert(!imagePath.empty());
 
@@ -34,11 +35,11 @@ DiskUtils::Iso9660Ptr DiskUtils::CreateDiskImageFromPath(const boost::filesystem
 	//Gotta think of something better than that...
 	if(!stricmp(extension.c_str(), ".isz"))
 	{
-		stream = std::make_shared<CIszImageStream>(CreateImageStream(imagePath));
+		stream = std::make_shared<CIszImageStream>(CreateImageStream(imagePath), imageCacheSize);
 	}
 	else if(!stricmp(extension.c_str(), ".cso"))
 	{
-		stream = std::make_shared<CCsoImageStream>(CreateImageStream(imagePath));
+		stream = std::make_shared<CCsoImageStream>(CreateImageStream(imagePath), imageCacheSize);
 	}
 #ifdef WIN32
 	else if(imagePath.string()[0] == '\\')
@@ -60,9 +61,21 @@ DiskUtils::Iso9660Ptr DiskUtils::CreateDiskImageFromPath(const boost::filesystem
 	}
 #endif
 
-	//If it's null after all that, just feed it to a StdStream
+	//If it's null after all that, it's a plain image file, try to map it in memory
+	//before falling back to a StdStream
 	if(!stream)
 	{
+		try
+		{
+			auto blockProvider = std::make_shared<ISO9660::CBlockProviderMapped>(imagePath);
+			return std::make_unique<CISO9660>(blockProvider);
+		}
+		catch(...)
+		{
+			//Mapping failed (ie.: not enough address space) or this isn't
+			//a 2048 bytes per sector image, will be handled below
+		}
+
 		stream = std::shared_ptr<Framework::CStream>(CreateImageStream(imagePath));
 	}
 
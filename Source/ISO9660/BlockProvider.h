@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <algorithm>
+#include <string.h>
 #include "Types.h"
 #include "Stream.h"
 
@@ -16,6 +18,17 @@ namespace ISO9660
 
 		virtual				~CBlockProvider() {};
 		virtual void		ReadBlock(uint32, void*) = 0;
+
+		//Reads 'count' consecutive blocks starting at 'address'
+		virtual void ReadBlocks(uint32 address, uint32 count, void* blocks)
+		{
+			auto blockPtr = reinterpret_cast<uint8*>(blocks);
+			for(uint32 i = 0; i < count; i++)
+			{
+				ReadBlock(address + i, blockPtr);
+				blockPtr += BLOCKSIZE;
+			}
+		}
 	};
 
 	class CBlockProvider2048 : public CBlockProvider
@@ -40,6 +53,12 @@ namespace ISO9660
 			m_stream->Read(block, BLOCKSIZE);
 		}
 
+		void ReadBlocks(uint32 address, uint32 count, void* blocks) override
+		{
+			m_stream->Seek(static_cast<uint64>(address) * BLOCKSIZE, Framework::STREAM_SEEK_SET);
+			m_stream->Read(blocks, static_cast<uint64>(count) * BLOCKSIZE);
+		}
+
 	private:
 		StreamPtr m_stream;
 	};
@@ -66,13 +85,33 @@ namespace ISO9660
 			m_stream->Read(block, BLOCKSIZE);
 		}
 
+		void ReadBlocks(uint32 address, uint32 count, void* blocks) override
+		{
+			//Read raw sectors in batches and strip headers/ECC data from them
+			auto blockPtr = reinterpret_cast<uint8*>(blocks);
+			m_stream->Seek(static_cast<uint64>(address) * INTERNAL_BLOCKSIZE, Framework::STREAM_SEEK_SET);
+			while(count != 0)
+			{
+				uint32 batchCount = std::min<uint32>(count, READ_BUFFER_BLOCKS);
+				m_stream->Read(m_readBuffer, batchCount * INTERNAL_BLOCKSIZE);
+				for(uint32 i = 0; i < batchCount; i++)
+				{
+					memcpy(blockPtr, m_readBuffer + (i * INTERNAL_BLOCKSIZE) + BLOCKHEADER_SIZE, BLOCKSIZE);
+					blockPtr += BLOCKSIZE;
+				}
+				count -= batchCount;
+			}
+		}
+
 	private:
 		enum
 		{
 			INTERNAL_BLOCKSIZE = 0x930ULL,
-			BLOCKHEADER_SIZE = 0x18ULL
+			BLOCKHEADER_SIZE = 0x18ULL,
+			READ_BUFFER_BLOCKS = 0x20,
 		};
 
 		StreamPtr m_stream;
+		uint8 m_readBuffer[READ_BUFFER_BLOCKS * INTERNAL_BLOCKSIZE];
 	};
 }
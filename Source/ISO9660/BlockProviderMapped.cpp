@@ -0,0 +1,116 @@
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "BlockProviderMapped.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace ISO9660;
+
+#ifdef _WIN32
+
+CBlockProviderMapped::CBlockProviderMapped(const boost::filesystem::path& path)
+{
+	m_file = CreateFileW(path.native().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(m_file == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("Failed to open disk image.");
+	}
+
+	LARGE_INTEGER fileSize = {};
+	if(!GetFileSizeEx(m_file, &fileSize) || (fileSize.QuadPart == 0) || (static_cast<uint64>(fileSize.QuadPart) > SIZE_MAX))
+	{
+		CloseHandle(m_file);
+		throw std::runtime_error("Disk image can't be mapped.");
+	}
+	m_size = fileSize.QuadPart;
+
+	m_mapping = CreateFileMapping(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(m_mapping == NULL)
+	{
+		CloseHandle(m_file);
+		throw std::runtime_error("Failed to create disk image mapping.");
+	}
+
+	m_data = reinterpret_cast<const uint8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if(m_data == nullptr)
+	{
+		CloseHandle(m_mapping);
+		CloseHandle(m_file);
+		throw std::runtime_error("Failed to map disk image.");
+	}
+}
+
+CBlockProviderMapped::~CBlockProviderMapped()
+{
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping);
+	CloseHandle(m_file);
+}
+
+#else
+
+CBlockProviderMapped::CBlockProviderMapped(const boost::filesystem::path& path)
+{
+	m_fd = open(path.string().c_str(), O_RDONLY);
+	if(m_fd == -1)
+	{
+		throw std::runtime_error("Failed to open disk image.");
+	}
+
+	struct stat fileStat = {};
+	if((fstat(m_fd, &fileStat) != 0) || !S_ISREG(fileStat.st_mode) || (fileStat.st_size == 0) ||
+		(static_cast<uint64>(fileStat.st_size) > SIZE_MAX))
+	{
+		close(m_fd);
+		throw std::runtime_error("Disk image can't be mapped.");
+	}
+	m_size = fileStat.st_size;
+
+	void* data = mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_SHARED, m_fd, 0);
+	if(data == MAP_FAILED)
+	{
+		close(m_fd);
+		throw std::runtime_error("Failed to map disk image.");
+	}
+	m_data = reinterpret_cast<const uint8*>(data);
+}
+
+CBlockProviderMapped::~CBlockProviderMapped()
+{
+	munmap(const_cast<uint8*>(m_data), static_cast<size_t>(m_size));
+	close(m_fd);
+}
+
+#endif
+
+void CBlockProviderMapped::ReadBlock(uint32 address, void* block)
+{
+	CopyBlocks(address, 1, block);
+}
+
+void CBlockProviderMapped::ReadBlocks(uint32 address, uint32 count, void* blocks)
+{
+	CopyBlocks(address, count, blocks);
+}
+
+void CBlockProviderMapped::CopyBlocks(uint32 address, uint32 count, void* blocks)
+{
+	//Anything past the end of the image reads as zeroes
+	uint64 position = static_cast<uint64>(address) * BLOCKSIZE;
+	uint64 size = static_cast<uint64>(count) * BLOCKSIZE;
+	uint64 availableSize = (position < m_size) ? std::min<uint64>(size, m_size - position) : 0;
+	if(availableSize != 0)
+	{
+		memcpy(blocks, m_data + position, static_cast<size_t>(availableSize));
+	}
+	if(availableSize != size)
+	{
+		memset(reinterpret_cast<uint8*>(blocks) + availableSize, 0, static_cast<size_t>(size - availableSize));
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <boost/filesystem.hpp>
+#include "BlockProvider.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace ISO9660
+{
+	//Maps a whole 2048 bytes per sector disk image in memory
+	class CBlockProviderMapped : public CBlockProvider
+	{
+	public:
+							CBlockProviderMapped(const boost::filesystem::path&);
+		virtual				~CBlockProviderMapped();
+
+		void				ReadBlock(uint32, void*) override;
+		void				ReadBlocks(uint32, uint32, void*) override;
+
+	private:
+		void				CopyBlocks(uint32, uint32, void*);
+
+		const uint8*		m_data = nullptr;
+		uint64				m_size = 0;
+#ifdef _WIN32
+		HANDLE				m_file = INVALID_HANDLE_VALUE;
+		HANDLE				m_mapping = NULL;
+#else
+		int					m_fd = -1;
+#endif
+	};
+}
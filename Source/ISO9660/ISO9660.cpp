@@ -1,10 +1,12 @@
 #include <string.h>
 #include <limits.h>
+#include <algorithm>
 #include "ISO9660.h"
 #include "StdStream.h"
 #include "File.h"
 #include "DirectoryRecord.h"
 #include "stricmp.h"
+#include "AlignedAlloc.h"
 
 using namespace ISO9660;
 
@@ -23,12 +25,28 @@ CISO9660::~CISO9660()
 
 void CISO9660::ReadBlock(uint32 address, void* data)
 {
-	//The buffer is needed to make sure exception handlers
-	//are properly called as some system calls (ie.: ReadFile)
-	//won't generate an exception when trying to write to
-	//a write protected area
-	m_blockProvider->ReadBlock(address, m_blockBuffer);
-	memcpy(data, m_blockBuffer, CBlockProvider::BLOCKSIZE);
+	ReadBlocks(address, 1, data);
+}
+
+void CISO9660::ReadBlocks(uint32 address, uint32 count, void* data)
+{
+	if(count == 0) return;
+	MakeWritable(data, static_cast<size_t>(count) * CBlockProvider::BLOCKSIZE);
+	m_blockProvider->ReadBlocks(address, count, data);
+}
+
+void CISO9660::MakeWritable(void* data, size_t size)
+{
+	//Destination might be write protected (ie.: EE RAM holding compiled code) and some
+	//system calls (ie.: ReadFile) won't generate an exception when trying to write to
+	//a write protected area. Write to every page ourselves first to let exception handlers run.
+	auto dataPtr = reinterpret_cast<volatile uint8*>(data);
+	size_t pageSize = framework_getpagesize();
+	for(size_t offset = 0; offset < size; offset += pageSize)
+	{
+		dataPtr[offset] = dataPtr[offset];
+	}
+	dataPtr[size - 1] = dataPtr[size - 1];
 }
 
 bool CISO9660::GetFileRecord(CDirectoryRecord* record, const char* filename)
@@ -0,0 +1,179 @@
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include "ImageBlockCache.h"
+
+CImageBlockCache::CImageBlockCache(uint32 blockSize, uint64 blockCount, const DecodeBlockFunction& decodeBlock, uint64 memoryBudget)
+: m_blockSize(blockSize)
+, m_blockCount(blockCount)
+, m_decodeBlock(decodeBlock)
+{
+	assert(m_blockSize != 0);
+	m_maxCachedBlocks = static_cast<uint32>(std::max<uint64>(memoryBudget / m_blockSize, 2));
+	//Never prefetch more than half the cache, otherwise prefetched blocks would evict each other
+	m_prefetchBlockCount = std::min<uint32>(std::max<uint32>(PREFETCH_SIZE / m_blockSize, 1), m_maxCachedBlocks / 2);
+}
+
+CImageBlockCache::~CImageBlockCache()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_prefetchThreadDone = true;
+	}
+	m_prefetchCondition.notify_all();
+	if(m_prefetchThread.joinable())
+	{
+		m_prefetchThread.join();
+	}
+}
+
+bool CImageBlockCache::IsCached(uint64 blockIndex)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_blockMap.find(blockIndex) != std::end(m_blockMap);
+}
+
+void CImageBlockCache::Read(uint64 blockIndex, uint32 offset, void* dest, uint32 size)
+{
+	assert(blockIndex < m_blockCount);
+	assert((offset + size) <= m_blockSize);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	bool sequential = (blockIndex == m_lastBlockIndex) || (blockIndex == (m_lastBlockIndex + 1));
+	m_lastBlockIndex = blockIndex;
+
+	auto block = FindBlock(lock, blockIndex);
+	if(block == nullptr)
+	{
+		m_pendingBlocks.insert(blockIndex);
+		lock.unlock();
+
+		BlockDataPtr data(new uint8[m_blockSize]);
+		try
+		{
+			m_decodeBlock(blockIndex, data.get());
+		}
+		catch(...)
+		{
+			lock.lock();
+			m_pendingBlocks.erase(blockIndex);
+			m_blockDecodedCondition.notify_all();
+			throw;
+		}
+
+		lock.lock();
+		m_pendingBlocks.erase(blockIndex);
+		InsertBlock(blockIndex, std::move(data));
+		m_blockDecodedCondition.notify_all();
+
+		block = &m_blocks.front();
+	}
+
+	memcpy(dest, block->data.get() + offset, size);
+
+	if(sequential)
+	{
+		QueuePrefetch(blockIndex + 1);
+	}
+}
+
+void CImageBlockCache::Prefetch(uint64 blockIndex)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	//Next read of this block will be considered sequential
+	m_lastBlockIndex = blockIndex - 1;
+	QueuePrefetch(blockIndex);
+}
+
+const CImageBlockCache::BLOCK* CImageBlockCache::FindBlock(std::unique_lock<std::mutex>& lock, uint64 blockIndex)
+{
+	//Wait for the prefetch thread if it's currently decoding this block
+	m_blockDecodedCondition.wait(lock, [&] () { return m_pendingBlocks.find(blockIndex) == std::end(m_pendingBlocks); });
+
+	auto blockIterator = m_blockMap.find(blockIndex);
+	if(blockIterator == std::end(m_blockMap))
+	{
+		return nullptr;
+	}
+
+	//Move the block at the front of the list
+	m_blocks.splice(std::begin(m_blocks), m_blocks, blockIterator->second);
+	return &m_blocks.front();
+}
+
+void CImageBlockCache::InsertBlock(uint64 blockIndex, BlockDataPtr data)
+{
+	assert(m_blockMap.find(blockIndex) == std::end(m_blockMap));
+	if(m_blockMap.size() >= m_maxCachedBlocks)
+	{
+		const auto& lastBlock = m_blocks.back();
+		m_blockMap.erase(lastBlock.index);
+		m_blocks.pop_back();
+	}
+	BLOCK block;
+	block.index = blockIndex;
+	block.data = std::move(data);
+	m_blocks.push_front(std::move(block));
+	m_blockMap.insert(std::make_pair(blockIndex, std::begin(m_blocks)));
+}
+
+void CImageBlockCache::QueuePrefetch(uint64 firstBlockIndex)
+{
+	//Anything that was queued before is not relevant anymore
+	m_prefetchQueue.clear();
+	uint64 lastBlockIndex = std::min<uint64>(firstBlockIndex + m_prefetchBlockCount, m_blockCount);
+	for(uint64 blockIndex = firstBlockIndex; blockIndex < lastBlockIndex; blockIndex++)
+	{
+		if(m_blockMap.find(blockIndex) != std::end(m_blockMap)) continue;
+		if(m_pendingBlocks.find(blockIndex) != std::end(m_pendingBlocks)) continue;
+		m_prefetchQueue.push_back(blockIndex);
+	}
+	if(m_prefetchQueue.empty())
+	{
+		return;
+	}
+	if(!m_prefetchThread.joinable())
+	{
+		m_prefetchThread = std::thread([&] () { PrefetchThreadProc(); });
+	}
+	m_prefetchCondition.notify_one();
+}
+
+void CImageBlockCache::PrefetchThreadProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(1)
+	{
+		m_prefetchCondition.wait(lock, [&] () { return m_prefetchThreadDone || !m_prefetchQueue.empty(); });
+		if(m_prefetchThreadDone) break;
+
+		uint64 blockIndex = m_prefetchQueue.front();
+		m_prefetchQueue.pop_front();
+		if(m_blockMap.find(blockIndex) != std::end(m_blockMap)) continue;
+		if(m_pendingBlocks.find(blockIndex) != std::end(m_pendingBlocks)) continue;
+
+		m_pendingBlocks.insert(blockIndex);
+		lock.unlock();
+
+		BlockDataPtr data(new uint8[m_blockSize]);
+		bool decoded = true;
+		try
+		{
+			m_decodeBlock(blockIndex, data.get());
+		}
+		catch(...)
+		{
+			//Reader will report the error if it really needs this block
+			decoded = false;
+		}
+
+		lock.lock();
+		m_pendingBlocks.erase(blockIndex);
+		if(decoded)
+		{
+			InsertBlock(blockIndex, std::move(data));
+		}
+		m_blockDecodedCondition.notify_all();
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <list>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include "Types.h"
+
+//Keeps the most recently decoded blocks of a compressed disk image in memory
+//and decodes blocks ahead of sequential reads on a worker thread.
+//The decode function is called from both the reading thread and the worker
+//thread, it needs to synchronize access to the underlying stream itself.
+class CImageBlockCache
+{
+public:
+	typedef std::function<void (uint64, uint8*)> DecodeBlockFunction;
+
+	enum
+	{
+		DEFAULT_MEMORY_BUDGET = 0x2000000,
+		PREFETCH_SIZE = 0x80000,
+	};
+
+								CImageBlockCache(uint32, uint64, const DecodeBlockFunction&, uint64 = DEFAULT_MEMORY_BUDGET);
+	virtual						~CImageBlockCache();
+
+	bool						IsCached(uint64);
+	void						Read(uint64, uint32, void*, uint32);
+	void						Prefetch(uint64);
+
+private:
+	typedef std::unique_ptr<uint8[]> BlockDataPtr;
+
+	struct BLOCK
+	{
+		uint64			index;
+		BlockDataPtr	data;
+	};
+
+	typedef std::list<BLOCK> BlockList;
+	typedef std::unordered_map<uint64, BlockList::iterator> BlockMap;
+	typedef std::unordered_set<uint64> BlockIndexSet;
+	typedef std::deque<uint64> BlockIndexQueue;
+
+	const BLOCK*				FindBlock(std::unique_lock<std::mutex>&, uint64);
+	void						InsertBlock(uint64, BlockDataPtr);
+	void						QueuePrefetch(uint64);
+	void						PrefetchThreadProc();
+
+	uint32						m_blockSize = 0;
+	uint64						m_blockCount = 0;
+	uint32						m_maxCachedBlocks = 0;
+	uint32						m_prefetchBlockCount = 0;
+	DecodeBlockFunction			m_decodeBlock;
+
+	std::mutex					m_mutex;
+	std::condition_variable		m_blockDecodedCondition;
+	std::condition_variable		m_prefetchCondition;
+	BlockList					m_blocks;
+	BlockMap					m_blockMap;
+	BlockIndexSet				m_pendingBlocks;
+	BlockIndexQueue				m_prefetchQueue;
+	uint64						m_lastBlockIndex = ~0ULL;
+	bool						m_prefetchThreadDone = false;
+	std::thread					m_prefetchThread;
+};
@@ -6,8 +6,9 @@
 #include "bzlib.h"
 #include "zlib.h"
 #include "StdStream.h"
+#include "make_unique.h"
 
-CIszImageStream::CIszImageStream(CStream* baseStream)
+CIszImageStream::CIszImageStream(CStream* baseStream, uint64 cacheSize)
 : m_baseStream(baseStream)
 {
 	if(baseStream == nullptr)
@@ -30,15 +31,16 @@ CIszImageStream::CIszImageStream(CStream* baseStream)
 	}
 
 	ReadBlockDescriptorTable();
-	m_cachedBlock = new uint8[m_header.blockSize];
-	m_readBuffer = new uint8[m_header.blockSize];
+	m_blockCache = std::make_unique<CImageBlockCache>(m_header.blockSize, m_header.blockNumber,
+		[this] (uint64 blockNumber, uint8* block) { ReadBlock(blockNumber, block); }, cacheSize);
 }
 
 CIszImageStream::~CIszImageStream()
 {
-	delete [] m_cachedBlock;
-	delete [] m_readBuffer;
+	//Make sure the prefetch thread is gone before freeing anything it might use
+	m_blockCache.reset();
 	delete [] m_blockDescriptorTable;
+	delete [] m_blockOffsetTable;
 	delete m_baseStream;
 }
 
@@ -73,11 +75,25 @@ uint64 CIszImageStream::Read(void* buffer, uint64 size)
 		{
 			break;
 		}
-		SyncCache();
 		uint64 blockPosition = (m_position % m_header.blockSize);
 		uint64 sizeLeft = m_header.blockSize - blockPosition;
 		uint64 sizeToRead = std::min<uint64>(size, sizeLeft);
-		memcpy(inputBuffer, m_cachedBlock + blockPosition, static_cast<size_t>(sizeToRead));
+		uint64 blockNumber = (m_position / m_header.blockSize);
+		if((blockPosition == 0) && (sizeToRead == m_header.blockSize) && !m_blockCache->IsCached(blockNumber))
+		{
+			//Whole block requested, decompress it directly in the output buffer
+			//and let the cache decompress what follows in the background
+			ReadBlock(blockNumber, inputBuffer);
+			m_blockCache->Prefetch(blockNumber + 1);
+		}
+		else
+		{
+			if(blockNumber >= m_header.blockNumber)
+			{
+				throw std::runtime_error("Trying to read past eof.");
+			}
+			m_blockCache->Read(blockNumber, static_cast<uint32>(blockPosition), inputBuffer, static_cast<uint32>(sizeToRead));
+		}
 		m_position += sizeToRead;
 		size -= sizeToRead;
 		inputBuffer += sizeToRead;
@@ -109,12 +125,19 @@ void CIszImageStream::ReadBlockDescriptorTable()
 	}
 
 	m_blockDescriptorTable = new BLOCKDESCRIPTOR[m_header.blockNumber];
+	m_blockOffsetTable = new uint64[m_header.blockNumber];
+	uint64 blockOffset = m_header.dataOffset;
 	for(unsigned int i = 0; i < m_header.blockNumber; i++)
 	{
 		uint32 value = *reinterpret_cast<uint32*>(&cryptedTable[i * m_header.blockPtrLength]);
 		value &= 0xFFFFFF;
 		m_blockDescriptorTable[i].size = value & 0x3FFFFF;
 		m_blockDescriptorTable[i].storageType = static_cast<uint8>(value >> 22);
+		m_blockOffsetTable[i] = blockOffset;
+		if(m_blockDescriptorTable[i].storageType != ADI_ZERO)
+		{
+			blockOffset += m_blockDescriptorTable[i].size;
+		}
 	}
 
 	delete [] cryptedTable;
@@ -125,59 +148,47 @@ uint64 CIszImageStream::GetTotalSize() const
 	return static_cast<uint64>(m_header.totalSectors) * static_cast<uint64>(m_header.sectorSize);
 }
 
-const CIszImageStream::BLOCKDESCRIPTOR& CIszImageStream::SeekToBlock(uint64 blockNumber)
+std::vector<uint8> CIszImageStream::ReadBaseBlock(uint64 blockNumber, uint32 size)
 {
+	//This can be called from the block cache's prefetch thread
 	assert(blockNumber < m_header.blockNumber);
-	uint64 seekPosition = m_header.dataOffset;
-	for(unsigned int i = 0; i < blockNumber; i++)
-	{
-		const BLOCKDESCRIPTOR& blockDescriptor = m_blockDescriptorTable[i];
-		if(blockDescriptor.storageType != ADI_ZERO)
-		{
-			seekPosition += blockDescriptor.size;
-		}
-	}
-	m_baseStream->Seek(seekPosition, Framework::STREAM_SEEK_SET);
-	return m_blockDescriptorTable[blockNumber];
+	std::vector<uint8> result(size);
+	std::lock_guard<std::mutex> baseStreamLock(m_baseStreamMutex);
+	m_baseStream->Seek(m_blockOffsetTable[blockNumber], Framework::STREAM_SEEK_SET);
+	m_baseStream->Read(result.data(), size);
+	return result;
 }
 
-void CIszImageStream::SyncCache()
+void CIszImageStream::ReadBlock(uint64 blockNumber, uint8* block)
 {
-	uint64 currentSector = (m_position / m_header.sectorSize);
-	uint64 neededBlock = (currentSector * m_header.sectorSize) / m_header.blockSize;
-	if(neededBlock == m_cachedBlockNumber)
-	{
-		return;
-	}
-	if(neededBlock >= m_header.blockNumber)
+	if(blockNumber >= m_header.blockNumber)
 	{
 		throw std::runtime_error("Trying to read past eof.");
 	}
 
-	const BLOCKDESCRIPTOR& blockDescriptor = SeekToBlock(neededBlock);
-	memset(m_cachedBlock, 0, m_header.blockSize);
+	const BLOCKDESCRIPTOR& blockDescriptor = m_blockDescriptorTable[blockNumber];
+	memset(block, 0, m_header.blockSize);
 	switch(blockDescriptor.storageType)
 	{
 	case ADI_ZERO:
-		ReadZeroBlock(blockDescriptor.size);
+		ReadZeroBlock(blockNumber, blockDescriptor.size, block);
 		break;
 	case ADI_DATA:
-		ReadDataBlock(blockDescriptor.size);
+		ReadDataBlock(blockNumber, blockDescriptor.size, block);
 		break;
 	case ADI_ZLIB:
-		ReadGzipBlock(blockDescriptor.size);
+		ReadGzipBlock(blockNumber, blockDescriptor.size, block);
 		break;
 	case ADI_BZ2:
-		ReadBz2Block(blockDescriptor.size);
+		ReadBz2Block(blockNumber, blockDescriptor.size, block);
 		break;
 	default:
 		throw std::runtime_error("Unsupported block storage mode.");
 		break;
 	}
-	m_cachedBlockNumber = neededBlock;
 }
 
-void CIszImageStream::ReadZeroBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadZeroBlock(uint64 blockNumber, uint32 compressedBlockSize, uint8* block)
 {
 	if(compressedBlockSize != m_header.blockSize)
 	{
@@ -185,38 +196,40 @@ void CIszImageStream::ReadZeroBlock(uint32 compressedBlockSize)
 	}
 }
 
-void CIszImageStream::ReadDataBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadDataBlock(uint64 blockNumber, uint32 compressedBlockSize, uint8* block)
 {
 	if(compressedBlockSize != m_header.blockSize)
 	{
 		throw std::runtime_error("Invalid data block.");
 	}
-	m_baseStream->Read(m_cachedBlock, compressedBlockSize);
+	std::lock_guard<std::mutex> baseStreamLock(m_baseStreamMutex);
+	m_baseStream->Seek(m_blockOffsetTable[blockNumber], Framework::STREAM_SEEK_SET);
+	m_baseStream->Read(block, compressedBlockSize);
 }
 
-void CIszImageStream::ReadGzipBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadGzipBlock(uint64 blockNumber, uint32 compressedBlockSize, uint8* block)
 {
-	m_baseStream->Read(m_readBuffer, compressedBlockSize);
+	auto readBuffer = ReadBaseBlock(blockNumber, compressedBlockSize);
 	uLongf destLength = m_header.blockSize;
 	if(uncompress(
-				  reinterpret_cast<Bytef*>(m_cachedBlock), &destLength,
-				  reinterpret_cast<Bytef*>(m_readBuffer), compressedBlockSize) != Z_OK)
+				  reinterpret_cast<Bytef*>(block), &destLength,
+				  reinterpret_cast<Bytef*>(readBuffer.data()), compressedBlockSize) != Z_OK)
 	{
 		throw std::runtime_error("Error decompressing zlib block.");
 	}
 }
 
-void CIszImageStream::ReadBz2Block(uint32 compressedBlockSize)
+void CIszImageStream::ReadBz2Block(uint64 blockNumber, uint32 compressedBlockSize, uint8* block)
 {
-	m_baseStream->Read(m_readBuffer, compressedBlockSize);
+	auto readBuffer = ReadBaseBlock(blockNumber, compressedBlockSize);
 	//Force BZ2 header
-	m_readBuffer[0] = 'B';
-	m_readBuffer[1] = 'Z';
-	m_readBuffer[2] = 'h';
+	readBuffer[0] = 'B';
+	readBuffer[1] = 'Z';
+	readBuffer[2] = 'h';
 	unsigned int destLength = m_header.blockSize;
 	if(BZ2_bzBuffToBuffDecompress(
-								  reinterpret_cast<char*>(m_cachedBlock), &destLength,
-								  reinterpret_cast<char*>(m_readBuffer), compressedBlockSize, 0, 0) != BZ_OK)
+								  reinterpret_cast<char*>(block), &destLength,
+								  reinterpret_cast<char*>(readBuffer.data()), compressedBlockSize, 0, 0) != BZ_OK)
 	{
 		throw std::runtime_error("Error decompressing bz2 block.");
 	}
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "Types.h"
 #include "Stream.h"
+#include "ImageBlockCache.h"
 
 class CIszImageStream : public Framework::CStream
 {
 public:
-						CIszImageStream(Framework::CStream*);
+						CIszImageStream(Framework::CStream*, uint64 = CImageBlockCache::DEFAULT_MEMORY_BUDGET);
 	virtual				~CIszImageStream();
 
 	virtual void		Seek(int64, Framework::STREAM_SEEK_DIRECTION) override;
@@ -70,19 +74,20 @@ private:
 
 	void					ReadBlockDescriptorTable();
 	uint64					GetTotalSize() const;
-	const BLOCKDESCRIPTOR&	SeekToBlock(uint64);
-	void					SyncCache();
+	std::vector<uint8>		ReadBaseBlock(uint64, uint32);
+	void					ReadBlock(uint64, uint8*);
 
-	void					ReadZeroBlock(uint32);
-	void					ReadDataBlock(uint32);
-	void					ReadGzipBlock(uint32);
-	void					ReadBz2Block(uint32);
+	void					ReadZeroBlock(uint64, uint32, uint8*);
+	void					ReadDataBlock(uint64, uint32, uint8*);
+	void					ReadGzipBlock(uint64, uint32, uint8*);
+	void					ReadBz2Block(uint64, uint32, uint8*);
 
 	Framework::CStream*		m_baseStream = nullptr;
+	std::mutex				m_baseStreamMutex;
 	HEADER					m_header;
 	BLOCKDESCRIPTOR*		m_blockDescriptorTable = nullptr;
-	int64					m_cachedBlockNumber = -1;
-	uint8*					m_cachedBlock = nullptr;
-	uint8*					m_readBuffer = nullptr;
+	uint64*					m_blockOffsetTable = nullptr;
 	uint64					m_position = 0;
+
+	std::unique_ptr<CImageBlockCache>	m_blockCache;
 };
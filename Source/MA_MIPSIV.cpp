@@ -564,7 +564,7 @@ void CMA_MIPSIV::LWL()
 //23
 void CMA_MIPSIV::LW()
 {
-	Template_LoadUnsigned32(reinterpret_cast<void*>(&MemoryUtils_GetWordProxy));
+	Template_LoadWord32(true);
 }
 
 //24
@@ -601,19 +601,7 @@ void CMA_MIPSIV::LWR()
 //27
 void CMA_MIPSIV::LWU()
 {
-	if(m_nRT == 0) return;
-
-	ComputeMemAccessAddr();
-
-	m_codeGen->PushCtx();
-	m_codeGen->PushIdx(1);
-	m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_GetWordProxy), 2, true);
-	m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
-
-	m_codeGen->PushCst(0);
-	m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[1]));
-
-	m_codeGen->PullTop();
+	Template_LoadWord32(false);
 }
 
 //28
@@ -654,14 +642,22 @@ void CMA_MIPSIV::SWL()
 //2B
 void CMA_MIPSIV::SW()
 {
-	ComputeMemAccessAddr();
-
-	m_codeGen->PushCtx();
-	m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
-	m_codeGen->PushIdx(2);
-	m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_SetWordProxy), 3, false);
+	EmitMemAccess(0x03,
+		[&] ()
+		{
+			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+			m_codeGen->StoreAtRef();
+		},
+		[&] ()
+		{
+			m_codeGen->PushCtx();
+			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+			m_codeGen->PushIdx(2);
+			m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_SetWordProxy), 3, false);
 
-	m_codeGen->PullTop();
+			m_codeGen->PullTop();
+		}
+	);
 }
 
 //2C
@@ -740,14 +736,28 @@ void CMA_MIPSIV::LD()
 
 	assert(m_regSize == MIPS_REGSIZE_64);
 
-	ComputeMemAccessAddr();
-
-	m_codeGen->PushCtx();
-	m_codeGen->PushIdx(1);
-	m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_GetDoubleProxy), 2, Jitter::CJitter::RETURN_VALUE_64);
-	m_codeGen->PullRel64(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+	EmitMemAccess(0x07,
+		[&] ()
+		{
+			//No 64-bit reference access in the jitter, go through both halves
+			m_codeGen->PushTop();
+			m_codeGen->LoadFromRef();
+			m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+			m_codeGen->PushCst(4);
+			m_codeGen->AddRef();
+			m_codeGen->LoadFromRef();
+			m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[1]));
+		},
+		[&] ()
+		{
+			m_codeGen->PushCtx();
+			m_codeGen->PushIdx(1);
+			m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_GetDoubleProxy), 2, Jitter::CJitter::RETURN_VALUE_64);
+			m_codeGen->PullRel64(offsetof(CMIPS, m_State.nGPR[m_nRT]));
 
-	m_codeGen->PullTop();
+			m_codeGen->PullTop();
+		}
+	);
 }
 
 //39
@@ -781,14 +791,27 @@ void CMA_MIPSIV::SD()
 {
 	assert(m_regSize == MIPS_REGSIZE_64);
 
-	ComputeMemAccessAddr();
-
-	m_codeGen->PushCtx();
-	m_codeGen->PushRel64(offsetof(CMIPS, m_State.nGPR[m_nRT]));
-	m_codeGen->PushIdx(2);
-	m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_SetDoubleProxy), 3, Jitter::CJitter::RETURN_VALUE_NONE);
+	EmitMemAccess(0x07,
+		[&] ()
+		{
+			m_codeGen->PushTop();
+			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+			m_codeGen->StoreAtRef();
+			m_codeGen->PushCst(4);
+			m_codeGen->AddRef();
+			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[1]));
+			m_codeGen->StoreAtRef();
+		},
+		[&] ()
+		{
+			m_codeGen->PushCtx();
+			m_codeGen->PushRel64(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+			m_codeGen->PushIdx(2);
+			m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_SetDoubleProxy), 3, Jitter::CJitter::RETURN_VALUE_NONE);
 
-	m_codeGen->PullTop();
+			m_codeGen->PullTop();
+		}
+	);
 }
 
 //////////////////////////////////////////////////
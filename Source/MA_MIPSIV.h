@@ -79,6 +79,7 @@ protected:
 	void Template_Sub32(bool);
 	void Template_Sub64(bool);
 	void Template_LoadUnsigned32(void*);
+	void Template_LoadWord32(bool);
 	void Template_ShiftCst32(const TemplateParamedOperationFunctionType&);
 	void Template_ShiftVar32(const TemplateOperationFunctionType&);
 	void Template_Mult32(bool, unsigned int);
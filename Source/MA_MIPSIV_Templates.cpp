@@ -1,6 +1,7 @@
 #include "MA_MIPSIV.h"
 #include "Jitter.h"
 #include "MIPS.h"
+#include "MemoryUtils.h"
 #include "offsetof_def.h"
 
 void CMA_MIPSIV::Template_Add32(bool isSigned)
@@ -88,6 +89,46 @@ void CMA_MIPSIV::Template_LoadUnsigned32(void* pProxyFunction)
 	m_codeGen->PullTop();
 }
 
+void CMA_MIPSIV::Template_LoadWord32(bool signExtend)
+{
+	if(m_nRT == 0) return;
+
+	auto pullResult =
+		[&] ()
+		{
+			if(m_regSize == MIPS_REGSIZE_64)
+			{
+				if(signExtend)
+				{
+					m_codeGen->PushTop();
+					m_codeGen->SignExt();
+				}
+				else
+				{
+					m_codeGen->PushCst(0);
+				}
+				m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[1]));
+			}
+			m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+		};
+
+	EmitMemAccess(0x03,
+		[&] ()
+		{
+			m_codeGen->LoadFromRef();
+			pullResult();
+		},
+		[&] ()
+		{
+			m_codeGen->PushCtx();
+			m_codeGen->PushIdx(1);
+			m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_GetWordProxy), 2, true);
+			pullResult();
+			m_codeGen->PullTop();
+		}
+	);
+}
+
 void CMA_MIPSIV::Template_ShiftCst32(const TemplateParamedOperationFunctionType& Function)
 {
 	if(m_nRD == 0) return;
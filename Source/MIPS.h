@@ -131,6 +131,19 @@ public:
 
 	void*						m_vuMem = nullptr;
 
+	//Memory that compiled code reads and writes directly instead of going through the memory map.
+	//RAM is matched with the physical address (low 29 bits), scratchpad with the virtual address.
+	uint8*						m_fastMemRam = nullptr;
+	uint32						m_fastMemRamSize = 0;
+	uint8*						m_fastMemScratchpad = nullptr;
+	uint32						m_fastMemScratchpadAddress = 0;
+	uint32						m_fastMemScratchpadSize = 0;
+
+	//Set by superblocks when entering each of their blocks, tells which one execution left from
+	uint32						m_superBlockExitIndex = 0;
+	//Set when a superblock gets deleted, running superblocks leave before entering their next block
+	uint32						m_superBlockInvalidated = 0;
+
 	CMIPSArchitecture*			m_pArch;
 	CMIPSCoprocessor*			m_pCOP[4];
 	CMemoryMap*					m_pMemoryMap;
@@ -67,6 +67,88 @@ void CMIPSInstructionFactory::ComputeMemAccessAddr()
 	}
 }
 
+//Emits 'fastAccess' with a reference to host memory on the stack when the effective address
+//falls in RAM or scratchpad, 'slowAccess' with the translated address on the stack otherwise.
+//Bits set in 'alignMask' are cleared from the offset used by the fast path.
+void CMIPSInstructionFactory::EmitMemAccess(uint32 alignMask, const MemAccessFunction& fastAccess, const MemAccessFunction& slowAccess)
+{
+	if(m_pCtx->m_fastMemRam == nullptr)
+	{
+		ComputeMemAccessAddr();
+		slowAccess();
+		return;
+	}
+
+	assert((m_pCtx->m_fastMemRamSize & (m_pCtx->m_fastMemRamSize - 1)) == 0);
+
+	PushEffectiveAddress();
+	m_codeGen->PushCst(0x1FFFFFFF);
+	m_codeGen->And();
+	m_codeGen->PushCst(m_pCtx->m_fastMemRamSize);
+	m_codeGen->BeginIf(Jitter::CONDITION_BL);
+	{
+		EmitFastMemAccess(offsetof(CMIPS, m_fastMemRam), 0, (m_pCtx->m_fastMemRamSize - 1) & ~alignMask, fastAccess);
+	}
+	m_codeGen->Else();
+	{
+		if(m_pCtx->m_fastMemScratchpad != nullptr)
+		{
+			assert((m_pCtx->m_fastMemScratchpadSize & (m_pCtx->m_fastMemScratchpadSize - 1)) == 0);
+
+			PushEffectiveAddress();
+			m_codeGen->PushCst(m_pCtx->m_fastMemScratchpadAddress);
+			m_codeGen->Sub();
+			m_codeGen->PushCst(m_pCtx->m_fastMemScratchpadSize);
+			m_codeGen->BeginIf(Jitter::CONDITION_BL);
+			{
+				EmitFastMemAccess(offsetof(CMIPS, m_fastMemScratchpad), m_pCtx->m_fastMemScratchpadAddress,
+					(m_pCtx->m_fastMemScratchpadSize - 1) & ~alignMask, fastAccess);
+			}
+			m_codeGen->Else();
+			{
+				ComputeMemAccessAddr();
+				slowAccess();
+			}
+			m_codeGen->EndIf();
+		}
+		else
+		{
+			ComputeMemAccessAddr();
+			slowAccess();
+		}
+	}
+	m_codeGen->EndIf();
+}
+
+void CMIPSInstructionFactory::PushEffectiveAddress()
+{
+	uint8 nRS			= (uint8) ((m_nOpcode >> 21) & 0x001F);
+	uint16 nImmediate	= (uint16)((m_nOpcode >>  0) & 0xFFFF);
+
+	m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[nRS].nV[0]));
+	if(nImmediate != 0)
+	{
+		m_codeGen->PushCst((int16)nImmediate);
+		m_codeGen->Add();
+	}
+}
+
+void CMIPSInstructionFactory::EmitFastMemAccess(size_t memoryOffset, uint32 baseAddress, uint32 offsetMask, const MemAccessFunction& fastAccess)
+{
+	//Stack isn't carried over from the range check, recompute the address in this block
+	m_codeGen->PushRelRef(memoryOffset);
+	PushEffectiveAddress();
+	if(baseAddress != 0)
+	{
+		m_codeGen->PushCst(baseAddress);
+		m_codeGen->Sub();
+	}
+	m_codeGen->PushCst(offsetMask);
+	m_codeGen->And();
+	m_codeGen->AddRef();
+	fastAccess();
+}
+
 void CMIPSInstructionFactory::Branch(Jitter::CONDITION condition)
 {
 	uint16 nImmediate = (uint16)(m_nOpcode & 0xFFFF);
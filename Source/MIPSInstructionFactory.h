@@ -1,6 +1,7 @@
 #ifndef _MIPSINSTRUCTIONFACTORY_H_
 #define _MIPSINSTRUCTIONFACTORY_H_
 
+#include <functional>
 #include "Types.h"
 #include "MipsJitter.h"
 
@@ -27,7 +28,10 @@ public:
 	virtual void			CompileInstruction(uint32, CMipsJitter*, CMIPS*) = 0;
 
 protected:
+	typedef std::function<void ()> MemAccessFunction;
+
 	void					ComputeMemAccessAddr();
+	void					EmitMemAccess(uint32, const MemAccessFunction&, const MemAccessFunction&);
 	void					Branch(Jitter::CONDITION);
 	void					BranchLikely(Jitter::CONDITION);
 
@@ -39,6 +43,10 @@ protected:
     uint32					m_nOpcode;
     uint32					m_nAddress;
 	MIPS_REGSIZE			m_regSize;
+
+private:
+	void					PushEffectiveAddress();
+	void					EmitFastMemAccess(size_t, uint32, uint32, const MemAccessFunction&);
 };
 
 #endif
@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include "MemoryMap.h"
 
+const CMemoryMap::MEMORYMAPELEMENT CMemoryMap::s_partialPage = {};
+
 CMemoryMap::~CMemoryMap()
 {
 
@@ -47,17 +49,18 @@ const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::GetWriteMap(uint32 address) cons
 	return GetMap(m_writeMap, address);
 }
 
-void CMemoryMap::InsertMap(MemoryMapListType& memoryMap, uint32 start, uint32 end, void* pointer, unsigned char key)
+void CMemoryMap::InsertMap(MEMORYMAP& memoryMap, uint32 start, uint32 end, void* pointer, unsigned char key)
 {
 	MEMORYMAPELEMENT element;
 	element.nStart		= start;
 	element.nEnd		= end;
 	element.pPointer	= pointer;
 	element.nType		= MEMORYMAP_TYPE_MEMORY;
-	memoryMap.push_back(element);
+	memoryMap.elements.push_back(element);
+	UpdatePageTables(memoryMap);
 }
 
-void CMemoryMap::InsertMap(MemoryMapListType& memoryMap, uint32 start, uint32 end, const MemoryMapHandlerType& handler, unsigned char key)
+void CMemoryMap::InsertMap(MEMORYMAP& memoryMap, uint32 start, uint32 end, const MemoryMapHandlerType& handler, unsigned char key)
 {
 	MEMORYMAPELEMENT element;
 	element.nStart		= start;
@@ -65,10 +68,51 @@ void CMemoryMap::InsertMap(MemoryMapListType& memoryMap, uint32 start, uint32 en
 	element.handler		= handler;
 	element.pPointer	= NULL;
 	element.nType		= MEMORYMAP_TYPE_FUNCTION;
-	memoryMap.push_back(element);
+	memoryMap.elements.push_back(element);
+	UpdatePageTables(memoryMap);
+}
+
+void CMemoryMap::UpdatePageTables(MEMORYMAP& memoryMap)
+{
+	//Elements might have moved, rebuild everything
+	for(auto& pageTable : memoryMap.pageTables)
+	{
+		pageTable.reset();
+	}
+
+	for(const auto& element : memoryMap.elements)
+	{
+		uint32 firstPage = element.nStart >> PAGE_BITS;
+		uint32 lastPage = element.nEnd >> PAGE_BITS;
+		for(uint32 page = firstPage; page <= lastPage; page++)
+		{
+			auto& pageTable = memoryMap.pageTables[page >> PAGE_TABLE_BITS];
+			if(!pageTable)
+			{
+				pageTable.reset(new const MEMORYMAPELEMENT*[PAGE_TABLE_SIZE]());
+			}
+			uint32 pageStart = page << PAGE_BITS;
+			uint32 pageEnd = pageStart + ((1 << PAGE_BITS) - 1);
+			bool coversPage = (element.nStart <= pageStart) && (element.nEnd >= pageEnd);
+			auto& pageElement = pageTable[page & (PAGE_TABLE_SIZE - 1)];
+			pageElement = (coversPage && (pageElement == nullptr)) ? &element : &s_partialPage;
+		}
+	}
+}
+
+const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::GetMap(const MEMORYMAP& memoryMap, uint32 address)
+{
+	const auto& pageTable = memoryMap.pageTables[address >> (PAGE_BITS + PAGE_TABLE_BITS)];
+	if(!pageTable) return nullptr;
+	auto element = pageTable[(address >> PAGE_BITS) & (PAGE_TABLE_SIZE - 1)];
+	if(element == &s_partialPage)
+	{
+		return FindElement(memoryMap.elements, address);
+	}
+	return element;
 }
 
-const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::GetMap(const MemoryMapListType& memoryMap, uint32 nAddress)
+const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::FindElement(const MemoryMapListType& memoryMap, uint32 nAddress)
 {
 	for(MemoryMapListType::const_iterator element(memoryMap.begin());
 		memoryMap.end() != element; element++)
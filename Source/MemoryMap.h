@@ -3,6 +3,7 @@
 
 #include "Types.h"
 #include <functional>
+#include <memory>
 #include <vector>
 
 enum MEMORYMAP_ENDIANESS
@@ -48,17 +49,39 @@ public:
 	const MEMORYMAPELEMENT*					GetWriteMap(uint32) const;
 
 protected:
+	enum
+	{
+		PAGE_BITS = 12,
+		PAGE_TABLE_BITS = 10,
+		PAGE_TABLE_SIZE = (1 << PAGE_TABLE_BITS),
+		PAGE_DIRECTORY_SIZE = (1 << (32 - PAGE_BITS - PAGE_TABLE_BITS)),
+	};
+
 	typedef std::vector<MEMORYMAPELEMENT> MemoryMapListType;
+	typedef std::unique_ptr<const MEMORYMAPELEMENT*[]> PageTablePtr;
 
-	static const MEMORYMAPELEMENT*			GetMap(const MemoryMapListType&, uint32);
+	//Page tables hold the element covering each 4KB page and are only allocated for areas
+	//that have mappings. Pages shared by several elements or partially covered by one
+	//point to s_partialPage, lookups in those go through the element list.
+	struct MEMORYMAP
+	{
+		MemoryMapListType					elements;
+		PageTablePtr						pageTables[PAGE_DIRECTORY_SIZE];
+	};
+
+	static const MEMORYMAPELEMENT*			GetMap(const MEMORYMAP&, uint32);
 
-	MemoryMapListType						m_instructionMap;
-	MemoryMapListType						m_readMap;
-	MemoryMapListType						m_writeMap;
+	MEMORYMAP								m_instructionMap;
+	MEMORYMAP								m_readMap;
+	MEMORYMAP								m_writeMap;
 
 private:
-	static void								InsertMap(MemoryMapListType&, uint32, uint32, void*, unsigned char);
-	static void								InsertMap(MemoryMapListType&, uint32, uint32, const MemoryMapHandlerType&, unsigned char);
+	static void								InsertMap(MEMORYMAP&, uint32, uint32, void*, unsigned char);
+	static void								InsertMap(MEMORYMAP&, uint32, uint32, const MemoryMapHandlerType&, unsigned char);
+	static void								UpdatePageTables(MEMORYMAP&);
+	static const MEMORYMAPELEMENT*			FindElement(const MemoryMapListType&, uint32);
+
+	static const MEMORYMAPELEMENT			s_partialPage;
 };
 
 class CMemoryMap_LSBF : public CMemoryMap
@@ -2,8 +2,7 @@
 
 CMemoryStateFile::CMemoryStateFile(const char* name, const void* memory, size_t size) 
 : CZipFile(name)
-, m_memory(memory)
-, m_size(size)
+, m_memory(reinterpret_cast<const uint8*>(memory), reinterpret_cast<const uint8*>(memory) + size)
 {
 
 }
@@ -15,5 +14,5 @@ CMemoryStateFile::~CMemoryStateFile()
 
 void CMemoryStateFile::Write(Framework::CStream& stream)
 {
-	stream.Write(m_memory, m_size);
+	stream.Write(m_memory.data(), m_memory.size());
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include "zip/ZipFile.h"
 
 class CMemoryStateFile : public Framework::CZipFile
@@ -11,6 +12,6 @@ public:
 	virtual void	Write(Framework::CStream&);
 
 private:
-	const void*		m_memory;
-	size_t			m_size;
+	//Contents are copied, the archive can be written after the source has changed
+	std::vector<uint8>	m_memory;
 };
@@ -1,4 +1,5 @@
 #include "MipsExecutor.h"
+#include "SuperBlock.h"
 
 static bool IsInsideRange(uint32 address, uint32 start, uint32 end)
 {
@@ -31,6 +32,7 @@ CMipsExecutor::CMipsExecutor(CMIPS& context, uint32 maxAddress)
 
 CMipsExecutor::~CMipsExecutor()
 {
+	StopCompileThread();
 	for(unsigned int i = 0; i < m_subTableCount; i++)
 	{
 		CBasicBlock** subTable = m_blockTable[i];
@@ -58,8 +60,30 @@ void CMipsExecutor::ClearActiveBlocks()
 			m_blockTable[i] = NULL;
 		}
 	}
-	
+
+	for(const auto& block : m_blocks)
+	{
+		for(unsigned int i = 0; i < LINK_SLOT_MAX; i++)
+		{
+			block->SetLinkedBlock(static_cast<LINK_SLOT>(i), MIPS_INVALID_PC, nullptr);
+		}
+	}
+	m_blockLinks.clear();
+
+	for(const auto& superBlockPair : m_superBlocks)
+	{
+		superBlockPair.first->SetSuperBlock(nullptr);
+	}
+	m_superBlocks.clear();
+	m_superBlockMembers.clear();
+	m_retiredSuperBlocks.clear();
+
 	m_blocks.clear();
+
+	{
+		std::lock_guard<std::mutex> compileLock(m_compileMutex);
+		m_compileQueue.clear();
+	}
 }
 
 void CMipsExecutor::ClearActiveBlocksInRange(uint32 start, uint32 end)
@@ -99,44 +123,164 @@ void CMipsExecutor::ClearActiveBlocksInRangeInternal(uint32 start, uint32 end, C
 
 	if(!blocksToDelete.empty())
 	{
+		for(const auto& block : blocksToDelete)
+		{
+			UnlinkBlock(block);
+		}
 		m_blocks.remove_if([&] (const BasicBlockPtr& block) { return blocksToDelete.find(block.get()) != std::end(blocksToDelete); });
 	}
 }
 
+void CMipsExecutor::SetCodeCache(CBlockCodeCache* codeCache)
+{
+	std::lock_guard<std::mutex> compileLock(m_compileMutex);
+	m_codeCache = codeCache;
+}
+
+void CMipsExecutor::SetSuperBlocksEnabled(bool enabled)
+{
+	m_superBlocksEnabled = enabled;
+	if(!m_superBlocksEnabled)
+	{
+		DeleteSuperBlocks();
+	}
+}
+
+void CMipsExecutor::SetBlockProfilingEnabled(bool enabled)
+{
+	m_blockProfilingEnabled = enabled;
+}
+
+void CMipsExecutor::SaveBlockProfile(Framework::CStdStream& stream) const
+{
+	//Counts are kept in the blocks, blocks that were invalidated aren't part of the report
+	std::vector<const CBasicBlock*> blocks;
+	for(const auto& block : m_blocks)
+	{
+		if(block->GetExecutionCount() == 0) continue;
+		blocks.push_back(block.get());
+	}
+	for(const auto& superBlockPair : m_superBlocks)
+	{
+		const auto& superBlock = superBlockPair.second.block;
+		if(superBlock->GetExecutionCount() == 0) continue;
+		blocks.push_back(superBlock.get());
+	}
+	std::sort(std::begin(blocks), std::end(blocks),
+		[] (const CBasicBlock* block1, const CBasicBlock* block2) { return block1->GetExecutionCount() > block2->GetExecutionCount(); });
+
+	for(const auto& block : blocks)
+	{
+		auto functionTag = m_context.m_Functions.Find(block->GetBeginAddress());
+		fprintf(stream, "%20llu %s %s\n", static_cast<unsigned long long>(block->GetExecutionCount()),
+			block->GetName().c_str(), functionTag ? functionTag : "");
+	}
+}
+
+void CMipsExecutor::SetBackgroundCompilationEnabled(bool enabled)
+{
+	if(enabled)
+	{
+		if(!m_compileThread.joinable())
+		{
+			m_compileThreadDone = false;
+			m_compileThread = std::thread([this] () { CompileThreadProc(); });
+		}
+	}
+	else
+	{
+		StopCompileThread();
+	}
+}
+
 int CMipsExecutor::Execute(int cycles)
 {
+	m_retiredSuperBlocks.clear();
+	m_waitingForCompilation = false;
+
+#ifdef DEBUGGER_INCLUDED
+	//Breakpoints are only checked on the first block of a superblock
+	if(!m_context.m_breakpoints.empty()) DeleteSuperBlocks();
+#endif
+
 	CBasicBlock* block(nullptr);
 	while(cycles > 0)
 	{
-		uint32 address = m_context.m_pAddrTranslator(&m_context, m_context.m_State.nPC);
-		if(!block || address != block->GetBeginAddress())
+		//Follow the link from the previous block if it's been established already,
+		//this saves us from translating the address and searching the block table.
+		//Generated code always comes back here between blocks: cycle accounting, exceptions and
+		//breakpoints are handled by this loop and CodeGen has no way to patch a jump to another
+		//function, hot chains of blocks are compiled together as superblocks instead
+		CBasicBlock* nextBlock = nullptr;
+		if(block)
+		{
+			auto linkSlot = block->FindLinkSlot(m_context.m_State.nPC);
+			if(linkSlot != LINK_SLOT_MAX)
+			{
+				nextBlock = block->GetLinkedBlock(linkSlot);
+				if(m_superBlocksEnabled && (block->IncrementLinkUseCount(linkSlot) == SUPERBLOCK_LINK_THRESHOLD))
+				{
+					CreateSuperBlock(nextBlock);
+				}
+			}
+		}
+		if(nextBlock == NULL)
 		{
-			block = FindBlockStartingAt(address);
-			if(block == NULL)
+			uint32 address = m_context.m_pAddrTranslator(&m_context, m_context.m_State.nPC);
+			nextBlock = FindBlockStartingAt(address);
+			if(nextBlock == NULL)
 			{
 				//We need to partition the space and compile the blocks
 				PartitionFunction(address);
-				block = FindBlockStartingAt(address);
-				if(block == NULL)
+				nextBlock = FindBlockStartingAt(address);
+				if(nextBlock == NULL)
 				{
 					throw std::runtime_error("Couldn't create block starting at address.");
 				}
+				//Partitioning might have deleted the previous block, don't link to it
+				block = nullptr;
 			}
-			if(!block->IsCompiled())
+			if(!nextBlock->IsCompiled())
 			{
-				block->Compile();
+				if(IsCompilationPending(nextBlock))
+				{
+					//Compile thread will get to it shortly, give the rest of the machine a chance to run meanwhile
+					m_waitingForCompilation = true;
+					std::this_thread::yield();
+					break;
+				}
+				CompileBlock(nextBlock);
+			}
+			if(block != NULL)
+			{
+				LinkBlocks(block, nextBlock);
 			}
 		}
-		else if(block != NULL)
+		assert(nextBlock->IsCompiled());
+
+		if(nextBlock == block)
 		{
 			block->SetSelfLoopCount(block->GetSelfLoopCount() + 1);
 		}
+		block = nextBlock;
 
 #ifdef DEBUGGER_INCLUDED
 		if(!m_breakpointsDisabledOnce && MustBreak()) break;
 		m_breakpointsDisabledOnce = false;
 #endif
-		cycles -= block->Execute();
+		if(auto superBlock = block->GetSuperBlock())
+		{
+			if(m_blockProfilingEnabled) superBlock->IncrementExecutionCount();
+			m_context.m_superBlockInvalidated = 0;
+			cycles -= superBlock->Execute();
+			//Superblock can be left from any of its blocks, next one needs to be looked up
+			block = nullptr;
+		}
+		else
+		{
+			if(m_blockProfilingEnabled) block->IncrementExecutionCount();
+			cycles -= block->Execute();
+		}
 		if(m_context.m_State.nHasException) break;
 	}
 	return cycles;
@@ -247,10 +391,82 @@ void CMipsExecutor::CreateBlock(uint32 start, uint32 end)
 			assert(subTable[loAddress / 4] == NULL);
 			subTable[loAddress / 4] = block.get();
 		}
+		if(m_compileThread.joinable())
+		{
+			std::lock_guard<std::mutex> compileLock(m_compileMutex);
+			m_compileQueue.push_back(block);
+			m_compileCondition.notify_all();
+		}
 		m_blocks.push_back(std::move(block));
 	}
 }
 
+void CMipsExecutor::CompileBlock(CBasicBlock* block)
+{
+	block->Compile(m_codeCache);
+}
+
+bool CMipsExecutor::IsWaitingForCompilation() const
+{
+	return m_waitingForCompilation;
+}
+
+bool CMipsExecutor::IsCompilationPending(CBasicBlock* block)
+{
+	if(!m_compileThread.joinable()) return false;
+	std::lock_guard<std::mutex> compileLock(m_compileMutex);
+	if(m_compilingBlock == block) return true;
+	auto blockIterator = std::find_if(std::begin(m_compileQueue), std::end(m_compileQueue), [&] (const BasicBlockPtr& blockPtr) { return blockPtr.get() == block; });
+	if(blockIterator == std::end(m_compileQueue)) return false;
+	//Someone is about to run this block, move it ahead of the others
+	auto blockPtr = std::move(*blockIterator);
+	m_compileQueue.erase(blockIterator);
+	m_compileQueue.push_front(std::move(blockPtr));
+	return true;
+}
+
+void CMipsExecutor::CompileThreadProc()
+{
+	std::unique_lock<std::mutex> compileLock(m_compileMutex);
+	while(1)
+	{
+		m_compileCondition.wait(compileLock, [this] () { return m_compileThreadDone || !m_compileQueue.empty(); });
+		if(m_compileThreadDone) break;
+
+		auto block = std::move(m_compileQueue.front());
+		m_compileQueue.pop_front();
+		if(block->IsCompiled()) continue;
+
+		//Block might have been removed from the block table in the meantime, we hold
+		//a reference to it so it stays alive, but the result will never be used
+		m_compilingBlock = block.get();
+		auto codeCache = m_codeCache;
+		compileLock.unlock();
+		try
+		{
+			block->Compile(codeCache);
+		}
+		catch(...)
+		{
+			//Block stays uncompiled, error will come up again when the block is compiled on the emulation thread
+		}
+		compileLock.lock();
+		m_compilingBlock = nullptr;
+	}
+}
+
+void CMipsExecutor::StopCompileThread()
+{
+	if(!m_compileThread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> compileLock(m_compileMutex);
+		m_compileThreadDone = true;
+		m_compileQueue.clear();
+	}
+	m_compileCondition.notify_all();
+	m_compileThread.join();
+}
+
 void CMipsExecutor::DeleteBlock(CBasicBlock* block)
 {
 	for(uint32 address = block->GetBeginAddress(); address <= block->GetEndAddress(); address += 4)
@@ -264,12 +480,180 @@ void CMipsExecutor::DeleteBlock(CBasicBlock* block)
 		subTable[loAddress / 4] = NULL;
 	}
 
+	UnlinkBlock(block);
+
 	//Remove block from our lists
 	auto blockIterator = std::find_if(std::begin(m_blocks), std::end(m_blocks), [&] (const BasicBlockPtr& blockPtr) { return blockPtr.get() == block; });
 	assert(blockIterator != std::end(m_blocks));
 	m_blocks.erase(blockIterator);
 }
 
+void CMipsExecutor::LinkBlocks(CBasicBlock* source, CBasicBlock* target)
+{
+	//Only link blocks through the fall-through path or through the static branch
+	//target, other exits (ie.: JR) are too likely to change from one run to another
+	LINK_SLOT slot = LINK_SLOT_MAX;
+	uint32 targetAddress = target->GetBeginAddress();
+	if(targetAddress == (source->GetEndAddress() + 4))
+	{
+		slot = LINK_SLOT_NEXT;
+	}
+	else if(targetAddress == source->GetBranchTarget())
+	{
+		slot = LINK_SLOT_BRANCH;
+	}
+	else
+	{
+		return;
+	}
+
+	if(auto prevTarget = source->GetLinkedBlock(slot))
+	{
+		auto prevLinks = m_blockLinks.equal_range(prevTarget);
+		auto prevLinkIterator = std::find_if(prevLinks.first, prevLinks.second, [&] (const BlockLinkMap::value_type& link) { return link.second == source; });
+		assert(prevLinkIterator != prevLinks.second);
+		m_blockLinks.erase(prevLinkIterator);
+	}
+
+	source->SetLinkedBlock(slot, m_context.m_State.nPC, target);
+	m_blockLinks.insert(std::make_pair(target, source));
+}
+
+void CMipsExecutor::UnlinkBlock(CBasicBlock* block)
+{
+	DeleteSuperBlocksWithMember(block);
+
+	//Break links other blocks have to this one
+	auto incomingLinks = m_blockLinks.equal_range(block);
+	for(auto linkIterator = incomingLinks.first; linkIterator != incomingLinks.second; linkIterator++)
+	{
+		auto source = linkIterator->second;
+		for(unsigned int i = 0; i < LINK_SLOT_MAX; i++)
+		{
+			auto slot = static_cast<LINK_SLOT>(i);
+			if(source->GetLinkedBlock(slot) != block) continue;
+			source->SetLinkedBlock(slot, MIPS_INVALID_PC, nullptr);
+		}
+	}
+	m_blockLinks.erase(incomingLinks.first, incomingLinks.second);
+
+	//Break links this block has to other blocks
+	for(unsigned int i = 0; i < LINK_SLOT_MAX; i++)
+	{
+		auto slot = static_cast<LINK_SLOT>(i);
+		auto target = block->GetLinkedBlock(slot);
+		if(target == nullptr) continue;
+		auto targetLinks = m_blockLinks.equal_range(target);
+		auto linkIterator = std::find_if(targetLinks.first, targetLinks.second, [&] (const BlockLinkMap::value_type& link) { return link.second == block; });
+		assert(linkIterator != targetLinks.second);
+		m_blockLinks.erase(linkIterator);
+		block->SetLinkedBlock(slot, MIPS_INVALID_PC, nullptr);
+	}
+}
+
+void CMipsExecutor::CreateSuperBlock(CBasicBlock* firstBlock)
+{
+#if defined(AOT_BUILD_CACHE) || defined(AOT_USE_CACHE)
+	//Superblocks are built at run time, they can't be part of an ahead of time cache
+	return;
+#endif
+
+#ifdef DEBUGGER_INCLUDED
+	//Breakpoints are only checked between blocks
+	if(!m_context.m_breakpoints.empty()) return;
+#endif
+
+	if(firstBlock->GetSuperBlock()) return;
+
+	//Follow the most used link of each block until we loop back or run out of hot links
+	CSuperBlock::BlockArray blocks;
+	CSuperBlock::LinkArray links;
+	auto block = firstBlock;
+	while(1)
+	{
+		blocks.push_back(block);
+		if(blocks.size() == SUPERBLOCK_MAX_BLOCKS) break;
+
+		LINK_SLOT hotSlot = LINK_SLOT_MAX;
+		unsigned int hotUseCount = SUPERBLOCK_LINK_THRESHOLD / 2;
+		for(unsigned int i = 0; i < LINK_SLOT_MAX; i++)
+		{
+			auto slot = static_cast<LINK_SLOT>(i);
+			if(block->GetLinkedBlock(slot) == nullptr) continue;
+			if(block->GetLinkUseCount(slot) < hotUseCount) continue;
+			hotSlot = slot;
+			hotUseCount = block->GetLinkUseCount(slot);
+		}
+		if(hotSlot == LINK_SLOT_MAX) break;
+
+		auto nextBlock = block->GetLinkedBlock(hotSlot);
+		if(std::find(std::begin(blocks), std::end(blocks), nextBlock) != std::end(blocks)) break;
+
+		CSuperBlock::LINK link;
+		link.slot = hotSlot;
+		link.address = block->GetLinkedBlockAddress(hotSlot);
+		links.push_back(link);
+		block = nextBlock;
+	}
+
+	if(blocks.size() < 2) return;
+
+	auto superBlock = std::make_shared<CSuperBlock>(m_context, blocks, links);
+	superBlock->Compile();
+
+	firstBlock->SetSuperBlock(superBlock.get());
+	for(const auto& member : blocks)
+	{
+		m_superBlockMembers.insert(std::make_pair(member, firstBlock));
+	}
+	SUPERBLOCK superBlockInfo;
+	superBlockInfo.block = std::move(superBlock);
+	superBlockInfo.members = std::move(blocks);
+	m_superBlocks.insert(std::make_pair(firstBlock, std::move(superBlockInfo)));
+}
+
+void CMipsExecutor::DeleteSuperBlock(CBasicBlock* firstBlock)
+{
+	auto superBlockIterator = m_superBlocks.find(firstBlock);
+	assert(superBlockIterator != std::end(m_superBlocks));
+	for(const auto& member : superBlockIterator->second.members)
+	{
+		auto memberLinks = m_superBlockMembers.equal_range(member);
+		auto memberIterator = std::find_if(memberLinks.first, memberLinks.second, [&] (const SuperBlockMemberMap::value_type& memberLink) { return memberLink.second == firstBlock; });
+		assert(memberIterator != memberLinks.second);
+		m_superBlockMembers.erase(memberIterator);
+	}
+	firstBlock->SetSuperBlock(nullptr);
+	//Code might be invalidated by the superblock itself while it's running, keep it alive until we're out of it
+	//and make it leave before it runs any stale block
+	m_retiredSuperBlocks.push_back(std::move(superBlockIterator->second.block));
+	m_superBlocks.erase(superBlockIterator);
+	m_context.m_superBlockInvalidated = 1;
+}
+
+void CMipsExecutor::DeleteSuperBlocks()
+{
+	while(!m_superBlocks.empty())
+	{
+		DeleteSuperBlock(std::begin(m_superBlocks)->first);
+	}
+}
+
+void CMipsExecutor::DeleteSuperBlocksWithMember(CBasicBlock* block)
+{
+	auto memberLinks = m_superBlockMembers.equal_range(block);
+	if(memberLinks.first == memberLinks.second) return;
+	std::vector<CBasicBlock*> firstBlocks;
+	for(auto memberIterator = memberLinks.first; memberIterator != memberLinks.second; memberIterator++)
+	{
+		firstBlocks.push_back(memberIterator->second);
+	}
+	for(const auto& firstBlock : firstBlocks)
+	{
+		DeleteSuperBlock(firstBlock);
+	}
+}
+
 CMipsExecutor::BasicBlockPtr CMipsExecutor::BlockFactory(CMIPS& context, uint32 start, uint32 end)
 {
 	return std::make_shared<CBasicBlock>(context, start, end);
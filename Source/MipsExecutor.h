@@ -2,8 +2,17 @@
 #define _MIPSEXECUTOR_H_
 
 #include <list>
+#include <map>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "MIPS.h"
 #include "BasicBlock.h"
+#include "StdStream.h"
+
+class CBlockCodeCache;
 
 class CMipsExecutor
 {
@@ -17,6 +26,12 @@ public:
 	virtual void				Reset();
 	void						ClearActiveBlocks();
 	virtual void				ClearActiveBlocksInRange(uint32, uint32);
+	void						SetCodeCache(CBlockCodeCache*);
+	void						SetBackgroundCompilationEnabled(bool);
+	bool						IsWaitingForCompilation() const;
+	void						SetSuperBlocksEnabled(bool);
+	void						SetBlockProfilingEnabled(bool);
+	void						SaveBlockProfile(Framework::CStdStream&) const;
 
 #ifdef DEBUGGER_INCLUDED
 	bool						MustBreak() const;
@@ -26,22 +41,70 @@ public:
 protected:
 	typedef std::shared_ptr<CBasicBlock> BasicBlockPtr;
 	typedef std::list<BasicBlockPtr> BlockList;
+	typedef std::multimap<CBasicBlock*, CBasicBlock*> BlockLinkMap;
 
 	void						CreateBlock(uint32, uint32);
+	void						CompileBlock(CBasicBlock*);
 	virtual BasicBlockPtr		BlockFactory(CMIPS&, uint32, uint32);
 	virtual void				PartitionFunction(uint32);
 	
 	void						ClearActiveBlocksInRangeInternal(uint32, uint32, CBasicBlock*);
 
+	void						LinkBlocks(CBasicBlock*, CBasicBlock*);
+	void						UnlinkBlock(CBasicBlock*);
+
 	BlockList					m_blocks;
+	BlockLinkMap				m_blockLinks;
 	CMIPS&						m_context;
 
 	CBasicBlock***				m_blockTable;
 	uint32						m_subTableCount;
 
+	CBlockCodeCache*			m_codeCache = nullptr;
+
 #ifdef DEBUGGER_INCLUDED
 	bool						m_breakpointsDisabledOnce;
 #endif
+
+private:
+	enum
+	{
+		//Number of times a link needs to be followed before we try to build a superblock from its target
+		SUPERBLOCK_LINK_THRESHOLD = 0x400,
+		SUPERBLOCK_MAX_BLOCKS = 16,
+	};
+
+	struct SUPERBLOCK
+	{
+		BasicBlockPtr				block;
+		std::vector<CBasicBlock*>	members;
+	};
+	typedef std::map<CBasicBlock*, SUPERBLOCK> SuperBlockMap;
+	typedef std::multimap<CBasicBlock*, CBasicBlock*> SuperBlockMemberMap;
+
+	void						CreateSuperBlock(CBasicBlock*);
+	void						DeleteSuperBlock(CBasicBlock*);
+	void						DeleteSuperBlocks();
+	void						DeleteSuperBlocksWithMember(CBasicBlock*);
+
+	bool						m_superBlocksEnabled = false;
+	bool						m_blockProfilingEnabled = false;
+	SuperBlockMap				m_superBlocks;			//Indexed by first block
+	SuperBlockMemberMap			m_superBlockMembers;	//Member block to first block
+	std::vector<BasicBlockPtr>	m_retiredSuperBlocks;
+
+	//Blocks created by partitioning are compiled ahead of time on this thread
+	void						CompileThreadProc();
+	void						StopCompileThread();
+	bool						IsCompilationPending(CBasicBlock*);
+
+	std::thread					m_compileThread;
+	std::mutex					m_compileMutex;
+	std::condition_variable		m_compileCondition;
+	std::deque<BasicBlockPtr>	m_compileQueue;
+	CBasicBlock*				m_compilingBlock = nullptr;
+	bool						m_compileThreadDone = false;
+	bool						m_waitingForCompilation = false;
 };
 
 #endif
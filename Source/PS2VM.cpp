@@ -2,6 +2,7 @@
 #include <exception>
 #include <boost/filesystem.hpp>
 #include <memory>
+#include <future>
 #include <fenv.h>
 #include "make_unique.h"
 #include "PS2VM.h"
@@ -10,6 +11,8 @@
 #include "Ps2Const.h"
 #include "iop/Iop_SifManPs2.h"
 #include "StdStream.h"
+#include "PtrStream.h"
+#include "MemStream.h"
 #include "GZipStream.h"
 #include "MemoryStateFile.h"
 #include "zip/ZipArchiveWriter.h"
@@ -25,6 +28,8 @@
 #include "Log.h"
 #include "ISO9660/BlockProvider.h"
 #include "DiskUtils.h"
+#include "StdStreamUtils.h"
+#include "PerfMap.h"
 
 #define LOG_NAME		("ps2vm")
 
@@ -38,6 +43,21 @@
 
 #define SPU_UPDATE_TICKS	(PS2::IOP_CLOCK_OVER_FREQ / 1000)
 
+#define CODECACHE_PATH		("codecache/")
+#define BLOCKPROFILE_PATH	("blockprofile.txt")
+
+static const char* g_codeCacheExtensions[] =
+{
+	".ee",
+	".iop",
+	".vu0",
+	".vu1",
+};
+
+//EE CPU is 8 times faster than the IOP CPU
+#define TICK_STEP			(4800)
+#define IOP_TICK_STEP		(TICK_STEP / 8)
+
 namespace filesystem = boost::filesystem;
 
 CPS2VM::CPS2VM()
@@ -53,6 +73,8 @@ CPS2VM::CPS2VM()
 , m_eeExecutionTicks(0)
 , m_iopExecutionTicks(0)
 , m_spuUpdateTicks(SPU_UPDATE_TICKS)
+, m_soundRing(SOUND_RING_SIZE)
+, m_soundThreadDone(false)
 , m_eeProfilerZone(CProfiler::GetInstance().RegisterZone("EE"))
 , m_iopProfilerZone(CProfiler::GetInstance().RegisterZone("IOP"))
 , m_spuProfilerZone(CProfiler::GetInstance().RegisterZone("SPU"))
@@ -77,16 +99,53 @@ CPS2VM::CPS2VM()
 		//TODO: We ought to add a function to write a "path" in the settings. Since it can be wchar_t or char.
 		CAppConfig::GetInstance().RegisterPreferenceString(setting, absolutePath.string().c_str());
 	}
+
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_MULTITHREADED, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_CODECACHE_ENABLED, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_JIT_BACKGROUNDCOMPILE, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_JIT_SUPERBLOCKS, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_JIT_PERFMAP, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_JIT_PROFILEBLOCKS, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_REWIND_ENABLED, false);
+	//Number of frames between snapshots and snapshot memory budget in megabytes
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_REWIND_INTERVAL, 30);
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_REWIND_MEMORYBUDGET, CRewindBuffer::DEFAULT_MEMORY_BUDGET / 0x100000);
+
+	try
+	{
+		CPerfMap::GetInstance().SetEnabled(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_JIT_PERFMAP));
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Print(LOG_NAME, "Failed to open perf map: %s\r\n", exception.what());
+	}
 	
 	m_iop = std::make_unique<Iop::CSubSystem>(true);
 	m_iopOs = std::make_shared<CIopBios>(m_iop->m_cpu, m_iop->m_ram, PS2::IOP_RAM_SIZE, m_iop->m_scratchPad);
 
 	m_ee = std::make_unique<Ee::CSubSystem>(m_iop->m_ram, *m_iopOs);
 	m_ee->m_os->OnRequestLoadExecutable.connect(boost::bind(&CPS2VM::ReloadExecutable, this, _1, _2));
+	m_ee->m_sif.SetIopSyncHandler([this] () { if(m_iopThread) m_iopThread->Sync(); });
+
+	if(CBlockCodeCache::IsSupported() && CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_CODECACHE_ENABLED))
+	{
+		for(auto& codeCache : m_codeCaches)
+		{
+			codeCache = std::make_unique<CBlockCodeCache>();
+		}
+		m_ee->m_executor.SetCodeCache(m_codeCaches[CODECACHE_EE].get());
+		m_iop->m_executor.SetCodeCache(m_codeCaches[CODECACHE_IOP].get());
+		m_ee->m_vpu0->GetExecutor().SetCodeCache(m_codeCaches[CODECACHE_VU0].get());
+		m_ee->m_vpu1->GetExecutor().SetCodeCache(m_codeCaches[CODECACHE_VU1].get());
+		m_executableChangeConnection = m_ee->m_os->OnExecutableChange.connect(boost::bind(&CPS2VM::LoadCodeCaches, this));
+		m_executableUnloadingConnection = m_ee->m_os->OnExecutableUnloading.connect(boost::bind(&CPS2VM::SaveCodeCaches, this));
+	}
 }
 
 CPS2VM::~CPS2VM()
 {
+	m_executableChangeConnection.disconnect();
+	m_executableUnloadingConnection.disconnect();
 	{
 		//Big hack to force deletion of the IopBios
 		m_iop->SetBios(Iop::BiosBasePtr());
@@ -223,12 +282,13 @@ void CPS2VM::Destroy()
 {
 	m_mailBox.SendCall(std::bind(&CPS2VM::DestroyImpl, this));
 	m_thread.join();
+	WaitForStateWrite();
 	DestroyVM();
 }
 
-unsigned int CPS2VM::SaveState(const char* sPath)
+std::future<bool> CPS2VM::SaveState(const char* sPath)
 {
-	unsigned int result = 0;
+	std::future<bool> result;
 	m_mailBox.SendCall(std::bind(&CPS2VM::SaveVMState, this, sPath, std::ref(result)), true);
 	return result;
 }
@@ -240,6 +300,13 @@ unsigned int CPS2VM::LoadState(const char* sPath)
 	return result;
 }
 
+bool CPS2VM::Rewind()
+{
+	bool result = false;
+	m_mailBox.SendCall(std::bind(&CPS2VM::RewindVMState, this, std::ref(result)), true);
+	return result;
+}
+
 void CPS2VM::TriggerFrameDump(const FrameDumpCallback& frameDumpCallback)
 {
 	m_mailBox.SendCall(
@@ -258,6 +325,11 @@ CPS2VM::CPU_UTILISATION_INFO CPS2VM::GetCpuUtilisationInfo() const
 	return m_cpuUtilisation;
 }
 
+CPS2VM::EXECUTION_STATS CPS2VM::GetExecutionStats() const
+{
+	return m_executionStats;
+}
+
 #ifdef DEBUGGER_INCLUDED
 
 #define TAGS_SECTION_TAGS			("tags")
@@ -360,7 +432,41 @@ void CPS2VM::ResetVM()
 		m_ee->m_gs->Reset();
 	}
 
-	m_iopOs->Reset(std::make_shared<Iop::CSifManPs2>(m_ee->m_sif, m_ee->m_ram, m_iop->m_ram));
+	if(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_MULTITHREADED))
+	{
+		if(!m_iopThread)
+		{
+			m_iopThread = std::make_unique<CSubSystemThread>([] () { fesetround(FE_TOWARDZERO); });
+		}
+	}
+	else
+	{
+		m_iopThread.reset();
+	}
+
+	//VU executors are left out, micro memory can change under a block that is being compiled
+	bool backgroundCompile = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_JIT_BACKGROUNDCOMPILE);
+	m_ee->m_executor.SetBackgroundCompilationEnabled(backgroundCompile);
+	m_iop->m_executor.SetBackgroundCompilationEnabled(backgroundCompile);
+
+	bool superBlocks = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_JIT_SUPERBLOCKS);
+	m_ee->m_executor.SetSuperBlocksEnabled(superBlocks);
+	m_iop->m_executor.SetSuperBlocksEnabled(superBlocks);
+
+	bool profileBlocks = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_JIT_PROFILEBLOCKS);
+	m_ee->m_executor.SetBlockProfilingEnabled(profileBlocks);
+	m_ee->m_vpu0->GetExecutor().SetBlockProfilingEnabled(profileBlocks);
+	m_ee->m_vpu1->GetExecutor().SetBlockProfilingEnabled(profileBlocks);
+	m_iop->m_executor.SetBlockProfilingEnabled(profileBlocks);
+
+	m_rewindBuffer.reset();
+	m_rewindInterval = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_REWIND_ENABLED) ?
+		std::max(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_REWIND_INTERVAL), 1) : 0;
+	m_rewindFrameCount = 0;
+
+	auto sifMan = std::make_shared<Iop::CSifManPs2>(m_ee->m_sif, m_ee->m_ram, m_iop->m_ram);
+	sifMan->SetEeCallHandler([this] (const Iop::CSifManPs2::EeFunction& function) { CallEeFromIop(function); });
+	m_iopOs->Reset(sifMan);
 
 	CDROM0_Reset();
 
@@ -370,13 +476,23 @@ void CPS2VM::ResetVM()
 	m_iopOs->GetIoman()->RegisterDevice("cdrom", Iop::CIoman::DevicePtr(new Iop::Ioman::CIsoDevice(m_cdrom0)));
 	m_iopOs->GetIoman()->RegisterDevice("cdrom0", Iop::CIoman::DevicePtr(new Iop::Ioman::CIsoDevice(m_cdrom0)));
 
-	m_iopOs->GetLoadcore()->SetLoadExecutableHandler(std::bind(&CPS2OS::LoadExecutable, m_ee->m_os, std::placeholders::_1, std::placeholders::_2));
+	m_iopOs->GetLoadcore()->SetLoadExecutableHandler(
+		[this] (const char* path, const char* args)
+		{
+			uint32 result = 0;
+			CallEeFromIop([&] () { result = m_ee->m_os->LoadExecutable(path, args); });
+			return result;
+		}
+	);
 
 	m_vblankTicks = ONSCREEN_TICKS;
 	m_inVblank = false;
 
 	m_eeExecutionTicks = 0;
 	m_iopExecutionTicks = 0;
+	m_eeIdle = false;
+	m_iopIdle = false;
+	m_executionStats = EXECUTION_STATS();
 
 	m_spuUpdateTicks = SPU_UPDATE_TICKS;
 	m_currentSpuBlock = 0;
@@ -386,40 +502,76 @@ void CPS2VM::ResetVM()
 
 void CPS2VM::DestroyVM()
 {
+	//Compile threads use the code caches, stop them before the caches go away
+	m_ee->m_executor.SetBackgroundCompilationEnabled(false);
+	m_iop->m_executor.SetBackgroundCompilationEnabled(false);
+	SaveBlockProfile();
+	SaveCodeCaches();
+	m_iopThread.reset();
 	CDROM0_Destroy();
 }
 
-void CPS2VM::SaveVMState(const char* sPath, unsigned int& result)
+void CPS2VM::SaveVMState(const char* sPath, std::future<bool>& result)
 {
+	auto writeResult = std::make_shared<std::promise<bool>>();
+	result = writeResult->get_future();
+
 	if(m_ee->m_gs == NULL)
 	{
 		printf("PS2VM: GS Handler was not instancied. Cannot save state.\r\n");
-		result = 1;
+		writeResult->set_value(false);
 		return;
 	}
 
+	WaitForStateWrite();
+
+	std::shared_ptr<Framework::CStdStream> stateStream;
+	std::shared_ptr<Framework::CZipArchiveWriter> archive;
+
 	try
 	{
-		Framework::CStdStream stateStream(sPath, "wb");
-		Framework::CZipArchiveWriter archive;
+		stateStream = std::make_shared<Framework::CStdStream>(sPath, "wb");
+		archive = std::make_shared<Framework::CZipArchiveWriter>();
 
-		m_ee->SaveState(archive);
-		m_iop->SaveState(archive);
-		m_ee->m_gs->SaveState(archive);
-		m_iopOs->GetPadman()->SaveState(archive);
+		m_ee->SaveState(*archive);
+		m_iop->SaveState(*archive);
+		m_ee->m_gs->SaveState(*archive);
+		m_iopOs->GetPadman()->SaveState(*archive);
 		//TODO: Save CDVDFSV state
-
-		archive.Write(stateStream);
 	}
 	catch(...)
 	{
-		result = 1;
+		writeResult->set_value(false);
 		return;
 	}
 
-	printf("PS2VM: Saved state to file '%s'.\r\n", sPath);
+	//Archive only holds copies of the machine state at this point, compression and
+	//file output can happen while emulation goes on
+	std::string path(sPath);
+	m_stateWriteThread = std::thread(
+		[stateStream, archive, path, writeResult] ()
+		{
+			try
+			{
+				archive->Write(*stateStream);
+				printf("PS2VM: Saved state to file '%s'.\r\n", path.c_str());
+				writeResult->set_value(true);
+			}
+			catch(...)
+			{
+				printf("PS2VM: Failed to write state to file '%s'.\r\n", path.c_str());
+				writeResult->set_value(false);
+			}
+		}
+	);
+}
 
-	result = 0;
+void CPS2VM::WaitForStateWrite()
+{
+	if(m_stateWriteThread.joinable())
+	{
+		m_stateWriteThread.join();
+	}
 }
 
 void CPS2VM::LoadVMState(const char* sPath, unsigned int& result)
@@ -431,17 +583,40 @@ void CPS2VM::LoadVMState(const char* sPath, unsigned int& result)
 		return;
 	}
 
+	//We might be loading the state that is still being written
+	WaitForStateWrite();
+
 	try
 	{
-		Framework::CStdStream stateStream(sPath, "rb");
+		std::vector<uint8> stateData;
+		{
+			Framework::CStdStream stateFileStream(sPath, "rb");
+			stateData.resize(static_cast<size_t>(stateFileStream.GetLength()));
+			stateFileStream.Read(stateData.data(), stateData.size());
+		}
+
+		//GS state doesn't depend on the rest of the machine, decompress it on
+		//another thread with its own reader while the EE and IOP are loaded
+		auto gsLoadFuture = std::async(std::launch::async,
+			[&] ()
+			{
+				Framework::CPtrStream gsStateStream(stateData.data(), stateData.size());
+				Framework::CZipArchiveReader gsArchive(gsStateStream);
+				m_ee->m_gs->LoadState(gsArchive);
+			}
+		);
+
+		Framework::CPtrStream stateStream(stateData.data(), stateData.size());
 		Framework::CZipArchiveReader archive(stateStream);
 		
 		try
 		{
 			m_ee->LoadState(archive);
 			m_iop->LoadState(archive);
-			m_ee->m_gs->LoadState(archive);
 			m_iopOs->GetPadman()->LoadState(archive);
+			gsLoadFuture.get();
+			m_eeIdle = false;
+			m_iopIdle = false;
 		}
 		catch(...)
 		{
@@ -458,11 +633,80 @@ void CPS2VM::LoadVMState(const char* sPath, unsigned int& result)
 
 	printf("PS2VM: Loaded state from file '%s'.\r\n", sPath);
 
+	//Snapshots taken before this point can't be reached from the loaded state
+	if(m_rewindBuffer)
+	{
+		m_rewindBuffer->Clear();
+	}
+	m_rewindFrameCount = 0;
+
 	OnMachineStateChange();
 
 	result = 0;
 }
 
+void CPS2VM::CaptureRewindSnapshot()
+{
+	if(!m_rewindBuffer)
+	{
+		uint64 memoryBudget = static_cast<uint64>(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_REWIND_MEMORYBUDGET)) * 0x100000;
+		m_rewindBuffer = std::make_unique<CRewindBuffer>(memoryBudget);
+		m_rewindBuffer->AddRegion(m_ee->m_ram, PS2::EE_RAM_SIZE);
+		m_rewindBuffer->AddRegion(m_iop->m_ram, PS2::IOP_RAM_SIZE);
+		m_rewindBuffer->AddRegion(m_iop->m_spuRam, PS2::SPU_RAM_SIZE);
+		m_rewindBuffer->AddRegion(m_ee->m_gs->GetRam(), CGSHandler::RAMSIZE);
+	}
+
+	//Large memory areas are tracked by the rewind buffer, only the rest goes in the archive
+	Framework::CMemStream stateStream;
+	{
+		Framework::CZipArchiveWriter archive;
+		m_ee->SaveState(archive, false);
+		m_iop->SaveState(archive, false);
+		m_ee->m_gs->SaveState(archive, false);
+		m_iopOs->GetPadman()->SaveState(archive);
+		archive.Write(stateStream);
+	}
+
+	m_rewindBuffer->Capture(stateStream.GetBuffer(), stateStream.GetSize());
+}
+
+void CPS2VM::RewindVMState(bool& result)
+{
+	CRewindBuffer::StateData stateData;
+	if(!m_rewindBuffer || !m_rewindBuffer->Restore(stateData))
+	{
+		result = false;
+		return;
+	}
+
+	try
+	{
+		Framework::CPtrStream stateStream(stateData.data(), stateData.size());
+		Framework::CZipArchiveReader archive(stateStream);
+		m_ee->LoadState(archive, false);
+		m_iop->LoadState(archive, false);
+		m_ee->m_gs->LoadState(archive, false);
+		m_iopOs->GetPadman()->LoadState(archive);
+		m_eeIdle = false;
+		m_iopIdle = false;
+	}
+	catch(...)
+	{
+		//Machine state is only partially restored at this point
+		PauseImpl();
+		m_rewindBuffer->Clear();
+		result = false;
+		return;
+	}
+
+	m_rewindFrameCount = 0;
+
+	OnMachineStateChange();
+
+	result = true;
+}
+
 void CPS2VM::PauseImpl()
 {
 	m_nStatus = PAUSED;
@@ -495,6 +739,7 @@ void CPS2VM::CreateGsHandlerImpl(const CGSHandler::FactoryFunction& factoryFunct
 
 void CPS2VM::DestroyGsHandlerImpl()
 {
+	m_rewindBuffer.reset();
 	if(m_ee->m_gs == nullptr) return;
 	m_ee->m_gs->Release();
 	delete m_ee->m_gs;
@@ -516,12 +761,29 @@ void CPS2VM::DestroyPadHandlerImpl()
 
 void CPS2VM::CreateSoundHandlerImpl(const CSoundHandler::FactoryFunction& factoryFunction)
 {
+	//Frontends can replace the sound handler while one is already running
+	DestroySoundHandlerImpl();
 	m_soundHandler = factoryFunction();
+	m_soundThreadDone = false;
+	m_soundThread = std::thread([&] () { SoundThread(); });
 }
 
 void CPS2VM::DestroySoundHandlerImpl()
 {
 	if(m_soundHandler == nullptr) return;
+	{
+		std::lock_guard<std::mutex> soundThreadLock(m_soundThreadMutex);
+		m_soundThreadDone = true;
+		m_soundThreadCondition.notify_one();
+	}
+	m_soundThread.join();
+	//Discard samples that were never sent to this handler
+	uint32 type = 0;
+	uint32 size = 0;
+	while(m_soundRing.ReadCommand(type, size))
+	{
+		m_soundRing.ReleaseCommand();
+	}
 	delete m_soundHandler;
 	m_soundHandler = nullptr;
 }
@@ -557,17 +819,20 @@ void CPS2VM::UpdateEe()
 
 	while(m_eeExecutionTicks > 0)
 	{
-		int executed = m_ee->ExecuteCpu(m_singleStepEe ? 1 : m_eeExecutionTicks);
-		if(m_ee->IsCpuIdle())
+		int executed = m_ee->ExecuteCpu(m_singleStepEe ? 1 : std::min(m_eeExecutionTicks, TICK_STEP));
+		m_eeIdle = m_ee->IsCpuIdle();
+		if(m_eeIdle)
 		{
 #ifdef PROFILE
 			m_cpuUtilisation.eeIdleTicks += (m_eeExecutionTicks - executed);
 #endif
+			m_executionStats.eeIdleTicks += (m_eeExecutionTicks - executed);
 			executed = m_eeExecutionTicks;
 		}
 #ifdef PROFILE
 		m_cpuUtilisation.eeTotalTicks += executed;
 #endif
+		m_executionStats.eeTotalTicks += executed;
 
 		m_ee->m_vpu0->Execute(m_singleStepVu0 ? 1 : executed);
 		m_ee->m_vpu1->Execute(m_singleStepVu1 ? 1 : executed);
@@ -591,17 +856,20 @@ void CPS2VM::UpdateIop()
 
 	while(m_iopExecutionTicks > 0)
 	{
-		int executed = m_iop->ExecuteCpu(m_singleStepIop ? 1 : m_iopExecutionTicks);
-		if(m_iop->IsCpuIdle())
+		int executed = m_iop->ExecuteCpu(m_singleStepIop ? 1 : std::min(m_iopExecutionTicks, IOP_TICK_STEP));
+		m_iopIdle = m_iop->IsCpuIdle();
+		if(m_iopIdle)
 		{
 #ifdef PROFILE
 			m_cpuUtilisation.iopIdleTicks += (m_iopExecutionTicks - executed);
 #endif
+			m_executionStats.iopIdleTicks += (m_iopExecutionTicks - executed);
 			executed = m_iopExecutionTicks;
 		}
 #ifdef PROFILE
 		m_cpuUtilisation.iopTotalTicks += executed;
 #endif
+		m_executionStats.iopTotalTicks += executed;
 
 		m_iopExecutionTicks -= executed;
 		m_spuUpdateTicks -= executed;
@@ -614,6 +882,140 @@ void CPS2VM::UpdateIop()
 	}
 }
 
+void CPS2VM::CallEeFromIop(const CSubSystemThread::FunctionType& function)
+{
+	//When the IOP runs on its own thread, anything touching EE state needs to run on the EE thread
+	if(m_iopThread && m_iopThread->IsCurrentThread())
+	{
+		m_iopThread->SendMainThreadCall(function);
+	}
+	else
+	{
+		function();
+	}
+}
+
+static std::string MakeCodeCacheName(const char* executableName)
+{
+	//Executable names look like "cdrom0:\SLUS_200.02;1", only keep the file name part
+	std::string result = executableName;
+	auto separatorPosition = result.find_last_of(":\\/");
+	if(separatorPosition != std::string::npos)
+	{
+		result = result.substr(separatorPosition + 1);
+	}
+	auto versionPosition = result.find(';');
+	if(versionPosition != std::string::npos)
+	{
+		result = result.substr(0, versionPosition);
+	}
+	for(auto& character : result)
+	{
+		if(!isalnum(static_cast<unsigned char>(character)) && (character != '.') && (character != '_') && (character != '-'))
+		{
+			character = '_';
+		}
+	}
+	return result;
+}
+
+static Framework::CConfig::PathType GetCodeCachePath(const std::string& codeCacheName, unsigned int codeCacheIndex)
+{
+	auto codeCachePath = CAppConfig::GetBasePath() / boost::filesystem::path(CODECACHE_PATH);
+	Framework::PathUtils::EnsurePathExists(codeCachePath);
+	return codeCachePath / (codeCacheName + g_codeCacheExtensions[codeCacheIndex]);
+}
+
+void CPS2VM::LoadCodeCaches()
+{
+	m_codeCacheName = MakeCodeCacheName(m_ee->m_os->GetExecutableName());
+	if(m_codeCacheName.empty()) return;
+
+	for(unsigned int i = 0; i < CODECACHE_COUNT; i++)
+	{
+		auto& codeCache = m_codeCaches[i];
+		codeCache->Clear();
+		auto codeCachePath = GetCodeCachePath(m_codeCacheName, i);
+		if(!boost::filesystem::exists(codeCachePath)) continue;
+		try
+		{
+			auto stream = Framework::CreateInputStdStream(codeCachePath.native());
+			codeCache->Load(stream);
+		}
+		catch(const std::exception& exception)
+		{
+			//Cache will be rebuilt and overwritten
+			codeCache->Clear();
+			printf("PS2VM: Failed to load code cache '%s': %s\r\n", codeCachePath.string().c_str(), exception.what());
+		}
+	}
+}
+
+void CPS2VM::SaveCodeCaches()
+{
+	if(m_codeCacheName.empty()) return;
+
+	for(unsigned int i = 0; i < CODECACHE_COUNT; i++)
+	{
+		auto& codeCache = m_codeCaches[i];
+		if(codeCache->IsDirty())
+		{
+			auto codeCachePath = GetCodeCachePath(m_codeCacheName, i);
+			try
+			{
+				auto stream = Framework::CreateOutputStdStream(codeCachePath.native());
+				codeCache->Save(stream);
+			}
+			catch(const std::exception& exception)
+			{
+				printf("PS2VM: Failed to save code cache '%s': %s\r\n", codeCachePath.string().c_str(), exception.what());
+			}
+		}
+		codeCache->Clear();
+	}
+	m_codeCacheName.clear();
+}
+
+void CPS2VM::SaveBlockProfile()
+{
+	if(!CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_JIT_PROFILEBLOCKS)) return;
+
+	auto profilePath = CAppConfig::GetBasePath() / boost::filesystem::path(BLOCKPROFILE_PATH);
+	try
+	{
+		auto stream = Framework::CreateOutputStdStream(profilePath.native());
+		fprintf(stream, "EE:\n");
+		m_ee->m_executor.SaveBlockProfile(stream);
+		fprintf(stream, "\nVU0:\n");
+		m_ee->m_vpu0->GetExecutor().SaveBlockProfile(stream);
+		fprintf(stream, "\nVU1:\n");
+		m_ee->m_vpu1->GetExecutor().SaveBlockProfile(stream);
+		fprintf(stream, "\nIOP:\n");
+		m_iop->m_executor.SaveBlockProfile(stream);
+	}
+	catch(const std::exception& exception)
+	{
+		printf("PS2VM: Failed to save block profile '%s': %s\r\n", profilePath.string().c_str(), exception.what());
+	}
+}
+
+int CPS2VM::GetTickStep()
+{
+	//When both CPUs are waiting for something to happen, jump straight to the next scheduled
+	//event (vblank edge, timer interrupt, IOP thread wake up, SPU update) instead of moving
+	//forward in small steps
+	if(!m_eeIdle || !m_iopIdle) return TICK_STEP;
+	if(m_singleStepEe || m_singleStepIop || m_singleStepVu0 || m_singleStepVu1) return TICK_STEP;
+
+	int64 eventTicks = m_vblankTicks;
+	eventTicks = std::min<int64>(eventTicks, m_ee->GetTicksUntilNextEvent());
+	eventTicks = std::min<int64>(eventTicks, static_cast<int64>(m_iop->GetTicksUntilNextEvent()) * 8);
+	eventTicks = std::min<int64>(eventTicks, static_cast<int64>(m_spuUpdateTicks) * 8);
+	eventTicks &= ~7;
+
+	return static_cast<int>(std::max<int64>(eventTicks, TICK_STEP));
+}
+
 void CPS2VM::UpdateSpu()
 {
 #ifdef PROFILE
@@ -644,19 +1046,55 @@ void CPS2VM::UpdateSpu()
 	{
 		if(m_soundHandler)
 		{
-			if(m_soundHandler->HasFreeBuffers())
+			//Emulation never waits on the sound thread, samples are dropped if it falls behind
+			if(void* command = m_soundRing.TryBeginCommand(0, sizeof(m_samples)))
 			{
-				m_soundHandler->RecycleBuffers();
+				memcpy(command, m_samples, sizeof(m_samples));
+				if(m_soundRing.EndCommand())
+				{
+					std::lock_guard<std::mutex> soundThreadLock(m_soundThreadMutex);
+					m_soundThreadCondition.notify_one();
+				}
 			}
-			m_soundHandler->Write(m_samples, BLOCK_SIZE * BLOCK_COUNT, 44100);
 		}
 		m_currentSpuBlock = 0;
 	}
 }
 
+void CPS2VM::SoundThread()
+{
+	while(!m_soundThreadDone)
+	{
+		uint32 type = 0;
+		uint32 size = 0;
+		if(void* samples = m_soundRing.ReadCommand(type, size))
+		{
+			m_soundHandler->RecycleBuffers();
+			if(!m_soundHandler->HasFreeBuffers())
+			{
+				//Keep the samples until the device is done with one of its buffers
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+				continue;
+			}
+			m_soundHandler->Write(reinterpret_cast<int16*>(samples), size / sizeof(int16), 44100);
+			m_soundRing.ReleaseCommand();
+			continue;
+		}
+		std::unique_lock<std::mutex> soundThreadLock(m_soundThreadMutex);
+		if(m_soundThreadDone) break;
+		if(m_soundRing.BeginWait())
+		{
+			m_soundThreadCondition.wait_for(soundThreadLock, std::chrono::milliseconds(100));
+			m_soundRing.EndWait();
+		}
+	}
+}
+
 void CPS2VM::CDROM0_Initialize()
 {
 	CAppConfig::GetInstance().RegisterPreferenceString(PS2VM_CDROM0PATH, "");
+	//Size in megabytes of the decompressed data cache for compressed disk images
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PS2VM_CDROM0IMAGECACHESIZE, CImageBlockCache::DEFAULT_MEMORY_BUDGET / 0x100000);
 	m_cdrom0.reset();
 }
 
@@ -676,7 +1114,8 @@ void CPS2VM::CDROM0_Mount(const char* path)
 	{
 		try
 		{
-			m_cdrom0 = DiskUtils::CreateDiskImageFromPath(path);
+			uint64 imageCacheSize = static_cast<uint64>(CAppConfig::GetInstance().GetPreferenceInteger(PS2VM_CDROM0IMAGECACHESIZE)) * 0x100000;
+			m_cdrom0 = DiskUtils::CreateDiskImageFromPath(path, imageCacheSize);
 			SetIopCdImage(m_cdrom0.get());
 		}
 		catch(const std::exception& Exception)
@@ -736,7 +1175,7 @@ void CPS2VM::EmuThread()
 		}
 		if(m_nStatus == RUNNING)
 		{
-			if(m_spuUpdateTicks <= 0)
+			if(!m_iopThread && (m_spuUpdateTicks <= 0))
 			{
 				UpdateSpu();
 				m_spuUpdateTicks += SPU_UPDATE_TICKS;
@@ -776,6 +1215,13 @@ void CPS2VM::EmuThread()
 
 						m_cpuUtilisation = CPU_UTILISATION_INFO();
 #endif
+						if((m_rewindInterval != 0) && (m_ee->m_gs != NULL) && (++m_rewindFrameCount >= m_rewindInterval))
+						{
+							CaptureRewindSnapshot();
+							m_rewindFrameCount = 0;
+						}
+
+						OnNewFrame();
 					}
 					else
 					{
@@ -789,13 +1235,33 @@ void CPS2VM::EmuThread()
 					}
 				}
 
-				//EE CPU is 8 times faster than the IOP CPU
-				static const int tickStep = 4800;
+				int tickStep = GetTickStep();
 				m_eeExecutionTicks += tickStep;
 				m_iopExecutionTicks += tickStep / 8;
 
-				UpdateEe();
-				UpdateIop();
+				if(m_iopThread)
+				{
+					//IOP runs in parallel with the EE until the end of the slice
+					//or until the EE needs to exchange data with it through SIF
+					m_iopThread->BeginSlice(
+						[this] ()
+						{
+							if(m_spuUpdateTicks <= 0)
+							{
+								UpdateSpu();
+								m_spuUpdateTicks += SPU_UPDATE_TICKS;
+							}
+							UpdateIop();
+						}
+					);
+					UpdateEe();
+					m_iopThread->Sync();
+				}
+				else
+				{
+					UpdateEe();
+					UpdateIop();
+				}
 			}
 #ifdef DEBUGGER_INCLUDED
 			if(
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <future>
 #include "AppDef.h"
 #include "Types.h"
 #include "MIPS.h"
@@ -14,10 +17,23 @@
 #include "../tools/PsfPlayer/Source/SoundHandler.h"
 #include "FrameDump.h"
 #include "Profiler.h"
+#include "SubSystemThread.h"
+#include "BlockCodeCache.h"
+#include "CommandRing.h"
+#include "RewindBuffer.h"
 
 #define PREF_PS2_HOST_DIRECTORY				("ps2.host.directory")
 #define PREF_PS2_MC0_DIRECTORY				("ps2.mc0.directory")
 #define PREF_PS2_MC1_DIRECTORY				("ps2.mc1.directory")
+#define PREF_PS2_MULTITHREADED				("ps2.multithreaded")
+#define PREF_PS2_CODECACHE_ENABLED			("ps2.codecache.enabled")
+#define PREF_PS2_JIT_BACKGROUNDCOMPILE		("ps2.jit.backgroundcompile")
+#define PREF_PS2_JIT_SUPERBLOCKS			("ps2.jit.superblocks")
+#define PREF_PS2_JIT_PERFMAP				("ps2.jit.perfmap")
+#define PREF_PS2_JIT_PROFILEBLOCKS			("ps2.jit.profileblocks")
+#define PREF_PS2_REWIND_ENABLED				("ps2.rewind.enabled")
+#define PREF_PS2_REWIND_INTERVAL			("ps2.rewind.interval")
+#define PREF_PS2_REWIND_MEMORYBUDGET		("ps2.rewind.memorybudget")
 
 class CPS2VM : public CVirtualMachine
 {
@@ -31,10 +47,20 @@ public:
 		int32 iopIdleTicks = 0;
 	};
 
+	struct EXECUTION_STATS
+	{
+		uint64 eeTotalTicks = 0;
+		uint64 eeIdleTicks = 0;
+
+		uint64 iopTotalTicks = 0;
+		uint64 iopIdleTicks = 0;
+	};
+
 	typedef std::unique_ptr<Ee::CSubSystem> EeSubSystemPtr;
 	typedef std::unique_ptr<Iop::CSubSystem> IopSubSystemPtr;
 	typedef std::function<void (const CFrameDump&)> FrameDumpCallback;
 	typedef boost::signals2::signal<void (const CProfiler::ZoneArray&)> ProfileFrameDoneSignal;
+	typedef boost::signals2::signal<void ()> NewFrameEvent;
 
 								CPS2VM();
 	virtual						~CPS2VM();
@@ -67,12 +93,14 @@ public:
 	void						CreateSoundHandler(const CSoundHandler::FactoryFunction&);
 	void						DestroySoundHandler();
 
-	unsigned int				SaveState(const char*);
+	std::future<bool>			SaveState(const char*);
 	unsigned int				LoadState(const char*);
+	bool						Rewind();
 
 	void						TriggerFrameDump(const FrameDumpCallback&);
 
 	CPU_UTILISATION_INFO		GetCpuUtilisationInfo() const;
+	EXECUTION_STATS				GetExecutionStats() const;
 
 #ifdef DEBUGGER_INCLUDED
 	std::string					MakeDebugTagsPackagePath(const char*);
@@ -88,15 +116,29 @@ public:
 	IopBiosPtr					m_iopOs;
 
 	ProfileFrameDoneSignal		ProfileFrameDone;
+	NewFrameEvent				OnNewFrame;
 
 private:
 	typedef std::unique_ptr<CISO9660> Iso9660Ptr;
+	typedef std::unique_ptr<CBlockCodeCache> CodeCachePtr;
+
+	enum CODECACHE
+	{
+		CODECACHE_EE,
+		CODECACHE_IOP,
+		CODECACHE_VU0,
+		CODECACHE_VU1,
+		CODECACHE_COUNT,
+	};
 
 	void						CreateVM();
 	void						ResetVM();
 	void						DestroyVM();
-	void						SaveVMState(const char*, unsigned int&);
+	void						SaveVMState(const char*, std::future<bool>&);
 	void						LoadVMState(const char*, unsigned int&);
+	void						WaitForStateWrite();
+	void						CaptureRewindSnapshot();
+	void						RewindVMState(bool&);
 
 	void						ReloadExecutable(const char*, const CPS2OS::ArgumentList&);
 
@@ -117,6 +159,8 @@ private:
 	void						UpdateIop();
 	void						UpdateSpu();
 
+	int							GetTickStep();
+
 	void						OnGsNewFrame();
 
 	void						CDROM0_Initialize();
@@ -127,9 +171,18 @@ private:
 
 	void						RegisterModulesInPadHandler();
 
+	void						CallEeFromIop(const CSubSystemThread::FunctionType&);
+
+	void						LoadCodeCaches();
+	void						SaveCodeCaches();
+
+	void						SaveBlockProfile();
+
 	void						EmuThread();
+	void						SoundThread();
 
 	std::thread					m_thread;
+	std::unique_ptr<CSubSystemThread>	m_iopThread;
 	CMailBox					m_mailBox;
 	STATUS						m_nStatus;
 	bool						m_nEnd;
@@ -139,8 +192,11 @@ private:
 	int							m_spuUpdateTicks = 0;
 	int							m_eeExecutionTicks = 0;
 	int							m_iopExecutionTicks = 0;
+	bool						m_eeIdle = false;
+	bool						m_iopIdle = false;
 
 	CPU_UTILISATION_INFO		m_cpuUtilisation;
+	EXECUTION_STATS				m_executionStats;
 
 	bool						m_singleStepEe;
 	bool						m_singleStepIop;
@@ -154,17 +210,38 @@ private:
 
 	Iso9660Ptr					m_cdrom0;
 
+	CodeCachePtr				m_codeCaches[CODECACHE_COUNT];
+	std::string					m_codeCacheName;
+	boost::signals2::connection	m_executableChangeConnection;
+	boost::signals2::connection	m_executableUnloadingConnection;
+
 	enum
 	{
 		SAMPLE_COUNT = 44,
 		BLOCK_SIZE = SAMPLE_COUNT * 2,
 		BLOCK_COUNT = 400,
+		//Holds 2 to 3 batches of samples (depending on wrap around)
+		SOUND_RING_SIZE = 0x40000,
 	};
 
 	int16						m_samples[BLOCK_SIZE * BLOCK_COUNT];
 	int							m_currentSpuBlock = 0;
 	CSoundHandler*				m_soundHandler = nullptr;
 
+	//Rendered samples are handed to the sound handler by a separate thread
+	std::thread					m_soundThread;
+	CCommandRing				m_soundRing;
+	std::mutex					m_soundThreadMutex;
+	std::condition_variable		m_soundThreadCondition;
+	std::atomic<bool>			m_soundThreadDone;
+
+	//Compresses and writes the last saved state, its outcome is reported through the future returned by SaveState
+	std::thread					m_stateWriteThread;
+
+	std::unique_ptr<CRewindBuffer>	m_rewindBuffer;
+	unsigned int				m_rewindInterval = 0;
+	unsigned int				m_rewindFrameCount = 0;
+
 	CProfiler::ZoneHandle		m_eeProfilerZone = 0;
 	CProfiler::ZoneHandle		m_iopProfilerZone = 0;
 	CProfiler::ZoneHandle		m_spuProfilerZone = 0;
@@ -2,5 +2,6 @@
 #define _PS2VM_PREFERENCES_H_
 
 #define PS2VM_CDROM0PATH		"ps2.cdrom0.path"
+#define PS2VM_CDROM0IMAGECACHESIZE	"ps2.cdrom0.imagecachesize"
 
 #endif
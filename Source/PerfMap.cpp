@@ -0,0 +1,36 @@
+#include <cinttypes>
+#include "make_unique.h"
+#include "PerfMap.h"
+#include "string_format.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+void CPerfMap::SetEnabled(bool enabled)
+{
+#ifdef __linux__
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(enabled && !m_stream)
+	{
+		//A file left by an older process with the same pid would be stale, start over. The stream stays
+		//open if we get disabled, so entries keep going to the same file if we get enabled again
+		auto path = string_format("/tmp/perf-%d.map", getpid());
+		m_stream = std::make_unique<Framework::CStdStream>(path.c_str(), "wb");
+	}
+	m_enabled = enabled;
+#endif
+}
+
+bool CPerfMap::IsEnabled() const
+{
+	return m_enabled;
+}
+
+void CPerfMap::AddFunction(const void* code, size_t size, const char* name)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(!m_enabled) return;
+	fprintf(*m_stream, "%" PRIxPTR " %zx %s\n", reinterpret_cast<uintptr_t>(code), size, name);
+	m_stream->Flush();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "Singleton.h"
+#include "StdStream.h"
+
+//Writes the location of generated code to /tmp/perf-<pid>.map so that Linux's perf
+//can attribute samples to guest code. Does nothing on other platforms.
+class CPerfMap : public CSingleton<CPerfMap>
+{
+public:
+	void								SetEnabled(bool);
+	bool								IsEnabled() const;
+
+	void								AddFunction(const void*, size_t, const char*);
+
+private:
+	typedef std::unique_ptr<Framework::CStdStream> StreamPtr;
+
+	std::mutex							m_mutex;
+	StreamPtr							m_stream;
+	std::atomic<bool>					m_enabled = {false};
+};
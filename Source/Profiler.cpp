@@ -87,9 +87,12 @@ void CProfiler::Reset()
 
 void CProfiler::SetWorkThread()
 {
-#ifdef _DEBUG
 	m_workThreadId = std::this_thread::get_id();
-#endif
+}
+
+bool CProfiler::IsWorkThread() const
+{
+	return std::this_thread::get_id() == m_workThreadId;
 }
 
 void CProfiler::AddTimeToZone(ZoneHandle zoneHandle, uint64 timeNs)
@@ -102,9 +105,12 @@ void CProfiler::AddTimeToZone(ZoneHandle zoneHandle, uint64 timeNs)
 //////////////////////////////////////////////////////////////////////////
 //CProfilerZone
 
+//Zones are only tracked on the work thread, time spent in other threads isn't accounted for
+
 CProfilerZone::CProfilerZone(CProfiler::ZoneHandle handle)
 {
 #ifdef PROFILE
+	if(!CProfiler::GetInstance().IsWorkThread()) return;
 	CProfiler::GetInstance().EnterZone(handle);
 #endif
 }
@@ -112,6 +118,7 @@ CProfilerZone::CProfilerZone(CProfiler::ZoneHandle handle)
 CProfilerZone::~CProfilerZone()
 {
 #ifdef PROFILE
+	if(!CProfiler::GetInstance().IsWorkThread()) return;
 	CProfiler::GetInstance().ExitZone();
 #endif
 }
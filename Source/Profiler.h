@@ -36,6 +36,7 @@ public:
 	void				Reset();
 
 	void				SetWorkThread();
+	bool				IsWorkThread() const;
 	
 private:
 	typedef std::stack<ZoneHandle> ZoneStack;
@@ -46,9 +47,7 @@ private:
 	ZoneStack			m_zoneStack;
 	TimePoint			m_currentTime;
 	
-#ifdef _DEBUG
 	std::thread::id		m_workThreadId;
-#endif
 };
 
 class CProfilerZone
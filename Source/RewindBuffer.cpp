@@ -0,0 +1,119 @@
+#include <cassert>
+#include <cstring>
+#include "RewindBuffer.h"
+
+CRewindBuffer::CRewindBuffer(uint64 memoryBudget)
+: m_memoryBudget(memoryBudget)
+{
+
+}
+
+void CRewindBuffer::AddRegion(uint8* memory, uint32 size)
+{
+	assert((size % PAGE_SIZE) == 0);
+	REGION region;
+	region.memory = memory;
+	region.size = size;
+	region.contents.resize(size);
+	m_regions.push_back(std::move(region));
+	Clear();
+}
+
+void CRewindBuffer::Clear()
+{
+	m_snapshots.clear();
+	m_memoryUsage = 0;
+}
+
+void CRewindBuffer::Capture(const void* state, uint32 stateSize)
+{
+	SNAPSHOT snapshot;
+	snapshot.state.assign(reinterpret_cast<const uint8*>(state), reinterpret_cast<const uint8*>(state) + stateSize);
+
+	if(m_snapshots.empty())
+	{
+		//Nothing to compare against, only keep the current contents
+		for(auto& region : m_regions)
+		{
+			memcpy(region.contents.data(), region.memory, region.size);
+		}
+	}
+	else
+	{
+		for(uint32 regionIndex = 0; regionIndex < m_regions.size(); regionIndex++)
+		{
+			auto& region = m_regions[regionIndex];
+			for(uint32 offset = 0; offset < region.size; offset += PAGE_SIZE)
+			{
+				const uint8* currentPage = region.memory + offset;
+				uint8* savedPage = region.contents.data() + offset;
+				if(memcmp(currentPage, savedPage, PAGE_SIZE) == 0) continue;
+				snapshot.pages.push_back(PAGE { regionIndex, offset });
+				snapshot.pageData.insert(std::end(snapshot.pageData), savedPage, savedPage + PAGE_SIZE);
+				memcpy(savedPage, currentPage, PAGE_SIZE);
+			}
+		}
+	}
+
+	m_memoryUsage += GetSnapshotSize(snapshot);
+	m_snapshots.push_back(std::move(snapshot));
+
+	while((m_memoryUsage > m_memoryBudget) && (m_snapshots.size() > 1))
+	{
+		m_memoryUsage -= GetSnapshotSize(m_snapshots.front());
+		m_snapshots.pop_front();
+		DropOldestPages();
+	}
+}
+
+bool CRewindBuffer::Restore(StateData& state)
+{
+	if(m_snapshots.empty()) return false;
+
+	auto& snapshot = m_snapshots.back();
+	m_memoryUsage -= GetSnapshotSize(snapshot);
+
+	for(auto& region : m_regions)
+	{
+		memcpy(region.memory, region.contents.data(), region.size);
+	}
+
+	//Bring the saved contents back to the previous snapshot so that
+	//restoring again goes further back
+	for(uint32 pageIndex = 0; pageIndex < snapshot.pages.size(); pageIndex++)
+	{
+		const auto& page = snapshot.pages[pageIndex];
+		auto& region = m_regions[page.regionIndex];
+		memcpy(region.contents.data() + page.offset, snapshot.pageData.data() + (pageIndex * PAGE_SIZE), PAGE_SIZE);
+	}
+
+	state = std::move(snapshot.state);
+	m_snapshots.pop_back();
+	return true;
+}
+
+unsigned int CRewindBuffer::GetSnapshotCount() const
+{
+	return static_cast<unsigned int>(m_snapshots.size());
+}
+
+uint64 CRewindBuffer::GetMemoryUsage() const
+{
+	return m_memoryUsage;
+}
+
+uint64 CRewindBuffer::GetSnapshotSize(const SNAPSHOT& snapshot)
+{
+	return snapshot.state.size() + snapshot.pageData.size() + (snapshot.pages.size() * sizeof(PAGE));
+}
+
+void CRewindBuffer::DropOldestPages()
+{
+	//Pages of the oldest snapshot would only be used to go back past it
+	assert(!m_snapshots.empty());
+	auto& snapshot = m_snapshots.front();
+	m_memoryUsage -= GetSnapshotSize(snapshot);
+	snapshot.pages = std::vector<PAGE>();
+	snapshot.pageData = std::vector<uint8>();
+	m_memoryUsage += GetSnapshotSize(snapshot);
+}
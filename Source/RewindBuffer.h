@@ -0,0 +1,62 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "Types.h"
+
+//Keeps the most recent machine snapshots in memory. Large memory regions are compared
+//page by page against their contents at the previous snapshot and only changed pages are
+//stored. The rest of the machine state is kept as an opaque blob supplied by the caller.
+//The memory budget covers snapshot data only, a copy of every region is always kept on top of it.
+class CRewindBuffer
+{
+public:
+	typedef std::vector<uint8> StateData;
+
+	enum
+	{
+		PAGE_SIZE = 0x1000,
+		DEFAULT_MEMORY_BUDGET = 0x10000000,
+	};
+
+								CRewindBuffer(uint64 = DEFAULT_MEMORY_BUDGET);
+
+	void						AddRegion(uint8*, uint32);
+	void						Clear();
+
+	void						Capture(const void*, uint32);
+	bool						Restore(StateData&);
+
+	unsigned int				GetSnapshotCount() const;
+	uint64						GetMemoryUsage() const;
+
+private:
+	struct REGION
+	{
+		uint8*					memory;
+		uint32					size;
+		std::vector<uint8>		contents;
+	};
+
+	struct PAGE
+	{
+		uint32					regionIndex;
+		uint32					offset;
+	};
+
+	//Pages hold the region contents as they were before this snapshot was taken
+	struct SNAPSHOT
+	{
+		StateData				state;
+		std::vector<PAGE>		pages;
+		std::vector<uint8>		pageData;
+	};
+
+	static uint64				GetSnapshotSize(const SNAPSHOT&);
+	void						DropOldestPages();
+
+	uint64						m_memoryBudget = 0;
+	uint64						m_memoryUsage = 0;
+	std::vector<REGION>			m_regions;
+	std::deque<SNAPSHOT>		m_snapshots;
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+//Vector instruction set available on the target, code using it needs to keep a plain C++ version for other targets
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define HAS_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAS_NEON
+#include <arm_neon.h>
+#endif
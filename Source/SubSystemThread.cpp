@@ -0,0 +1,119 @@
+#include <cassert>
+#include "SubSystemThread.h"
+
+CSubSystemThread::CSubSystemThread(const FunctionType& threadStartFunction)
+{
+	m_thread = std::thread([this, threadStartFunction] () { ThreadProc(threadStartFunction); });
+}
+
+CSubSystemThread::~CSubSystemThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		assert(!m_sliceRunning);
+		m_threadDone = true;
+	}
+	m_subSystemThreadCondition.notify_all();
+	m_thread.join();
+}
+
+bool CSubSystemThread::IsCurrentThread() const
+{
+	return std::this_thread::get_id() == m_thread.get_id();
+}
+
+void CSubSystemThread::BeginSlice(const FunctionType& slice)
+{
+	assert(!IsCurrentThread());
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		assert(!m_sliceRunning);
+		m_slice = slice;
+		m_sliceRunning = true;
+	}
+	m_subSystemThreadCondition.notify_all();
+}
+
+void CSubSystemThread::Sync()
+{
+	assert(!IsCurrentThread());
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(1)
+	{
+		m_mainThreadCondition.wait(lock, [this] () { return !m_sliceRunning || m_mainThreadCall; });
+		if(!m_mainThreadCall) break;
+
+		//Subsystem thread is waiting on us, run its call
+		auto call = std::move(m_mainThreadCall);
+		m_mainThreadCall = FunctionType();
+		lock.unlock();
+		std::exception_ptr callException;
+		try
+		{
+			call();
+		}
+		catch(...)
+		{
+			callException = std::current_exception();
+		}
+		lock.lock();
+		m_mainThreadCallException = callException;
+		m_mainThreadCallDone = true;
+		m_subSystemThreadCondition.notify_all();
+	}
+
+	if(m_sliceException)
+	{
+		auto sliceException = m_sliceException;
+		m_sliceException = std::exception_ptr();
+		std::rethrow_exception(sliceException);
+	}
+}
+
+void CSubSystemThread::SendMainThreadCall(const FunctionType& function)
+{
+	assert(IsCurrentThread());
+	std::unique_lock<std::mutex> lock(m_mutex);
+	assert(!m_mainThreadCall);
+	m_mainThreadCall = function;
+	m_mainThreadCallDone = false;
+	m_mainThreadCondition.notify_all();
+	m_subSystemThreadCondition.wait(lock, [this] () { return m_mainThreadCallDone; });
+	if(m_mainThreadCallException)
+	{
+		auto callException = m_mainThreadCallException;
+		m_mainThreadCallException = std::exception_ptr();
+		std::rethrow_exception(callException);
+	}
+}
+
+void CSubSystemThread::ThreadProc(FunctionType threadStartFunction)
+{
+	if(threadStartFunction)
+	{
+		threadStartFunction();
+	}
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(1)
+	{
+		m_subSystemThreadCondition.wait(lock, [this] () { return m_threadDone || m_sliceRunning; });
+		if(m_threadDone) break;
+
+		auto slice = std::move(m_slice);
+		m_slice = FunctionType();
+		lock.unlock();
+		std::exception_ptr sliceException;
+		try
+		{
+			slice();
+		}
+		catch(...)
+		{
+			sliceException = std::current_exception();
+		}
+		lock.lock();
+		m_sliceException = sliceException;
+		m_sliceRunning = false;
+		m_mainThreadCondition.notify_all();
+	}
+}
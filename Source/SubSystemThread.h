@@ -0,0 +1,47 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+//Runs slices of work for a subsystem on its own thread, in parallel with the main emulation thread.
+//The subsystem thread never touches state owned by the main thread directly: it sends calls that
+//are executed by the main thread when it reaches a sync point (Sync). Since the main thread only
+//looks at the subsystem's state after a Sync, results don't depend on how the threads are scheduled.
+class CSubSystemThread
+{
+public:
+	typedef std::function<void ()> FunctionType;
+
+							CSubSystemThread(const FunctionType& = FunctionType());
+	virtual					~CSubSystemThread();
+
+	bool					IsCurrentThread() const;
+
+	//Called from the main thread
+	void					BeginSlice(const FunctionType&);
+	void					Sync();
+
+	//Called from the subsystem thread, blocks until the main thread has executed the function
+	void					SendMainThreadCall(const FunctionType&);
+
+private:
+	void					ThreadProc(FunctionType);
+
+	std::mutex				m_mutex;
+	std::condition_variable	m_mainThreadCondition;
+	std::condition_variable	m_subSystemThreadCondition;
+
+	FunctionType			m_slice;
+	bool					m_sliceRunning = false;
+	std::exception_ptr		m_sliceException;
+
+	FunctionType			m_mainThreadCall;
+	bool					m_mainThreadCallDone = false;
+	std::exception_ptr		m_mainThreadCallException;
+
+	bool					m_threadDone = false;
+	std::thread				m_thread;
+};
@@ -0,0 +1,122 @@
+#include "SuperBlock.h"
+#include "MipsJitter.h"
+#include "offsetof_def.h"
+#include "string_format.h"
+
+CSuperBlock::CSuperBlock(CMIPS& context, const BlockArray& blocks, const LinkArray& links)
+: CBasicBlock(context, blocks.front()->GetBeginAddress(), blocks.front()->GetEndAddress())
+, m_links(links)
+{
+	assert(blocks.size() >= 2);
+	assert(links.size() == (blocks.size() - 1));
+	unsigned int instructionCount = 0;
+	for(const auto& block : blocks)
+	{
+		RANGE range;
+		range.begin = block->GetBeginAddress();
+		range.end = block->GetEndAddress();
+		instructionCount += ((range.end - range.begin) / 4) + 1;
+		range.instructionCount = instructionCount;
+		m_ranges.push_back(range);
+	}
+}
+
+CSuperBlock::~CSuperBlock()
+{
+
+}
+
+unsigned int CSuperBlock::Execute()
+{
+	m_function(&m_context);
+
+	assert(m_context.m_superBlockExitIndex < m_ranges.size());
+	const auto& range = m_ranges[m_context.m_superBlockExitIndex];
+
+	if(m_context.m_State.nDelayedJumpAddr != MIPS_INVALID_PC)
+	{
+		m_context.m_State.nPC = m_context.m_State.nDelayedJumpAddr;
+		m_context.m_State.nDelayedJumpAddr = MIPS_INVALID_PC;
+	}
+	else
+	{
+		m_context.m_State.nPC = range.end + 4;
+	}
+
+	assert(m_context.m_State.nGPR[0].nV0 == 0);
+	assert((m_context.m_State.nPC & 3) == 0);
+
+	return range.instructionCount;
+}
+
+std::string CSuperBlock::GetName() const
+{
+	return string_format("SuperBlock_0x%0.8X_0x%0.8X_%d", m_ranges.front().begin, m_ranges.back().end, static_cast<int>(m_ranges.size()));
+}
+
+void CSuperBlock::CompileRange(CMipsJitter* jitter)
+{
+	for(uint32 rangeIndex = 0; rangeIndex < m_ranges.size(); rangeIndex++)
+	{
+		const auto& range = m_ranges[rangeIndex];
+
+		jitter->PushCst(rangeIndex);
+		jitter->PullRel(offsetof(CMIPS, m_superBlockExitIndex));
+
+		for(uint32 address = range.begin; address <= range.end; address += 4)
+		{
+			m_context.m_pArch->CompileInstruction(
+				address,
+				jitter,
+				&m_context);
+			//Sanity check
+			assert(jitter->IsStackEmpty());
+		}
+
+		if(rangeIndex == (m_ranges.size() - 1)) break;
+
+		//Exceptions need to be handled by the executor
+		jitter->PushRel(offsetof(CMIPS, m_State.nHasException));
+		jitter->PushCst(0);
+		jitter->BeginIf(Jitter::CONDITION_NE);
+		{
+			jitter->Goto(jitter->GetFinalBlockLabel());
+		}
+		jitter->EndIf();
+
+		//Code we've just run might have overwritten the next blocks
+		jitter->PushRel(offsetof(CMIPS, m_superBlockInvalidated));
+		jitter->PushCst(0);
+		jitter->BeginIf(Jitter::CONDITION_NE);
+		{
+			jitter->Goto(jitter->GetFinalBlockLabel());
+		}
+		jitter->EndIf();
+
+		//Leave if we're not going to the next block of the chain, Execute will figure out the next PC
+		const auto& link = m_links[rangeIndex];
+		if(link.slot == LINK_SLOT_NEXT)
+		{
+			jitter->PushRel(offsetof(CMIPS, m_State.nDelayedJumpAddr));
+			jitter->PushCst(MIPS_INVALID_PC);
+			jitter->BeginIf(Jitter::CONDITION_NE);
+			{
+				jitter->Goto(jitter->GetFinalBlockLabel());
+			}
+			jitter->EndIf();
+		}
+		else
+		{
+			jitter->PushRel(offsetof(CMIPS, m_State.nDelayedJumpAddr));
+			jitter->PushCst(link.address);
+			jitter->BeginIf(Jitter::CONDITION_NE);
+			{
+				jitter->Goto(jitter->GetFinalBlockLabel());
+			}
+			jitter->EndIf();
+
+			jitter->PushCst(MIPS_INVALID_PC);
+			jitter->PullRel(offsetof(CMIPS, m_State.nDelayedJumpAddr));
+		}
+	}
+}
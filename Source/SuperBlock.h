@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include "BasicBlock.h"
+
+//Chain of blocks that usually execute one after the other, compiled as a single function.
+//Execution leaves the superblock as soon as it doesn't go where the chain expects it to.
+class CSuperBlock : public CBasicBlock
+{
+public:
+	typedef std::vector<CBasicBlock*> BlockArray;
+
+	//Link followed to go from one block of the chain to the next one
+	struct LINK
+	{
+		LINK_SLOT		slot;
+		uint32			address;
+	};
+	typedef std::vector<LINK> LinkArray;
+
+					CSuperBlock(CMIPS&, const BlockArray&, const LinkArray&);
+	virtual			~CSuperBlock();
+
+	unsigned int	Execute() override;
+	std::string		GetName() const override;
+
+protected:
+	void			CompileRange(CMipsJitter*) override;
+
+private:
+	struct RANGE
+	{
+		uint32			begin;
+		uint32			end;
+		unsigned int	instructionCount;	//Instructions executed if leaving after this range
+	};
+	typedef std::vector<RANGE> RangeArray;
+
+	RangeArray		m_ranges;
+	LinkArray		m_links;
+};
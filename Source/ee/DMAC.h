@@ -117,6 +117,7 @@ public:
 	void				ResumeDMA4();
 	void				ResumeDMA8();
 	bool				IsDMA4Started() const;
+	bool				IsTransferActive() const;
 	static bool			IsEndTagId(uint32);
 
 private:
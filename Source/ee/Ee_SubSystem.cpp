@@ -25,7 +25,7 @@ using namespace Ee;
 CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 : m_ram(reinterpret_cast<uint8*>(framework_aligned_alloc(PS2::EE_RAM_SIZE, framework_getpagesize())))
 , m_bios(new uint8[PS2::EE_BIOS_SIZE])
-, m_spr(new uint8[PS2::EE_SPR_SIZE])
+, m_spr(reinterpret_cast<uint8*>(framework_aligned_alloc(PS2::EE_SPR_SIZE, 0x10)))
 , m_fakeIopRam(new uint8[FAKE_IOP_RAM_SIZE])
 , m_vuMem0(reinterpret_cast<uint8*>(framework_aligned_alloc(PS2::VUMEM0SIZE, 0x10)))
 , m_microMem0(new uint8[PS2::MICROMEM0SIZE])
@@ -51,6 +51,7 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 	assert((reinterpret_cast<size_t>(&m_VU1.m_State) & 0x0F) == 0);
 	assert((reinterpret_cast<size_t>(m_vuMem0) & 0x0F) == 0);
 	assert((reinterpret_cast<size_t>(m_vuMem1) & 0x0F) == 0);
+	assert((reinterpret_cast<size_t>(m_spr) & 0x0F) == 0);
 
 	m_vpu0 = std::make_shared<CVpu>(0, CVpu::VPUINIT(m_microMem0, m_vuMem0, &m_VU0), m_gif, m_ram, m_spr);
 	m_vpu1 = std::make_shared<CVpu>(1, CVpu::VPUINIT(m_microMem1, m_vuMem1, &m_VU1), m_gif, m_ram, m_spr);
@@ -89,6 +90,13 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 		m_EE.m_pCOP[2]			= &m_COP_VU;
 
 		m_EE.m_pAddrTranslator	= CPS2OS::TranslateAddress;
+
+		//Generated code accesses RAM and scratchpad directly, this matches what CPS2OS::TranslateAddress does
+		m_EE.m_fastMemRam					= m_ram;
+		m_EE.m_fastMemRamSize				= PS2::EE_RAM_SIZE;
+		m_EE.m_fastMemScratchpad			= m_spr;
+		m_EE.m_fastMemScratchpadAddress		= 0x70000000;
+		m_EE.m_fastMemScratchpadSize		= PS2::EE_SPR_SIZE;
 	}
 
 	//Vector Unit 0 context setup
@@ -148,7 +156,7 @@ CSubSystem::~CSubSystem()
 	delete m_os;
 	framework_aligned_free(m_ram);
 	delete [] m_bios;
-	delete [] m_spr;
+	framework_aligned_free(m_spr);
 	delete [] m_fakeIopRam;
 	framework_aligned_free(m_vuMem0);
 	delete [] m_microMem0;
@@ -284,13 +292,22 @@ bool CSubSystem::IsCpuIdle() const
 	{
 		return true;
 	}
-	else if(m_os->IsIdle() || m_isIdle)
+	else if(m_os->IsIdle() || m_isIdle || m_executor.IsWaitingForCompilation())
 	{
 		return true;
 	}
 	return false;
 }
 
+uint32 CSubSystem::GetTicksUntilNextEvent() const
+{
+	//Work in progress needs to be serviced on every slice
+	if(m_vpu0->IsVuRunning() || m_vpu1->IsVuRunning()) return 0;
+	if(m_dmac.IsTransferActive()) return 0;
+	if(m_ipu.WillExecuteCommand()) return 0;
+	return m_timer.GetTicksUntilNextInterrupt();
+}
+
 void CSubSystem::CountTicks(int ticks)
 {
 	if(!m_vpu0->IsVuRunning() || (m_vpu0->IsVuRunning() && !m_vpu0->GetVif().IsWaitingForProgramEnd()))
@@ -351,12 +368,15 @@ void CSubSystem::NotifyVBlankEnd()
 	m_intc.AssertLine(CINTC::INTC_LINE_VBLANK_END);
 }
 
-void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
+void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive, bool includeRam)
 {
 	archive.InsertFile(new CMemoryStateFile(STATE_EE,			&m_EE.m_State,	sizeof(MIPSSTATE)));
 	archive.InsertFile(new CMemoryStateFile(STATE_VU0,			&m_VU0.m_State,	sizeof(MIPSSTATE)));
 	archive.InsertFile(new CMemoryStateFile(STATE_VU1,			&m_VU1.m_State,	sizeof(MIPSSTATE)));
-	archive.InsertFile(new CMemoryStateFile(STATE_RAM,			m_ram,			PS2::EE_RAM_SIZE));
+	if(includeRam)
+	{
+		archive.InsertFile(new CMemoryStateFile(STATE_RAM,		m_ram,			PS2::EE_RAM_SIZE));
+	}
 	archive.InsertFile(new CMemoryStateFile(STATE_SPR,			m_spr,			PS2::EE_SPR_SIZE));
 	archive.InsertFile(new CMemoryStateFile(STATE_VUMEM0,		m_vuMem0,		PS2::VUMEM0SIZE));
 	archive.InsertFile(new CMemoryStateFile(STATE_MICROMEM0,	m_microMem0,	PS2::MICROMEM0SIZE));
@@ -372,12 +392,15 @@ void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 	m_gif.SaveState(archive);
 }
 
-void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
+void CSubSystem::LoadState(Framework::CZipArchiveReader& archive, bool includeRam)
 {
 	archive.BeginReadFile(STATE_EE			)->Read(&m_EE.m_State,	sizeof(MIPSSTATE));
 	archive.BeginReadFile(STATE_VU0			)->Read(&m_VU0.m_State,	sizeof(MIPSSTATE));
 	archive.BeginReadFile(STATE_VU1			)->Read(&m_VU1.m_State,	sizeof(MIPSSTATE));
-	archive.BeginReadFile(STATE_RAM			)->Read(m_ram,			PS2::EE_RAM_SIZE);
+	if(includeRam)
+	{
+		archive.BeginReadFile(STATE_RAM		)->Read(m_ram,			PS2::EE_RAM_SIZE);
+	}
 	archive.BeginReadFile(STATE_SPR			)->Read(m_spr,			PS2::EE_SPR_SIZE);
 	archive.BeginReadFile(STATE_VUMEM0		)->Read(m_vuMem0,		PS2::VUMEM0SIZE);
 	archive.BeginReadFile(STATE_MICROMEM0	)->Read(m_microMem0,	PS2::MICROMEM0SIZE);
@@ -503,7 +526,8 @@ uint32 CSubSystem::IOPortWriteHandler(uint32 nAddress, uint32 nData)
 	}
 	else if(nAddress == 0x1000F180)
 	{
-		//stdout data
+		//stdout data, IOP thread might be using Ioman
+		m_sif.SyncIop();
 		m_iopBios.GetIoman()->Write(Iop::CIoman::FID_STDOUT, 1, &nData);
 	}
 	else if(nAddress >= 0x1000F520 && nAddress <= 0x1000F59C)
@@ -30,12 +30,13 @@ namespace Ee
 		int							ExecuteCpu(int);
 		bool						IsCpuIdle() const;
 		void						CountTicks(int);
+		uint32						GetTicksUntilNextEvent() const;
 
 		void						NotifyVBlankStart();
 		void						NotifyVBlankEnd();
 
-		void						SaveState(Framework::CZipArchiveWriter&);
-		void						LoadState(Framework::CZipArchiveReader&);
+		void						SaveState(Framework::CZipArchiveWriter&, bool = true);
+		void						LoadState(Framework::CZipArchiveReader&, bool = true);
 
 		void						SetVpu0(std::shared_ptr<CVpu>);
 		void						SetVpu1(std::shared_ptr<CVpu>);
@@ -5,6 +5,7 @@
 #include "../Log.h"
 #include "../FrameDump.h"
 #include "../RegisterStateFile.h"
+#include "../SimdDefs.h"
 #include "GIF.h"
 
 #define LOG_NAME ("gif")
@@ -32,7 +33,7 @@ CGIF::CGIF(CGSHandler*& gs, uint8* ram, uint8* spr)
 , m_qtemp(0)
 , m_gifProfilerZone(CProfiler::GetInstance().RegisterZone("GIF"))
 {
-
+	UpdateRegisterDescriptors();
 }
 
 CGIF::~CGIF()
@@ -50,6 +51,7 @@ void CGIF::Reset()
 	m_regList = 0;
 	m_eop = false;
 	m_qtemp = 0;
+	UpdateRegisterDescriptors();
 }
 
 void CGIF::LoadState(Framework::CZipArchiveReader& archive)
@@ -63,6 +65,7 @@ void CGIF::LoadState(Framework::CZipArchiveReader& archive)
 	m_regList     = registerFile.GetRegister64(STATE_REGS_REGLIST);
 	m_eop         = registerFile.GetRegister32(STATE_REGS_EOP) != 0;
 	m_qtemp       = registerFile.GetRegister32(STATE_REGS_QTEMP);
+	UpdateRegisterDescriptors();
 }
 
 void CGIF::SaveState(Framework::CZipArchiveWriter& archive)
@@ -79,47 +82,95 @@ void CGIF::SaveState(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(registerFile);
 }
 
+//Low byte of every component, as laid out in RGBAQ
+static uint32 PackRgba(const uint128& packet)
+{
+#if defined(HAS_SSE2)
+	__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&packet));
+	value = _mm_and_si128(value, _mm_set1_epi32(0xFF));
+	value = _mm_packs_epi32(value, value);
+	value = _mm_packus_epi16(value, value);
+	return _mm_cvtsi128_si32(value);
+#elif defined(HAS_NEON)
+	uint16x4_t halves = vmovn_u32(vld1q_u32(packet.nV));
+	uint8x8_t bytes = vmovn_u16(vcombine_u16(halves, halves));
+	return vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+#else
+	const auto& components = packet.nV;
+	return (components[0] & 0xFF) | ((components[1] & 0xFF) << 8) | ((components[2] & 0xFF) << 16) | ((components[3] & 0xFF) << 24);
+#endif
+}
+
+//Low halves of X and Y followed by Z, as laid out in XYZ2/XYZ3
+static uint64 PackXyz(const uint128& packet)
+{
+#if defined(HAS_SSE2)
+	__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&packet));
+	__m128i xy = _mm_shufflelo_epi16(value, _MM_SHUFFLE(3, 3, 2, 0));
+	__m128i z = _mm_shuffle_epi32(value, _MM_SHUFFLE(3, 3, 3, 2));
+	uint64 result = 0;
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(&result), _mm_unpacklo_epi32(xy, z));
+	return result;
+#elif defined(HAS_NEON)
+	uint32x4_t value = vld1q_u32(packet.nV);
+	uint32 xy = vget_lane_u32(vreinterpret_u32_u16(vmovn_u32(value)), 0);
+	return static_cast<uint64>(xy) | (static_cast<uint64>(vgetq_lane_u32(value, 2)) << 32);
+#else
+	const auto& components = packet.nV;
+	return (components[0] & 0xFFFF) | ((components[1] & 0xFFFF) << 16) | (static_cast<uint64>(components[2]) << 32);
+#endif
+}
+
 uint32 CGIF::ProcessPacked(CGSHandler::RegisterWriteList& writeList, uint8* memory, uint32 address, uint32 end)
 {
 	uint32 start = address;
 
-	while((m_loops != 0) && (address < end))
+	if(m_loops == 0)
 	{
-		while((m_regsTemp != 0) && (address < end))
+		return 0;
+	}
+
+	//Every qword produces at most one register write, size the list for all of them at once
+	uint32 qwordCount = std::min<uint32>((end - address + 0x0F) / 0x10, ((m_loops - 1) * m_regs) + m_regsTemp);
+	size_t writeIndex = writeList.size();
+	writeList.resize(writeIndex + qwordCount);
+	auto writes = writeList.data() + writeIndex;
+
+	while(qwordCount != 0)
+	{
+		uint32 regIndex = m_regs - m_regsTemp;
+		uint32 regCount = std::min<uint32>(m_regsTemp, qwordCount);
+
+		for(uint32 i = 0; i < regCount; i++)
 		{
 			uint64 temp = 0;
-			uint32 regDesc = (uint32)((m_regList >> ((m_regs - m_regsTemp) * 4)) & 0x0F);
+			uint32 regDesc = m_regDescs[regIndex + i];
 
 			uint128 packet = *(uint128*)&memory[address];
 			address += 0x10;
 
-			m_regsTemp--;
-
 			switch(regDesc)
 			{
 			case 0x00:
 				//PRIM
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_PRIM, packet.nV0));
+				(*writes++) = CGSHandler::RegisterWrite(GS_REG_PRIM, packet.nV0);
 				break;
 			case 0x01:
 				//RGBA
-				temp  = (packet.nV[0] & 0xFF);
-				temp |= (packet.nV[1] & 0xFF) << 8;
-				temp |= (packet.nV[2] & 0xFF) << 16;
-				temp |= (packet.nV[3] & 0xFF) << 24;
+				temp  = PackRgba(packet);
 				temp |= ((uint64)m_qtemp << 32);
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_RGBAQ, temp));
+				(*writes++) = CGSHandler::RegisterWrite(GS_REG_RGBAQ, temp);
 				break;
 			case 0x02:
 				//ST
 				m_qtemp = packet.nV2;
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_ST, packet.nD0));
+				(*writes++) = CGSHandler::RegisterWrite(GS_REG_ST, packet.nD0);
 				break;
 			case 0x03:
 				//UV
 				temp  = (packet.nV[0] & 0x7FFF);
 				temp |= (packet.nV[1] & 0x7FFF) << 16;
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_UV, temp));
+				(*writes++) = CGSHandler::RegisterWrite(GS_REG_UV, temp);
 				break;
 			case 0x04:
 				//XYZF2
@@ -129,50 +180,48 @@ uint32 CGIF::ProcessPacked(CGSHandler::RegisterWriteList& writeList, uint8* memo
 				temp |= (uint64)(packet.nV[3] & 0x00000FF0) << 52;
 				if(packet.nV[3] & 0x8000)
 				{
-					writeList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZF3, temp));
+					(*writes++) = CGSHandler::RegisterWrite(GS_REG_XYZF3, temp);
 				}
 				else
 				{
-					writeList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZF2, temp));
+					(*writes++) = CGSHandler::RegisterWrite(GS_REG_XYZF2, temp);
 				}
 				break;
 			case 0x05:
 				//XYZ2
-				temp  = (packet.nV[0] & 0xFFFF);
-				temp |= (packet.nV[1] & 0xFFFF) << 16;
-				temp |= (uint64)(packet.nV[2] & 0xFFFFFFFF) << 32;
+				temp = PackXyz(packet);
 				if(packet.nV[3] & 0x8000)
 				{
-					writeList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZ3, temp));
+					(*writes++) = CGSHandler::RegisterWrite(GS_REG_XYZ3, temp);
 				}
 				else
 				{
-					writeList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZ2, temp));
+					(*writes++) = CGSHandler::RegisterWrite(GS_REG_XYZ2, temp);
 				}
 				break;
 			case 0x06:
 				//TEX0_1
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_TEX0_1, packet.nD0));
+				(*writes++) = CGSHandler::RegisterWrite(GS_REG_TEX0_1, packet.nD0);
 				break;
 			case 0x07:
 				//TEX0_2
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_TEX0_2, packet.nD0));
+				(*writes++) = CGSHandler::RegisterWrite(GS_REG_TEX0_2, packet.nD0);
 				break;
 			case 0x08:
 				//CLAMP_1
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_CLAMP_1, packet.nD0));
+				(*writes++) = CGSHandler::RegisterWrite(GS_REG_CLAMP_1, packet.nD0);
 				break;
 			case 0x0A:
 				//FOG
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_FOG, (packet.nD1 >> 36) << 56));
+				(*writes++) = CGSHandler::RegisterWrite(GS_REG_FOG, (packet.nD1 >> 36) << 56);
 				break;
 			case 0x0D:
 				//XYZ3
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZ3, packet.nD0));
+				(*writes++) = CGSHandler::RegisterWrite(GS_REG_XYZ3, packet.nD0);
 				break;
 			case 0x0E:
 				//A + D
-				writeList.push_back(CGSHandler::RegisterWrite(static_cast<uint8>(packet.nD1), packet.nD0));
+				(*writes++) = CGSHandler::RegisterWrite(static_cast<uint8>(packet.nD1), packet.nD0);
 				break;
 			case 0x0F:
 				//NOP
@@ -183,14 +232,18 @@ uint32 CGIF::ProcessPacked(CGSHandler::RegisterWriteList& writeList, uint8* memo
 			}
 		}
 
+		m_regsTemp -= regCount;
+		qwordCount -= regCount;
+
 		if(m_regsTemp == 0)
 		{
 			m_loops--;
 			m_regsTemp = m_regs;
 		}
-
 	}
 
+	writeList.resize(writes - writeList.data());
+
 	return address - start;
 }
 
@@ -248,6 +301,14 @@ uint32 CGIF::ProcessImage(uint8* memory, uint32 address, uint32 end)
 	return (totalLoops * 0x10);
 }
 
+void CGIF::UpdateRegisterDescriptors()
+{
+	for(unsigned int i = 0; i < 0x10; i++)
+	{
+		m_regDescs[i] = static_cast<uint8>((m_regList >> (i * 4)) & 0x0F);
+	}
+}
+
 uint32 CGIF::ProcessPacket(uint8* memory, uint32 address, uint32 end, const CGsPacketMetadata& packetMetadata)
 {
 	static CGSHandler::RegisterWriteList writeList;
@@ -307,6 +368,7 @@ uint32 CGIF::ProcessPacket(uint8* memory, uint32 address, uint32 end, const CGsP
 
 			if(m_regs == 0) m_regs = 0x10;
 			m_regsTemp = m_regs;
+			UpdateRegisterDescriptors();
 			continue;
 		}
 		switch(m_cmd)
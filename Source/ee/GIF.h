@@ -62,6 +62,8 @@ private:
 	uint32			ProcessRegList(CGSHandler::RegisterWriteList&, uint8*, uint32, uint32);
 	uint32			ProcessImage(uint8*, uint32, uint32);
 
+	void			UpdateRegisterDescriptors();
+
 	void			DisassembleGet(uint32);
 	void			DisassembleSet(uint32, uint32);
 
@@ -72,6 +74,7 @@ private:
 	uint8			m_regs;
 	uint8			m_regsTemp;
 	uint64			m_regList;
+	uint8			m_regDescs[0x10];
 	bool			m_eop;
 	uint32			m_qtemp;
 	uint8*			m_ram;
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <exception>
 #include <functional>
+#include <algorithm>
 #include "IPU.h"
 #include "IPU_MacroblockAddressIncrementTable.h"
 #include "IPU_MacroblockTypeITable.h"
@@ -15,8 +16,8 @@
 #include "mpeg2/CodedBlockPatternTable.h"
 #include "mpeg2/QuantiserScaleTable.h"
 #include "mpeg2/InverseScanTable.h"
-#include "idct/TrivialC.h"
-#include "idct/IEEE1180.h"
+#include "IPU_FastIdct.h"
+#include "IPU_Int32x4.h"
 #include "../Log.h"
 #include "DMAC.h"
 
@@ -1190,7 +1191,7 @@ bool CIPU::CBDECCommand::Execute()
 
 				memcpy(blockTemp, blockInfo.block, sizeof(int16) * 0x40);
 
-				IDCT::CIEEE1180::GetInstance()->Transform(blockTemp, blockInfo.block);
+				CFastIdct::Transform(blockTemp, blockInfo.block);
 
 				m_state = STATE_DECODEBLOCK_GOTONEXT;
 			}
@@ -1706,11 +1707,6 @@ bool CIPU::CSETVQCommand::Execute()
 //CSC command implementation
 /////////////////////////////////////////////
 
-CIPU::CCSCCommand::CCSCCommand()
-{
-	GenerateCbCrMap();
-}
-
 void CIPU::CCSCCommand::Initialize(CINFIFO* input, COUTFIFO* output, uint32 commandCode, uint16 TH0, uint16 TH1)
 {
 	m_command <<= commandCode;
@@ -1766,62 +1762,47 @@ bool CIPU::CCSCCommand::Execute()
 			break;
 		case STATE_CONVERTBLOCK:
 			{
-				uint32 nPixel[0x100];
-
-				uint8* pY = m_block;
-				uint8* nBlockCb = m_block + 0x100;
-				uint8* nBlockCr = m_block + 0x140;
-
-				uint32* pPixel = nPixel;
-				unsigned int* pCbCrMap = m_nCbCrMap;
-				
-				uint32 alphaTh0 = (m_TH0 & 0xFF) | ((m_TH0 & 0xFF) << 8) | ((m_TH0 & 0xFF) << 16);
-				uint32 alphaTh1 = (m_TH1 & 0xFF) | ((m_TH1 & 0xFF) << 8) | ((m_TH1 & 0xFF) << 16);
+				uint8 blockR[0x100];
+				uint8 blockG[0x100];
+				uint8 blockB[0x100];
+				ConvertColorSpace(blockR, blockG, blockB);
 
-				for(unsigned int i = 0; i < 16; i++)
+				if(m_command.ofm)
 				{
-					for(unsigned int j = 0; j < 16; j++)
+					//RGB16, 4x4 ordered dither is applied before truncating components to 5 bits
+					static const int32 ditherMatrix[4][4] =
 					{
-						float nY  = pY[j];
-						float nCb = nBlockCb[pCbCrMap[j]];
-						float nCr = nBlockCr[pCbCrMap[j]];
-
-						//nY = nBlockCb[pCbCrMap[j]];
-						//nCb = 128;
-						//nCr = 128;
-
-						float nR = nY								+ 1.402f	* (nCr - 128);
-						float nG = nY - 0.34414f	* (nCb - 128)	- 0.71414f	* (nCr - 128);
-						float nB = nY + 1.772f		* (nCb - 128);
-
-						if(nR < 0) { nR = 0; } if(nR > 255) { nR = 255; }
-						if(nG < 0) { nG = 0; } if(nG > 255) { nG = 255; }
-						if(nB < 0) { nB = 0; } if(nB > 255) { nB = 255; }
-
-						uint8 a = 0;
-						uint32 rgb = (static_cast<uint8>(nB) << 16) | (static_cast<uint8>(nG) << 8) | (static_cast<uint8>(nR) << 0);
-						if(rgb < alphaTh0)
-						{
-							a = 0;
-						}
-						else if(rgb < alphaTh1)
-						{
-							a = 0x40;
-						}
-						else
-						{
-							a = 0x80;
-						}
-
-						pPixel[j] = (a << 24) | rgb;
+						{ -4,  0, -3,  1 },
+						{  2, -2,  3, -1 },
+						{ -3,  1, -4,  0 },
+						{  3, -1,  2, -2 },
+					};
+
+					uint16 pixels[0x100];
+					for(unsigned int i = 0; i < 0x100; i++)
+					{
+						int32 dither = m_command.dte ? ditherMatrix[(i / 0x10) & 3][i & 3] : 0;
+						uint32 r = std::min<int32>(std::max<int32>(blockR[i] + dither, 0), 255) >> 3;
+						uint32 g = std::min<int32>(std::max<int32>(blockG[i] + dither, 0), 255) >> 3;
+						uint32 b = std::min<int32>(std::max<int32>(blockB[i] + dither, 0), 255) >> 3;
+						//Alpha bit is set on pixels that would be translucent in RGB32
+						uint32 a = (GetAlpha(blockR[i], blockG[i], blockB[i]) == 0x40) ? 1 : 0;
+						pixels[i] = static_cast<uint16>((a << 15) | (b << 10) | (g << 5) | r);
 					}
 
-					pY			+= 0x10;
-					pCbCrMap	+= 0x10;
-					pPixel		+= 0x10;
+					m_OUT_FIFO->Write(pixels, sizeof(pixels));
 				}
+				else
+				{
+					uint32 pixels[0x100];
+					for(unsigned int i = 0; i < 0x100; i++)
+					{
+						uint32 rgb = (blockB[i] << 16) | (blockG[i] << 8) | (blockR[i] << 0);
+						pixels[i] = (GetAlpha(blockR[i], blockG[i], blockB[i]) << 24) | rgb;
+					}
 
-				m_OUT_FIFO->Write(nPixel, sizeof(uint32) * 0x100);
+					m_OUT_FIFO->Write(pixels, sizeof(pixels));
+				}
 
 				m_mbCount--;
 				m_state = STATE_FLUSHBLOCK;
@@ -1844,21 +1825,59 @@ bool CIPU::CCSCCommand::Execute()
 	}
 }
 
-void CIPU::CCSCCommand::GenerateCbCrMap()
+template <typename LaneType>
+static void ConvertColorSpaceRow(const uint8* rowY, const uint8* rowCb, const uint8* rowCr, uint8* rowR, uint8* rowG, uint8* rowB)
 {
-	unsigned int* pCbCrMap = m_nCbCrMap;
-	for(unsigned int i = 0; i < 0x40; i += 0x8)
+	const unsigned int laneCount = sizeof(LaneType) / sizeof(int32);
+	for(unsigned int j = 0; j < 16; j += laneCount)
 	{
-		for(unsigned int j = 0; j < 0x10; j += 2)
-		{
-			pCbCrMap[j + 0x00] = (j / 2) + i;
-			pCbCrMap[j + 0x01] = (j / 2) + i;
+		LaneType y, cb, cr;
+		LoadLanes(y, rowY + j);
+		LoadPairedLanes(cb, rowCb, j);
+		LoadPairedLanes(cr, rowCr, j);
+		y = y << 16;
+		cb = cb - 128;
+		cr = cr - 128;
+
+		StoreClampedLanes(rowR + j, (y + (91881 * cr)) >> 16);
+		StoreClampedLanes(rowG + j, (y - (22554 * cb) - (46802 * cr)) >> 16);
+		StoreClampedLanes(rowB + j, (y + (116130 * cb)) >> 16);
+	}
+}
 
-			pCbCrMap[j + 0x10] = (j / 2) + i;
-			pCbCrMap[j + 0x11] = (j / 2) + i;
-		}
+void CIPU::CCSCCommand::ConvertColorSpace(uint8* blockR, uint8* blockG, uint8* blockB) const
+{
+	//16.16 fixed point YCbCr to RGB conversion, each chroma sample
+	//is shared by the 2x2 luma samples it covers (4:2:0)
+	const uint8* blockY = m_block;
+	const uint8* blockCb = m_block + 0x100;
+	const uint8* blockCr = m_block + 0x140;
 
-		pCbCrMap += 0x20;
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		unsigned int rowOffset = i * 0x10;
+		unsigned int chromaRowOffset = (i / 2) * 8;
+		ConvertColorSpaceRow<INT32LANES>(blockY + rowOffset, blockCb + chromaRowOffset, blockCr + chromaRowOffset,
+			blockR + rowOffset, blockG + rowOffset, blockB + rowOffset);
+	}
+}
+
+uint32 CIPU::CCSCCommand::GetAlpha(uint8 r, uint8 g, uint8 b) const
+{
+	uint32 alphaTh0 = (m_TH0 & 0xFF) | ((m_TH0 & 0xFF) << 8) | ((m_TH0 & 0xFF) << 16);
+	uint32 alphaTh1 = (m_TH1 & 0xFF) | ((m_TH1 & 0xFF) << 8) | ((m_TH1 & 0xFF) << 16);
+	uint32 rgb = (b << 16) | (g << 8) | (r << 0);
+	if(rgb < alphaTh0)
+	{
+		return 0;
+	}
+	else if(rgb < alphaTh1)
+	{
+		return 0x40;
+	}
+	else
+	{
+		return 0x80;
 	}
 }
 
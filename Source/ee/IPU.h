@@ -438,8 +438,6 @@ private:
 	class CCSCCommand : public CCommand
 	{
 	public:
-						CCSCCommand();
-
 		void			Initialize(CINFIFO*, COUTFIFO*, uint32, uint16, uint16);
 		bool			Execute() override;
 
@@ -458,7 +456,8 @@ private:
 			BLOCK_SIZE = 0x180,
 		};
 
-		void			GenerateCbCrMap();
+		void			ConvertColorSpace(uint8*, uint8*, uint8*) const;
+		uint32			GetAlpha(uint8, uint8, uint8) const;
 
 		STATE			m_state = STATE_DONE;
 		CMD_CSC			m_command = make_convertible<CMD_CSC>(0);
@@ -471,8 +470,6 @@ private:
 		unsigned int	m_currentIndex = 0;
 		unsigned int	m_mbCount = 0;
 
-		unsigned int	m_nCbCrMap[0x100];
-
 		uint8			m_block[BLOCK_SIZE];
 	};
 
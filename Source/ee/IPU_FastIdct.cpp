@@ -0,0 +1,166 @@
+#include <algorithm>
+#include "IPU_FastIdct.h"
+#include "IPU_Int32x4.h"
+
+using namespace IPU;
+
+//2048 * sqrt(2) * cos(n * pi / 16)
+#define W1 (2841)
+#define W2 (2676)
+#define W3 (2408)
+#define W5 (1609)
+#define W6 (1108)
+#define W7 (565)
+
+template <typename SrcType, typename DstType>
+static void Transpose(const SrcType* src, DstType* dst)
+{
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		for(unsigned int j = 0; j < 8; j++)
+		{
+			dst[j * 8 + i] = src[i * 8 + j];
+		}
+	}
+}
+
+void CFastIdct::Transform(const int16* input, int16* output)
+{
+	bool hasAcCoefficients = false;
+	for(unsigned int i = 1; i < 0x40; i++)
+	{
+		hasAcCoefficients |= (input[i] != 0);
+	}
+
+	if(!hasAcCoefficients)
+	{
+		//Flat block, same result as going through both passes
+		int16 value = static_cast<int16>(std::min<int32>(std::max<int32>((input[0] + 4) >> 3, -256), 255));
+		std::fill(output, output + 0x40, value);
+		return;
+	}
+
+	int16 transposedInput[0x40];
+	int32 rows[0x40];
+	int32 transposedRows[0x40];
+
+	Transpose(input, transposedInput);
+	TransformRows<INT32LANES>(transposedInput, transposedRows);
+	Transpose(transposedRows, rows);
+	TransformColumns<INT32LANES>(rows, output);
+}
+
+template <typename LaneType>
+void CFastIdct::TransformRows(const int16* input, int32* output)
+{
+	//Input and output are transposed, element 'n' of row 'i' is at (n * 8 + i)
+	const unsigned int laneCount = sizeof(LaneType) / sizeof(int32);
+	for(unsigned int i = 0; i < 8; i += laneCount)
+	{
+		LaneType x0, x1, x2, x3, x4, x5, x6, x7, x8;
+		LoadLanes(x0, input + 0 * 8 + i);
+		LoadLanes(x1, input + 4 * 8 + i);
+		LoadLanes(x2, input + 6 * 8 + i);
+		LoadLanes(x3, input + 2 * 8 + i);
+		LoadLanes(x4, input + 1 * 8 + i);
+		LoadLanes(x5, input + 7 * 8 + i);
+		LoadLanes(x6, input + 5 * 8 + i);
+		LoadLanes(x7, input + 3 * 8 + i);
+		x0 = (x0 << 11) + 128;
+		x1 = x1 << 11;
+
+		//First stage
+		x8 = W7 * (x4 + x5);
+		x4 = x8 + (W1 - W7) * x4;
+		x5 = x8 - (W1 + W7) * x5;
+		x8 = W3 * (x6 + x7);
+		x6 = x8 - (W3 - W5) * x6;
+		x7 = x8 - (W3 + W5) * x7;
+
+		//Second stage
+		x8 = x0 + x1;
+		x0 -= x1;
+		x1 = W6 * (x3 + x2);
+		x2 = x1 - (W2 + W6) * x2;
+		x3 = x1 + (W2 - W6) * x3;
+		x1 = x4 + x6;
+		x4 -= x6;
+		x6 = x5 + x7;
+		x5 -= x7;
+
+		//Third stage
+		x7 = x8 + x3;
+		x8 -= x3;
+		x3 = x0 + x2;
+		x0 -= x2;
+		x2 = (181 * (x4 + x5) + 128) >> 8;
+		x4 = (181 * (x4 - x5) + 128) >> 8;
+
+		//Fourth stage
+		StoreLanes(output + 0 * 8 + i, (x7 + x1) >> 8);
+		StoreLanes(output + 1 * 8 + i, (x3 + x2) >> 8);
+		StoreLanes(output + 2 * 8 + i, (x0 + x4) >> 8);
+		StoreLanes(output + 3 * 8 + i, (x8 + x6) >> 8);
+		StoreLanes(output + 4 * 8 + i, (x8 - x6) >> 8);
+		StoreLanes(output + 5 * 8 + i, (x0 - x4) >> 8);
+		StoreLanes(output + 6 * 8 + i, (x3 - x2) >> 8);
+		StoreLanes(output + 7 * 8 + i, (x7 - x1) >> 8);
+	}
+}
+
+template <typename LaneType>
+void CFastIdct::TransformColumns(const int32* input, int16* output)
+{
+	const unsigned int laneCount = sizeof(LaneType) / sizeof(int32);
+	for(unsigned int i = 0; i < 8; i += laneCount)
+	{
+		LaneType x0, x1, x2, x3, x4, x5, x6, x7, x8;
+		LoadLanes(x0, input + 0 * 8 + i);
+		LoadLanes(x1, input + 4 * 8 + i);
+		LoadLanes(x2, input + 6 * 8 + i);
+		LoadLanes(x3, input + 2 * 8 + i);
+		LoadLanes(x4, input + 1 * 8 + i);
+		LoadLanes(x5, input + 7 * 8 + i);
+		LoadLanes(x6, input + 5 * 8 + i);
+		LoadLanes(x7, input + 3 * 8 + i);
+		x0 = (x0 << 8) + 8192;
+		x1 = x1 << 8;
+
+		//First stage
+		x8 = W7 * (x4 + x5) + 4;
+		x4 = (x8 + (W1 - W7) * x4) >> 3;
+		x5 = (x8 - (W1 + W7) * x5) >> 3;
+		x8 = W3 * (x6 + x7) + 4;
+		x6 = (x8 - (W3 - W5) * x6) >> 3;
+		x7 = (x8 - (W3 + W5) * x7) >> 3;
+
+		//Second stage
+		x8 = x0 + x1;
+		x0 -= x1;
+		x1 = W6 * (x3 + x2) + 4;
+		x2 = (x1 - (W2 + W6) * x2) >> 3;
+		x3 = (x1 + (W2 - W6) * x3) >> 3;
+		x1 = x4 + x6;
+		x4 -= x6;
+		x6 = x5 + x7;
+		x5 -= x7;
+
+		//Third stage
+		x7 = x8 + x3;
+		x8 -= x3;
+		x3 = x0 + x2;
+		x0 -= x2;
+		x2 = (181 * (x4 + x5) + 128) >> 8;
+		x4 = (181 * (x4 - x5) + 128) >> 8;
+
+		//Fourth stage
+		StoreClampedLanes(output + 0 * 8 + i, (x7 + x1) >> 14);
+		StoreClampedLanes(output + 1 * 8 + i, (x3 + x2) >> 14);
+		StoreClampedLanes(output + 2 * 8 + i, (x0 + x4) >> 14);
+		StoreClampedLanes(output + 3 * 8 + i, (x8 + x6) >> 14);
+		StoreClampedLanes(output + 4 * 8 + i, (x8 - x6) >> 14);
+		StoreClampedLanes(output + 5 * 8 + i, (x0 - x4) >> 14);
+		StoreClampedLanes(output + 6 * 8 + i, (x3 - x2) >> 14);
+		StoreClampedLanes(output + 7 * 8 + i, (x7 - x1) >> 14);
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Types.h"
+
+namespace IPU
+{
+	//Fixed point separable IDCT (Chen-Wang), meets the IEEE 1180 accuracy requirements.
+	//Each pass works on all 8 rows (or columns) at once, 4 of them at a time when the target has vector instructions.
+	class CFastIdct
+	{
+	public:
+		static void		Transform(const int16*, int16*);
+
+	private:
+		template <typename LaneType>
+		static void		TransformRows(const int16*, int32*);
+		template <typename LaneType>
+		static void		TransformColumns(const int32*, int16*);
+	};
+}
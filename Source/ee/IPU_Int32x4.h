@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include "Types.h"
+#include "../SimdDefs.h"
+
+namespace IPU
+{
+	//Fixed point code in the IPU is written once for a lane type, either a plain int32
+	//or INT32X4 when the target has vector instructions. Both support the same operations.
+
+	inline void LoadLanes(int32& lanes, const int16* src)
+	{
+		lanes = src[0];
+	}
+
+	inline void LoadLanes(int32& lanes, const int32* src)
+	{
+		lanes = src[0];
+	}
+
+	inline void LoadLanes(int32& lanes, const uint8* src)
+	{
+		lanes = src[0];
+	}
+
+	//Every source byte is used by two consecutive lanes (ie.: subsampled chroma)
+	inline void LoadPairedLanes(int32& lanes, const uint8* src, unsigned int index)
+	{
+		lanes = src[index / 2];
+	}
+
+	inline void StoreLanes(int32* dst, int32 lanes)
+	{
+		dst[0] = lanes;
+	}
+
+	inline void StoreClampedLanes(int16* dst, int32 lanes)
+	{
+		dst[0] = static_cast<int16>(std::min<int32>(std::max<int32>(lanes, -256), 255));
+	}
+
+	inline void StoreClampedLanes(uint8* dst, int32 lanes)
+	{
+		dst[0] = static_cast<uint8>(std::min<int32>(std::max<int32>(lanes, 0), 255));
+	}
+
+#if defined(HAS_SSE2) || defined(HAS_NEON)
+
+	struct INT32X4
+	{
+#if defined(HAS_SSE2)
+		__m128i value;
+#else
+		int32x4_t value;
+#endif
+	};
+
+	typedef INT32X4 INT32LANES;
+
+#if defined(HAS_SSE2)
+
+	inline INT32X4 MakeLanes(int32 value)
+	{
+		return INT32X4 { _mm_set1_epi32(value) };
+	}
+
+	inline INT32X4 operator +(const INT32X4& lhs, const INT32X4& rhs)
+	{
+		return INT32X4 { _mm_add_epi32(lhs.value, rhs.value) };
+	}
+
+	inline INT32X4 operator -(const INT32X4& lhs, const INT32X4& rhs)
+	{
+		return INT32X4 { _mm_sub_epi32(lhs.value, rhs.value) };
+	}
+
+	//SSE2 has no 32-bit multiply that keeps the low half, compute even and odd lanes separately
+	inline INT32X4 operator *(int32 lhs, const INT32X4& rhs)
+	{
+		__m128i factor = _mm_set1_epi32(lhs);
+		__m128i even = _mm_mul_epu32(rhs.value, factor);
+		__m128i odd = _mm_mul_epu32(_mm_srli_epi64(rhs.value, 32), factor);
+		even = _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0));
+		odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0));
+		return INT32X4 { _mm_unpacklo_epi32(even, odd) };
+	}
+
+	inline INT32X4 operator <<(const INT32X4& lhs, int shift)
+	{
+		return INT32X4 { _mm_sll_epi32(lhs.value, _mm_cvtsi32_si128(shift)) };
+	}
+
+	inline INT32X4 operator >>(const INT32X4& lhs, int shift)
+	{
+		return INT32X4 { _mm_sra_epi32(lhs.value, _mm_cvtsi32_si128(shift)) };
+	}
+
+	inline void LoadLanes(INT32X4& lanes, const int16* src)
+	{
+		__m128i value = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+		lanes.value = _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+	}
+
+	inline void LoadLanes(INT32X4& lanes, const int32* src)
+	{
+		lanes.value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+	}
+
+	inline void LoadLanes(INT32X4& lanes, const uint8* src)
+	{
+		int32 bytes = 0;
+		memcpy(&bytes, src, 4);
+		__m128i zero = _mm_setzero_si128();
+		lanes.value = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+	}
+
+	inline void LoadPairedLanes(INT32X4& lanes, const uint8* src, unsigned int index)
+	{
+		uint16 bytes = 0;
+		memcpy(&bytes, src + (index / 2), 2);
+		__m128i zero = _mm_setzero_si128();
+		__m128i value = _mm_cvtsi32_si128(bytes);
+		value = _mm_unpacklo_epi8(value, value);
+		lanes.value = _mm_unpacklo_epi16(_mm_unpacklo_epi8(value, zero), zero);
+	}
+
+	inline void StoreLanes(int32* dst, const INT32X4& lanes)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), lanes.value);
+	}
+
+	inline void StoreClampedLanes(int16* dst, const INT32X4& lanes)
+	{
+		__m128i value = _mm_packs_epi32(lanes.value, lanes.value);
+		value = _mm_min_epi16(_mm_max_epi16(value, _mm_set1_epi16(-256)), _mm_set1_epi16(255));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst), value);
+	}
+
+	inline void StoreClampedLanes(uint8* dst, const INT32X4& lanes)
+	{
+		__m128i value = _mm_packs_epi32(lanes.value, lanes.value);
+		int32 bytes = _mm_cvtsi128_si32(_mm_packus_epi16(value, value));
+		memcpy(dst, &bytes, 4);
+	}
+
+#else
+
+	inline INT32X4 MakeLanes(int32 value)
+	{
+		return INT32X4 { vdupq_n_s32(value) };
+	}
+
+	inline INT32X4 operator +(const INT32X4& lhs, const INT32X4& rhs)
+	{
+		return INT32X4 { vaddq_s32(lhs.value, rhs.value) };
+	}
+
+	inline INT32X4 operator -(const INT32X4& lhs, const INT32X4& rhs)
+	{
+		return INT32X4 { vsubq_s32(lhs.value, rhs.value) };
+	}
+
+	inline INT32X4 operator *(int32 lhs, const INT32X4& rhs)
+	{
+		return INT32X4 { vmulq_n_s32(rhs.value, lhs) };
+	}
+
+	inline INT32X4 operator <<(const INT32X4& lhs, int shift)
+	{
+		return INT32X4 { vshlq_s32(lhs.value, vdupq_n_s32(shift)) };
+	}
+
+	//Shifting left by a negative amount is an arithmetic shift right
+	inline INT32X4 operator >>(const INT32X4& lhs, int shift)
+	{
+		return INT32X4 { vshlq_s32(lhs.value, vdupq_n_s32(-shift)) };
+	}
+
+	inline void LoadLanes(INT32X4& lanes, const int16* src)
+	{
+		lanes.value = vmovl_s16(vld1_s16(src));
+	}
+
+	inline void LoadLanes(INT32X4& lanes, const int32* src)
+	{
+		lanes.value = vld1q_s32(src);
+	}
+
+	inline void LoadLanes(INT32X4& lanes, const uint8* src)
+	{
+		uint32 bytes = 0;
+		memcpy(&bytes, src, 4);
+		uint16x8_t value = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(bytes)));
+		lanes.value = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(value)));
+	}
+
+	inline void LoadPairedLanes(INT32X4& lanes, const uint8* src, unsigned int index)
+	{
+		const uint8* pair = src + (index / 2);
+		uint32 bytes = pair[0] | (pair[0] << 8) | (pair[1] << 16) | (pair[1] << 24);
+		uint16x8_t value = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(bytes)));
+		lanes.value = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(value)));
+	}
+
+	inline void StoreLanes(int32* dst, const INT32X4& lanes)
+	{
+		vst1q_s32(dst, lanes.value);
+	}
+
+	inline void StoreClampedLanes(int16* dst, const INT32X4& lanes)
+	{
+		int16x4_t value = vqmovn_s32(lanes.value);
+		value = vmin_s16(vmax_s16(value, vdup_n_s16(-256)), vdup_n_s16(255));
+		vst1_s16(dst, value);
+	}
+
+	inline void StoreClampedLanes(uint8* dst, const INT32X4& lanes)
+	{
+		uint16x4_t value = vqmovun_s32(lanes.value);
+		uint8x8_t bytes = vqmovn_u16(vcombine_u16(value, value));
+		uint32 result = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+		memcpy(dst, &result, 4);
+	}
+
+#endif
+
+	inline INT32X4 operator +(const INT32X4& lhs, int32 rhs)
+	{
+		return lhs + MakeLanes(rhs);
+	}
+
+	inline INT32X4 operator -(const INT32X4& lhs, int32 rhs)
+	{
+		return lhs - MakeLanes(rhs);
+	}
+
+	inline INT32X4 operator -(int32 lhs, const INT32X4& rhs)
+	{
+		return MakeLanes(lhs) - rhs;
+	}
+
+	inline INT32X4& operator +=(INT32X4& lhs, const INT32X4& rhs)
+	{
+		lhs = lhs + rhs;
+		return lhs;
+	}
+
+	inline INT32X4& operator -=(INT32X4& lhs, const INT32X4& rhs)
+	{
+		lhs = lhs - rhs;
+		return lhs;
+	}
+
+#else
+
+	typedef int32 INT32LANES;
+
+#endif
+}
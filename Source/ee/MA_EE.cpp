@@ -112,27 +112,43 @@ void CMA_EE::LQ()
 {
 	if(m_nRT == 0) return;
 
-	ComputeMemAccessAddr();
-
-	m_codeGen->PushCtx();
-	m_codeGen->PushIdx(1);
-	m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_GetQuadProxy), 2, Jitter::CJitter::RETURN_VALUE_128);
-	m_codeGen->MD_PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+	EmitMemAccess(0x0F,
+		[&] ()
+		{
+			m_codeGen->MD_LoadFromRef();
+			m_codeGen->MD_PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+		},
+		[&] ()
+		{
+			m_codeGen->PushCtx();
+			m_codeGen->PushIdx(1);
+			m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_GetQuadProxy), 2, Jitter::CJitter::RETURN_VALUE_128);
+			m_codeGen->MD_PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
 
-	m_codeGen->PullTop();
+			m_codeGen->PullTop();
+		}
+	);
 }
 
 //1F
 void CMA_EE::SQ()
 {
-	ComputeMemAccessAddr();
-
-	m_codeGen->PushCtx();
-	m_codeGen->MD_PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
-	m_codeGen->PushIdx(2);
-	m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_SetQuadProxy), 3, Jitter::CJitter::RETURN_VALUE_NONE);
+	EmitMemAccess(0x0F,
+		[&] ()
+		{
+			m_codeGen->MD_PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+			m_codeGen->MD_StoreAtRef();
+		},
+		[&] ()
+		{
+			m_codeGen->PushCtx();
+			m_codeGen->MD_PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+			m_codeGen->PushIdx(2);
+			m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_SetQuadProxy), 3, Jitter::CJitter::RETURN_VALUE_NONE);
 
-	m_codeGen->PullTop();
+			m_codeGen->PullTop();
+		}
+	);
 }
 
 //////////////////////////////////////////////////
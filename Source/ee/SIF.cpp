@@ -122,6 +122,7 @@ void CSIF::DeleteModules()
 
 uint32 CSIF::ReceiveDMA5(uint32 srcAddress, uint32 size, uint32 unused, bool isTagIncluded)
 {
+	SyncIop();
 	if(size > m_dmaBufferSize)
 	{
 		throw std::runtime_error("Packet too big.");
@@ -134,6 +135,9 @@ uint32 CSIF::ReceiveDMA6(uint32 nSrcAddr, uint32 nSize, uint32 nDstAddr, bool is
 {
 	assert(!isTagIncluded);
 
+	//Commands will be handled by IOP modules
+	SyncIop();
+
 	//Humm, this is kinda odd, but it ors the address with 0x20000000
 	nSrcAddr &= (PS2::EE_RAM_SIZE - 1);
 
@@ -224,6 +228,7 @@ void CSIF::ProcessPackets()
 {
 	if(m_packetProcessed && !m_packetQueue.empty())
 	{
+		SyncIop();
 		assert(m_packetQueue.size() > 4);
 		uint32 size = *reinterpret_cast<uint32*>(&m_packetQueue[0]);
 		SendDMA(&m_packetQueue[4], size);
@@ -569,6 +574,20 @@ void CSIF::SetCustomCommandHandler(const CustomCommandHandler& customCommandHand
 	m_customCommandHandler = customCommandHandler;
 }
 
+void CSIF::SetIopSyncHandler(const IopSyncHandler& iopSyncHandler)
+{
+	m_iopSyncHandler = iopSyncHandler;
+}
+
+void CSIF::SyncIop()
+{
+	//Make sure the IOP isn't running while we're touching its state
+	if(m_iopSyncHandler)
+	{
+		m_iopSyncHandler();
+	}
+}
+
 /////////////////////////////////////////////////////////
 //Get/Set Register
 /////////////////////////////////////////////////////////
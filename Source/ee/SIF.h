@@ -15,6 +15,7 @@ class CSIF
 public:
 	typedef std::function<void (const std::string&)> ModuleResetHandler;
 	typedef std::function<void (uint32)> CustomCommandHandler;
+	typedef std::function<void ()> IopSyncHandler;
 
 									CSIF(CDMAC&, uint8*, uint8*);
 	virtual							~CSIF();
@@ -32,6 +33,8 @@ public:
 	void							SendCallReply(uint32, const void*);
 	void							SetModuleResetHandler(const ModuleResetHandler&);
 	void							SetCustomCommandHandler(const CustomCommandHandler&);
+	void							SetIopSyncHandler(const IopSyncHandler&);
+	void							SyncIop();
 
 	uint32							ReceiveDMA5(uint32, uint32, uint32, bool);
 	uint32							ReceiveDMA6(uint32, uint32, uint32, bool);
@@ -107,4 +110,5 @@ private:
 
 	ModuleResetHandler				m_moduleResetHandler;
 	CustomCommandHandler			m_customCommandHandler;
+	IopSyncHandler					m_iopSyncHandler;
 };
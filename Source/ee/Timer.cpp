@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <algorithm>
 #include "../Log.h"
 #include "../RegisterStateFile.h"
 #include "Timer.h"
@@ -34,22 +35,7 @@ void CTimer::Count(unsigned int ticks)
 		uint32 previousCount	= timer->nCOUNT;
 		uint32 nextCount		= timer->nCOUNT;
 
-		uint32 divider = 1;
-		switch(timer->nMODE & 0x03)
-		{
-		case 0x00:
-			divider = 1;
-			break;
-		case 0x01:
-			divider = 16;
-			break;
-		case 0x02:
-			divider = 256;
-			break;
-		case 0x03:
-			divider = 9437;		// PAL
-			break;
-		}
+		uint32 divider = GetClockDivider(timer->nMODE);
 
 		//Compute increment
 		uint32 totalTicks = timer->clockRemain + ticks;
@@ -94,6 +80,54 @@ void CTimer::Count(unsigned int ticks)
 	}
 }
 
+uint32 CTimer::GetTicksUntilNextInterrupt() const
+{
+	uint64 result = ~0U;
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		const TIMER& timer = m_timer[i];
+
+		if(!(timer.nMODE & MODE_COUNT_ENABLE)) continue;
+
+		bool equalInterruptEnabled = (timer.nMODE & (MODE_EQUAL_FLAG >> 2)) != 0;
+		bool overflowInterruptEnabled = (timer.nMODE & (MODE_OVERFLOW_FLAG >> 2)) != 0;
+		if(!equalInterruptEnabled && !overflowInterruptEnabled) continue;
+
+		//Counter will hit the reference value or overflow, whatever comes first
+		uint32 compare = (timer.nCOMP == 0) ? 0x10000 : timer.nCOMP;
+		uint32 target = 0xFFFF;
+		if(equalInterruptEnabled && (timer.nCOUNT < compare))
+		{
+			target = std::min<uint32>(target, compare);
+		}
+		if(timer.nCOUNT >= target)
+		{
+			return 0;
+		}
+
+		uint64 ticks = static_cast<uint64>(target - timer.nCOUNT) * GetClockDivider(timer.nMODE);
+		ticks -= std::min<uint64>(ticks, timer.clockRemain);
+		result = std::min<uint64>(result, ticks);
+	}
+	return static_cast<uint32>(result);
+}
+
+uint32 CTimer::GetClockDivider(uint32 mode)
+{
+	switch(mode & 0x03)
+	{
+	case 0x00:
+	default:
+		return 1;
+	case 0x01:
+		return 16;
+	case 0x02:
+		return 256;
+	case 0x03:
+		return 9437;		// PAL
+	}
+}
+
 uint32 CTimer::GetRegister(uint32 nAddress)
 {
 	DisassembleGet(nAddress);
@@ -23,6 +23,7 @@ public:
 	void					Reset();
 
 	void					Count(unsigned int);
+	uint32					GetTicksUntilNextInterrupt() const;
 
 	uint32					GetRegister(uint32);
 	void					SetRegister(uint32, uint32);
@@ -31,6 +32,8 @@ public:
 	void					SaveState(Framework::CZipArchiveWriter&);
 
 private:
+	static uint32			GetClockDivider(uint32);
+
 	void					DisassembleGet(uint32);
 	void					DisassembleSet(uint32, uint32);
 
@@ -5,6 +5,7 @@
 #include "../Ps2Const.h"
 #include "../RegisterStateFile.h"
 #include "../MemoryStateFile.h"
+#include "../SimdDefs.h"
 #include "Vpu.h"
 #include "Vif.h"
 
@@ -595,6 +596,141 @@ void CVif::Cmd_STMASK(StreamType& stream, CODE command)
 	}
 }
 
+//Size of an element in the packet (component size * component count), V4-5 is a single 16-bits value
+static constexpr uint32 GetUnpackElementSize(uint8 dataType)
+{
+	return (dataType == 0x0F) ? 2 : (4 >> (dataType & 0x03)) * ((dataType >> 2) + 1);
+}
+
+template <uint8 dataType, bool usn>
+static void ReadUnpackValue(const uint8* src, uint128& result)
+{
+	if(dataType == 0x0F)
+	{
+		//V4-5
+		uint16 color = 0;
+		memcpy(&color, src, 2);
+
+		result.nV0 = ((color >>  0) & 0x1F) << 3;
+		result.nV1 = ((color >>  5) & 0x1F) << 3;
+		result.nV2 = ((color >> 10) & 0x1F) << 3;
+		result.nV3 = ((color >> 15) & 0x01) << 7;
+		return;
+	}
+
+	const unsigned int fieldCount = (dataType >> 2) + 1;
+	for(unsigned int i = 0; i < fieldCount; i++)
+	{
+		uint32 value = 0;
+		switch(dataType & 0x03)
+		{
+		case 0x00:
+			memcpy(&value, src + (i * 4), 4);
+			break;
+		case 0x01:
+			{
+				uint16 temp = 0;
+				memcpy(&temp, src + (i * 2), 2);
+				value = usn ? temp : static_cast<int16>(temp);
+			}
+			break;
+		case 0x02:
+			value = usn ? src[i] : static_cast<int8>(src[i]);
+			break;
+		}
+		result.nV[i] = value;
+	}
+
+	//Scalar formats are replicated in all components
+	if(fieldCount == 1)
+	{
+		result.nV1 = result.nV0;
+		result.nV2 = result.nV0;
+		result.nV3 = result.nV0;
+	}
+}
+
+#if defined(HAS_SSE2) || defined(HAS_NEON)
+
+//Expands 'count' consecutive V4-32, V4-16 or V4-8 elements to quadwords
+template <uint8 dataType, bool usn, bool addRow>
+static void UnpackV4Elements(uint8* dst, const uint8* src, uint32 count, const uint32* row)
+{
+	assert((dataType == 0x0C) || (dataType == 0x0D) || (dataType == 0x0E));
+	const uint32 elementSize = GetUnpackElementSize(dataType);
+#if defined(HAS_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rowValue = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+	for(uint32 i = 0; i < count; i++)
+	{
+		__m128i value;
+		if(dataType == 0x0C)
+		{
+			value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		}
+		else if(dataType == 0x0D)
+		{
+			value = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+			value = usn ? _mm_unpacklo_epi16(value, zero) : _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+		}
+		else
+		{
+			uint32 bytes = 0;
+			memcpy(&bytes, src, 4);
+			value = _mm_cvtsi32_si128(bytes);
+			if(usn)
+			{
+				value = _mm_unpacklo_epi16(_mm_unpacklo_epi8(value, zero), zero);
+			}
+			else
+			{
+				value = _mm_unpacklo_epi8(value, value);
+				value = _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 24);
+			}
+		}
+		if(addRow)
+		{
+			value = _mm_add_epi32(value, rowValue);
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), value);
+		src += elementSize;
+		dst += 0x10;
+	}
+#else
+	const uint32x4_t rowValue = vld1q_u32(row);
+	for(uint32 i = 0; i < count; i++)
+	{
+		uint32x4_t value;
+		if(dataType == 0x0C)
+		{
+			value = vreinterpretq_u32_u8(vld1q_u8(src));
+		}
+		else if(dataType == 0x0D)
+		{
+			uint16x4_t halves = vreinterpret_u16_u8(vld1_u8(src));
+			value = usn ? vmovl_u16(halves) : vreinterpretq_u32_s32(vmovl_s16(vreinterpret_s16_u16(halves)));
+		}
+		else
+		{
+			uint32 word = 0;
+			memcpy(&word, src, 4);
+			uint8x8_t bytes = vreinterpret_u8_u32(vdup_n_u32(word));
+			value = usn ? vmovl_u16(vget_low_u16(vmovl_u8(bytes))) :
+				vreinterpretq_u32_s32(vmovl_s16(vget_low_s16(vmovl_s8(vreinterpret_s8_u8(bytes)))));
+		}
+		if(addRow)
+		{
+			value = vaddq_u32(value, rowValue);
+		}
+		vst1q_u8(dst, vreinterpretq_u8_u32(value));
+		src += elementSize;
+		dst += 0x10;
+	}
+#endif
+}
+
+#endif
+
 void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 {
 	assert((nCommand.nCMD & 0x60) == 0x60);
@@ -603,6 +739,8 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 	const auto vuMemSize = m_vpu.GetVuMemorySize();
 	bool usn = (m_CODE.nIMM & 0x4000) != 0;
 	bool useMask = (nCommand.nCMD & 0x10) != 0;
+	uint32 dataType = nCommand.nCMD & 0x0F;
+	uint32 mode = (m_MODE < 3) ? m_MODE : MODE_NORMAL;
 	uint32 cl = m_CYCLE.nCL;
 	uint32 wl = m_CYCLE.nWL;
 	if(wl == 0) 
@@ -632,27 +770,100 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 
 	nDstAddr *= 0x10;
 
+	unsigned int functionIndex = (((((dataType * 2) + (usn ? 1 : 0)) * 2 + (useMask ? 1 : 0)) * 3 + mode) * 2) + ((cl >= wl) ? 1 : 0);
+	auto unpackFunction = m_unpackFunctions[functionIndex];
+	uint32 elementSize = GetUnpackElementSize(dataType);
+
+	while(1)
+	{
+		//Unpack as much as we can from the contiguous data available in the stream
+		uint32 directReadSize = 0;
+		auto directReadPtr = stream.GetDirectReadPointer(directReadSize);
+		uint32 readSize = (this->*unpackFunction)(vuMem, vuMemSize, nDstAddr, currentNum, directReadPtr, directReadSize, cl, wl);
+		stream.Advance(readSize);
+		if(currentNum == 0) break;
+
+		//We've used up this span, what follows might be contiguous too (ie.: source memory after the buffer)
+		if((readSize != 0) && (readSize == directReadSize)) continue;
+
+		//Next element is split between two spans or is not available yet
+		if((elementSize == 0) || (stream.GetAvailableReadBytes() < elementSize)) break;
+		uint128 element;
+		stream.Read(&element, elementSize);
+		readSize = (this->*unpackFunction)(vuMem, vuMemSize, nDstAddr, currentNum, reinterpret_cast<const uint8*>(&element), elementSize, cl, wl);
+		assert(readSize == elementSize);
+	}
+
+	if(currentNum != 0)
+	{
+		m_STAT.nVPS = 1;
+	}
+	else
+	{
+		stream.Align32();
+		m_STAT.nVPS = 0;
+	}
+
+	m_NUM = static_cast<uint8>(currentNum);
+}
+
+template <uint8 dataType, bool usn, bool useMask, uint8 mode, bool skipWrite>
+uint32 CVif::Unpack(uint8* vuMem, uint32 vuMemSize, uint32& dstAddr, uint32& currentNum, const uint8* src, uint32 srcSize, uint32 cl, uint32 wl)
+{
+	const uint32 elementSize = GetUnpackElementSize(dataType);
+	if(elementSize == 0)
+	{
+		assert(0);
+		return 0;
+	}
+
+	const uint8* srcBegin = src;
+	uint32 readTick = m_readTick;
+	uint32 writeTick = m_writeTick;
+
+#if defined(HAS_SSE2) || defined(HAS_NEON)
+	//Without masking or skipping, every V4 element fills the next quadword, expand as many as possible at once
+	if(skipWrite && !useMask && (mode != MODE_DIFFERENCE) && ((dataType == 0x0C) || (dataType == 0x0D) || (dataType == 0x0E)) &&
+		(cl == wl) && (readTick == writeTick))
+	{
+		uint32 count = std::min<uint32>(currentNum, srcSize / elementSize);
+		count = std::min<uint32>(count, (vuMemSize - dstAddr) / 0x10);
+		UnpackV4Elements<dataType, usn, mode == MODE_OFFSET>(vuMem + dstAddr, src, count, m_R);
+		src += count * elementSize;
+		srcSize -= count * elementSize;
+		currentNum -= count;
+		readTick = (readTick + count) % cl;
+		writeTick = readTick;
+		dstAddr += count * 0x10;
+		dstAddr &= (vuMemSize - 1);
+	}
+#endif
+
 	while(currentNum != 0)
 	{
 		bool mustWrite = false;
 		uint128 writeValue;
 		memset(&writeValue, 0, sizeof(writeValue));
 
-		if(cl >= wl)
+		if(skipWrite)
 		{
-			if(m_readTick < wl)
+			if(readTick < wl)
 			{
-				bool success = Unpack_ReadValue(nCommand, stream, writeValue, usn);
-				if(!success) break;
+				if(srcSize < elementSize) break;
+				ReadUnpackValue<dataType, usn>(src, writeValue);
+				src += elementSize;
+				srcSize -= elementSize;
 				mustWrite = true;
 			}
 		}
 		else
 		{
-			if(m_writeTick < cl)
+			if(writeTick < cl)
 			{
-				bool success = Unpack_ReadValue(nCommand, stream, writeValue, usn);
-				if(!success) break;
+				if(srcSize < elementSize) break;
+				ReadUnpackValue<dataType, usn>(src, writeValue);
+				src += elementSize;
+				srcSize -= elementSize;
 			}
 
 			mustWrite = true;
@@ -660,19 +871,19 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 
 		if(mustWrite)
 		{
-			auto dst = reinterpret_cast<uint128*>(vuMem + nDstAddr);
+			auto dst = reinterpret_cast<uint128*>(vuMem + dstAddr);
 
 			for(unsigned int i = 0; i < 4; i++)
 			{
-				uint32 maskOp = useMask ? GetMaskOp(i, m_writeTick) : MASK_DATA;
+				uint32 maskOp = useMask ? GetMaskOp(i, writeTick) : MASK_DATA;
 
 				if(maskOp == MASK_DATA)
 				{
-					if(m_MODE == MODE_OFFSET)
+					if(mode == MODE_OFFSET)
 					{
 						writeValue.nV[i] += m_R[i];
 					}
-					else if(m_MODE == MODE_DIFFERENCE)
+					else if(mode == MODE_DIFFERENCE)
 					{
 						writeValue.nV[i] += m_R[i];
 						m_R[i] = writeValue.nV[i];
@@ -686,7 +897,7 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 				}
 				else if(maskOp == MASK_COL)
 				{
-					int index = (m_writeTick > 3) ? 3 : m_writeTick;
+					int index = (writeTick > 3) ? 3 : writeTick;
 					dst->nV[i] = m_C[index];
 				}
 				else if(maskOp == MASK_MASK)
@@ -698,228 +909,65 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 					assert(0);
 				}
 			}
-			
+
 			currentNum--;
 		}
 
-		if(cl >= wl)
-		{
-			m_writeTick = std::min<uint32>(m_writeTick + 1, wl);
-			m_readTick = std::min<uint32>(m_readTick + 1, cl);
+		writeTick = std::min<uint32>(writeTick + 1, wl);
+		readTick = std::min<uint32>(readTick + 1, cl);
 
-			if(m_readTick == cl)
-			{
-				m_writeTick = 0;
-				m_readTick = 0;
-			}
-		}
-		else
+		if(skipWrite ? (readTick == cl) : (writeTick == wl))
 		{
-			m_writeTick = std::min<uint32>(m_writeTick + 1, wl);
-			m_readTick = std::min<uint32>(m_readTick + 1, cl);
-
-			if(m_writeTick == wl)
-			{
-				m_writeTick = 0;
-				m_readTick = 0;
-			}
+			writeTick = 0;
+			readTick = 0;
 		}
 
-		nDstAddr += 0x10;
-		nDstAddr &= (vuMemSize - 1);
-	}
-
-	if(currentNum != 0)
-	{
-		m_STAT.nVPS = 1;
-	}
-	else
-	{
-		stream.Align32();
-		m_STAT.nVPS = 0;
-	}
-
-	m_NUM = static_cast<uint8>(currentNum);
-}
-
-bool CVif::Unpack_ReadValue(const CODE& nCommand, StreamType& stream, uint128& writeValue, bool usn)
-{
-	bool success = false;
-	switch(nCommand.nCMD & 0x0F)
-	{
-	case 0x00:
-		//S-32
-		success = Unpack_S32(stream, writeValue);
-		break;
-	case 0x01:
-		//S-16
-		success = Unpack_S16(stream, writeValue, usn);
-		break;
-	case 0x02:
-		//S-8
-		success = Unpack_S8(stream, writeValue, usn);
-		break;
-	case 0x04:
-		//V2-32
-		success = Unpack_V32(stream, writeValue, 2);
-		break;
-	case 0x05:
-		//V2-16
-		success = Unpack_V16(stream, writeValue, 2, usn);
-		break;
-	case 0x06:
-		//V2-8
-		success = Unpack_V8(stream, writeValue, 2, usn);
-		break;
-	case 0x08:
-		//V3-32
-		success = Unpack_V32(stream, writeValue, 3);
-		break;
-	case 0x09:
-		//V3-16
-		success = Unpack_V16(stream, writeValue, 3, usn);
-		break;
-	case 0x0A:
-		//V3-8
-		success = Unpack_V8(stream, writeValue, 3, usn);
-		break;
-	case 0x0C:
-		//V4-32
-		success = Unpack_V32(stream, writeValue, 4);
-		break;
-	case 0x0D:
-		//V4-16
-		success = Unpack_V16(stream, writeValue, 4, usn);
-		break;
-	case 0x0E:
-		//V4-8
-		success = Unpack_V8(stream, writeValue, 4, usn);
-		break;
-	case 0x0F:
-		//V4-5
-		success = Unpack_V45(stream, writeValue);
-		break;
-	default:
-		assert(0);
-		break;
+		dstAddr += 0x10;
+		dstAddr &= (vuMemSize - 1);
 	}
-	return success;
-}
-
-bool CVif::Unpack_S32(StreamType& stream, uint128& result)
-{
-	if(stream.GetAvailableReadBytes() < 4) return false;
 
-	uint32 word = 0;
-	stream.Read(&word, 4);
-
-	for(unsigned int i = 0; i < 4; i++)
-	{
-		result.nV[i] = word;
-	}
+	m_readTick = readTick;
+	m_writeTick = writeTick;
 
-	return true;
+	return static_cast<uint32>(src - srcBegin);
 }
 
-bool CVif::Unpack_S16(StreamType& stream, uint128& result, bool zeroExtend)
-{
-	if(stream.GetAvailableReadBytes() < 2) return false;
+#define UNPACK_FUNCTIONS_MODE(dataType, usn, useMask, mode) \
+	&CVif::Unpack<dataType, usn, useMask, mode, false>, \
+	&CVif::Unpack<dataType, usn, useMask, mode, true>
 
-	uint32 temp = 0;
-	stream.Read(&temp, 2);
-	if(!zeroExtend)
-	{
-		temp = static_cast<int16>(temp);
-	}
+#define UNPACK_FUNCTIONS_MASK(dataType, usn, useMask) \
+	UNPACK_FUNCTIONS_MODE(dataType, usn, useMask, CVif::MODE_NORMAL), \
+	UNPACK_FUNCTIONS_MODE(dataType, usn, useMask, CVif::MODE_OFFSET), \
+	UNPACK_FUNCTIONS_MODE(dataType, usn, useMask, CVif::MODE_DIFFERENCE)
 
-	for(unsigned int i = 0; i < 4; i++)
-	{
-		result.nV[i] = temp;
-	}
+#define UNPACK_FUNCTIONS_USN(dataType, usn) \
+	UNPACK_FUNCTIONS_MASK(dataType, usn, false), \
+	UNPACK_FUNCTIONS_MASK(dataType, usn, true)
 
-	return true;
-}
+#define UNPACK_FUNCTIONS(dataType) \
+	UNPACK_FUNCTIONS_USN(dataType, false), \
+	UNPACK_FUNCTIONS_USN(dataType, true)
 
-bool CVif::Unpack_S8(StreamType& stream, uint128& result, bool zeroExtend)
+const CVif::UnpackFunctionType CVif::m_unpackFunctions[0x10 * 2 * 2 * 3 * 2] =
 {
-	if(stream.GetAvailableReadBytes() < 1) return false;
-
-	uint32 temp = 0;
-	stream.Read(&temp, 1);
-	if(!zeroExtend)
-	{
-		temp = static_cast<int8>(temp);
-	}
-
-	for(unsigned int i = 0; i < 4; i++)
-	{
-		result.nV[i] = temp;
-	}
-
-	return true;
-}
-
-bool CVif::Unpack_V8(StreamType& stream, uint128& result, unsigned int fields, bool zeroExtend)
-{
-	if(stream.GetAvailableReadBytes() < (fields)) return false;
-
-	for(unsigned int i = 0; i < fields; i++)
-	{
-		uint32 temp = 0;
-		stream.Read(&temp, 1);
-		if(!zeroExtend)
-		{
-			temp = static_cast<int8>(temp);
-		}
-
-		result.nV[i] = temp;
-	}
-
-	return true;
-}
-
-bool CVif::Unpack_V16(StreamType& stream, uint128& result, unsigned int fields, bool zeroExtend)
-{
-	if(stream.GetAvailableReadBytes() < (fields * 2)) return false;
-
-	for(unsigned int i = 0; i < fields; i++)
-	{
-		uint32 temp = 0;
-		stream.Read(&temp, 2);
-		if(!zeroExtend)
-		{
-			temp = static_cast<int16>(temp);
-		}
-
-		result.nV[i] = temp;
-	}
-
-	return true;
-}
-
-bool CVif::Unpack_V32(StreamType& stream, uint128& result, unsigned int fields)
-{
-	if(stream.GetAvailableReadBytes() < (fields * 4)) return false;
-
-	stream.Read(&result, (fields * 4));
-
-	return true;
-}
-
-bool CVif::Unpack_V45(StreamType& stream, uint128& result)
-{
-	if(stream.GetAvailableReadBytes() < 2) return false;
-
-	uint16 nColor = 0;
-	stream.Read(&nColor, 2);
-
-	result.nV0 = ((nColor >>  0) & 0x1F) << 3;
-	result.nV1 = ((nColor >>  5) & 0x1F) << 3;
-	result.nV2 = ((nColor >> 10) & 0x1F) << 3;
-	result.nV3 = ((nColor >> 15) & 0x01) << 7;
-
-	return true;
-}
+	UNPACK_FUNCTIONS(0x00),
+	UNPACK_FUNCTIONS(0x01),
+	UNPACK_FUNCTIONS(0x02),
+	UNPACK_FUNCTIONS(0x03),
+	UNPACK_FUNCTIONS(0x04),
+	UNPACK_FUNCTIONS(0x05),
+	UNPACK_FUNCTIONS(0x06),
+	UNPACK_FUNCTIONS(0x07),
+	UNPACK_FUNCTIONS(0x08),
+	UNPACK_FUNCTIONS(0x09),
+	UNPACK_FUNCTIONS(0x0A),
+	UNPACK_FUNCTIONS(0x0B),
+	UNPACK_FUNCTIONS(0x0C),
+	UNPACK_FUNCTIONS(0x0D),
+	UNPACK_FUNCTIONS(0x0E),
+	UNPACK_FUNCTIONS(0x0F),
+};
 
 uint32 CVif::GetMaskOp(unsigned int row, unsigned int col) const
 {
@@ -1195,6 +1243,45 @@ void CVif::CFifoStream::Read(void* buffer, uint32 size)
 	}
 }
 
+const uint8* CVif::CFifoStream::GetDirectReadPointer(uint32& size) const
+{
+	//Returns data left in our buffer if any, source memory otherwise
+	assert(m_source != NULL);
+	if(m_bufferPosition < BUFFERSIZE)
+	{
+		size = BUFFERSIZE - m_bufferPosition;
+		return reinterpret_cast<const uint8*>(&m_buffer) + m_bufferPosition;
+	}
+	else
+	{
+		assert(!m_tagIncluded);
+		size = GetRemainingDmaTransferSize();
+		return m_source + m_nextAddress;
+	}
+}
+
+void CVif::CFifoStream::Advance(uint32 size)
+{
+	//Size must not be larger than what was returned by GetDirectReadPointer
+	if(size == 0) return;
+	if(m_bufferPosition < BUFFERSIZE)
+	{
+		assert(size <= (BUFFERSIZE - m_bufferPosition));
+		m_bufferPosition += size;
+	}
+	else
+	{
+		assert(size <= GetRemainingDmaTransferSize());
+		m_nextAddress += size & ~(BUFFERSIZE - 1);
+		uint32 remainSize = size & (BUFFERSIZE - 1);
+		if(remainSize != 0)
+		{
+			SyncBuffer();
+			m_bufferPosition += remainSize;
+		}
+	}
+}
+
 void CVif::CFifoStream::Flush()
 {
 	m_bufferPosition = BUFFERSIZE;
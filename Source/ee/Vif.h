@@ -95,6 +95,8 @@ protected:
 		uint32					GetAvailableReadBytes() const;
 		uint32					GetRemainingDmaTransferSize() const;
 		void					Read(void*, uint32);
+		const uint8*			GetDirectReadPointer(uint32&) const;
+		void					Advance(uint32);
 		void					Flush();
 		void					Align32();
 		void					SetDmaParams(uint32, uint32, bool);
@@ -184,14 +186,12 @@ protected:
 	void				Cmd_STCOL(StreamType&, CODE);
 	void				Cmd_STMASK(StreamType&, CODE);
 
-	bool				Unpack_ReadValue(const CODE&, StreamType&, uint128&, bool);
-	bool				Unpack_S32(StreamType&, uint128&);
-	bool				Unpack_S16(StreamType&, uint128&, bool);
-	bool				Unpack_S8(StreamType&, uint128&, bool);
-	bool				Unpack_V16(StreamType&, uint128&, unsigned int, bool);
-	bool				Unpack_V8(StreamType&, uint128&, unsigned int, bool);
-	bool				Unpack_V32(StreamType&, uint128&, unsigned int);
-	bool				Unpack_V45(StreamType&, uint128&);
+	typedef uint32 (CVif::*UnpackFunctionType)(uint8*, uint32, uint32&, uint32&, const uint8*, uint32, uint32, uint32);
+
+	template <uint8 dataType, bool usn, bool useMask, uint8 mode, bool skipWrite>
+	uint32				Unpack(uint8*, uint32, uint32&, uint32&, const uint8*, uint32, uint32, uint32);
+
+	static const UnpackFunctionType m_unpackFunctions[0x10 * 2 * 2 * 3 * 2];
 
 	uint32				GetMaskOp(unsigned int, unsigned int) const;
 
@@ -18,7 +18,7 @@ CVpu::CVpu(unsigned int number, const VPUINIT& vpuInit, CGIF& gif, uint8* ram, u
 , m_vuMemSize((number == 0) ? PS2::VUMEM0SIZE : PS2::VUMEM1SIZE)
 , m_ctx(vpuInit.context)
 , m_gif(gif)
-, m_executor(*vpuInit.context)
+, m_executor(*vpuInit.context, vpuInit.microMem, (number == 0) ? PS2::MICROMEM0SIZE : PS2::MICROMEM1SIZE)
 , m_vuProfilerZone(CProfiler::GetInstance().RegisterZone("VU"))
 #ifdef DEBUGGER_INCLUDED
 , m_microMemMiniState(new uint8[(number == 0) ? PS2::MICROMEM0SIZE : PS2::MICROMEM1SIZE])
@@ -46,6 +46,7 @@ void CVpu::Execute(int32 quota)
 	CProfilerZone profilerZone(m_vuProfilerZone);
 #endif
 
+	m_executor.UpdateMicroProgram();
 	m_executor.Execute(quota);
 	if(m_ctx->m_State.nHasException)
 	{
@@ -117,6 +118,7 @@ void CVpu::SaveState(Framework::CZipArchiveWriter& archive)
 void CVpu::LoadState(Framework::CZipArchiveReader& archive)
 {
 	m_vif->LoadState(archive);
+	InvalidateMicroProgram();
 }
 
 CMIPS& CVpu::GetContext() const
@@ -149,6 +151,11 @@ CVif& CVpu::GetVif()
 	return *m_vif.get();
 }
 
+CVuExecutor& CVpu::GetExecutor()
+{
+	return m_executor;
+}
+
 void CVpu::ExecuteMicroProgram(uint32 nAddress)
 {
 	CLog::GetInstance().Print(LOG_NAME, "Starting microprogram execution at 0x%0.8X.\r\n", nAddress);
@@ -172,7 +179,7 @@ void CVpu::ExecuteMicroProgram(uint32 nAddress)
 
 void CVpu::InvalidateMicroProgram()
 {
-	m_executor.ClearActiveBlocks();
+	m_executor.InvalidateMicroProgram();
 }
 
 void CVpu::ProcessXgKick(uint32 address)
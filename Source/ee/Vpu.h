@@ -52,6 +52,7 @@ public:
 	bool					IsVuRunning() const;
 
 	CVif&					GetVif();
+	CVuExecutor&			GetExecutor();
 
 	void					ExecuteMicroProgram(uint32);
 	void					InvalidateMicroProgram();
@@ -1,6 +1,8 @@
 #include "VuBasicBlock.h"
 #include "MA_VU.h"
 #include "offsetof_def.h"
+#include "string_format.h"
+#include <zlib.h>
 
 CVuBasicBlock::CVuBasicBlock(CMIPS& context, uint32 begin, uint32 end)
 : CBasicBlock(context, begin, end)
@@ -13,6 +15,11 @@ CVuBasicBlock::~CVuBasicBlock()
 
 }
 
+std::string CVuBasicBlock::GetName() const
+{
+	return string_format("VuBasicBlock_0x%0.8X_0x%0.8X", m_begin, m_end);
+}
+
 void CVuBasicBlock::CompileRange(CMipsJitter* jitter)
 {
 	assert((m_begin & 0x07) == 0);
@@ -162,6 +169,20 @@ void CVuBasicBlock::CompileRange(CMipsJitter* jitter)
 	}
 }
 
+uint32 CVuBasicBlock::ComputeChecksum() const
+{
+	//Compilation looks at a few instructions around the block (delay slot, integer branch delay)
+	uint32 checksumBegin = (m_begin >= 0x10) ? (m_begin - 0x10) : 0;
+	uint32 checksumEnd = m_end + 8;
+	uint32 checksum = crc32(0, Z_NULL, 0);
+	for(uint32 address = checksumBegin; address <= checksumEnd; address += 4)
+	{
+		uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
+		checksum = crc32(checksum, reinterpret_cast<const Bytef*>(&opcode), 4);
+	}
+	return checksum;
+}
+
 bool CVuBasicBlock::IsConditionalBranch(uint32 opcodeLo)
 {
 	//Conditional branches are in the contiguous opcode range 0x28 -> 0x2F inclusive
@@ -8,8 +8,11 @@ public:
 					CVuBasicBlock(CMIPS&, uint32, uint32);
 	virtual			~CVuBasicBlock();
 
+	std::string		GetName() const override;
+
 protected:
 	void			CompileRange(CMipsJitter*) override;
+	uint32			ComputeChecksum() const override;
 
 private:
 	struct INTEGER_BRANCH_DELAY_INFO
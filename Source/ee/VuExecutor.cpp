@@ -1,48 +1,178 @@
 #include "VuExecutor.h"
 #include "VuBasicBlock.h"
+#include <cstring>
 #include <zlib.h>
 
 static const uint32 c_vuMaxAddress = 0x4000;
 
-CVuExecutor::CVuExecutor(CMIPS& context) :
-CMipsExecutor(context, c_vuMaxAddress)
+CVuExecutor::CVuExecutor(CMIPS& context, const uint8* microMem, uint32 microMemSize) :
+CMipsExecutor(context, c_vuMaxAddress),
+m_microMem(microMem),
+m_microMemSize(microMemSize)
 {
-
+	assert(m_subTableCount == 1);
 }
 
 CVuExecutor::~CVuExecutor()
 {
-
+	ClearMicroPrograms();
 }
 
 void CVuExecutor::Reset()
 {
+	ClearMicroPrograms();
+	m_activeMicroProgram = MICROPROGRAM();
+	m_microProgramDirty = true;
 	m_cachedBlocks.clear();
 	CMipsExecutor::Reset();
 }
 
+void CVuExecutor::InvalidateMicroProgram()
+{
+	if(m_microMem == nullptr)
+	{
+		ClearActiveBlocks();
+		return;
+	}
+	//Micro memory might still be written to before the next execution (ie.: MPG split in many parts),
+	//wait until then to figure out which micro program we're running
+	m_microProgramDirty = true;
+}
+
+void CVuExecutor::UpdateMicroProgram()
+{
+	if(!m_microProgramDirty) return;
+	if(m_microMem == nullptr) return;
+	m_microProgramDirty = false;
+
+	uint32 checksum = crc32(0, m_microMem, m_microMemSize);
+	if(
+		!m_activeMicroProgram.microMem.empty() &&
+		(m_activeMicroProgram.checksum == checksum) &&
+		(memcmp(m_activeMicroProgram.microMem.data(), m_microMem, m_microMemSize) == 0)
+		)
+	{
+		//Same micro program was uploaded again
+		return;
+	}
+
+	SaveActiveMicroProgram();
+	if(!RestoreMicroProgram(checksum))
+	{
+		m_activeMicroProgram.checksum = checksum;
+		m_activeMicroProgram.microMem.assign(m_microMem, m_microMem + m_microMemSize);
+	}
+}
+
+void CVuExecutor::SaveActiveMicroProgram()
+{
+	if(m_activeMicroProgram.microMem.empty())
+	{
+		//We don't know which micro program those blocks were compiled from
+		ClearActiveBlocks();
+		return;
+	}
+
+	//Links will be established again if this micro program is restored
+	for(const auto& block : m_blocks)
+	{
+		for(unsigned int i = 0; i < LINK_SLOT_MAX; i++)
+		{
+			block->SetLinkedBlock(static_cast<LINK_SLOT>(i), MIPS_INVALID_PC, nullptr);
+		}
+	}
+	m_blockLinks.clear();
+
+	auto microProgram = std::move(m_activeMicroProgram);
+	m_activeMicroProgram = MICROPROGRAM();
+	microProgram.blocks = std::move(m_blocks);
+	microProgram.blockTable = m_blockTable[0];
+	m_blocks.clear();
+	m_blockTable[0] = nullptr;
+
+	uint32 checksum = microProgram.checksum;
+	m_microPrograms.push_front(std::move(microProgram));
+	m_microProgramMap.insert(std::make_pair(checksum, std::begin(m_microPrograms)));
+
+	while(m_microPrograms.size() > MAX_CACHED_MICROPROGRAMS)
+	{
+		auto microProgramIterator = std::prev(std::end(m_microPrograms));
+		auto equalRange = m_microProgramMap.equal_range(microProgramIterator->checksum);
+		for(auto mapIterator = equalRange.first; mapIterator != equalRange.second; ++mapIterator)
+		{
+			if(mapIterator->second != microProgramIterator) continue;
+			m_microProgramMap.erase(mapIterator);
+			break;
+		}
+		delete [] microProgramIterator->blockTable;
+		m_microPrograms.erase(microProgramIterator);
+	}
+}
+
+bool CVuExecutor::RestoreMicroProgram(uint32 checksum)
+{
+	assert(m_blocks.empty());
+	assert(m_blockTable[0] == nullptr);
+
+	auto equalRange = m_microProgramMap.equal_range(checksum);
+	for(auto mapIterator = equalRange.first; mapIterator != equalRange.second; ++mapIterator)
+	{
+		auto microProgramIterator = mapIterator->second;
+		if(memcmp(microProgramIterator->microMem.data(), m_microMem, m_microMemSize) != 0) continue;
+
+		m_blocks = std::move(microProgramIterator->blocks);
+		m_blockTable[0] = microProgramIterator->blockTable;
+		m_activeMicroProgram.checksum = checksum;
+		m_activeMicroProgram.microMem = std::move(microProgramIterator->microMem);
+
+		m_microProgramMap.erase(mapIterator);
+		m_microPrograms.erase(microProgramIterator);
+		return true;
+	}
+
+	return false;
+}
+
+void CVuExecutor::ClearMicroPrograms()
+{
+	for(const auto& microProgram : m_microPrograms)
+	{
+		delete [] microProgram.blockTable;
+	}
+	m_microPrograms.clear();
+	m_microProgramMap.clear();
+}
+
 CMipsExecutor::BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end)
 {
 	uint32 blockSize = ((end - begin) + 4) / 4;
 	uint32 blockSizeByte = blockSize * 4;
-	uint32* blockMemory = reinterpret_cast<uint32*>(alloca(blockSizeByte));
-	for(uint32 address = begin; address <= end; address += 8)
+	uint32 checksum = 0;
+	if((end + 4) <= m_microMemSize)
 	{
-		uint32 index = (address - begin) / 4;
+		checksum = crc32(0, m_microMem + begin, blockSizeByte);
+	}
+	else
+	{
+		uint32* blockMemory = reinterpret_cast<uint32*>(alloca(blockSizeByte));
+		for(uint32 address = begin; address <= end; address += 8)
+		{
+			uint32 index = (address - begin) / 4;
 
-		uint32 addressLo = address + 0;
-		uint32 addressHi = address + 4;
+			uint32 addressLo = address + 0;
+			uint32 addressHi = address + 4;
 
-		uint32 opcodeLo = m_context.m_pMemoryMap->GetInstruction(addressLo);
-		uint32 opcodeHi = m_context.m_pMemoryMap->GetInstruction(addressHi);
+			uint32 opcodeLo = m_context.m_pMemoryMap->GetInstruction(addressLo);
+			uint32 opcodeHi = m_context.m_pMemoryMap->GetInstruction(addressHi);
 
-		assert((index + 0) < blockSize);
-		blockMemory[index + 0] = opcodeLo;
-		assert((index + 1) < blockSize);
-		blockMemory[index + 1] = opcodeHi;
-	}
+			assert((index + 0) < blockSize);
+			blockMemory[index + 0] = opcodeLo;
+			assert((index + 1) < blockSize);
+			blockMemory[index + 1] = opcodeHi;
+		}
 
-	uint32 checksum = crc32(0, reinterpret_cast<Bytef*>(blockMemory), blockSizeByte);
+		checksum = crc32(0, reinterpret_cast<Bytef*>(blockMemory), blockSizeByte);
+	}
 
 	auto equalRange = m_cachedBlocks.equal_range(checksum);
 	for(; equalRange.first != equalRange.second; ++equalRange.first)
@@ -1,17 +1,22 @@
 #ifndef _VUEXECUTOR_H_
 #define _VUEXECUTOR_H_
 
+#include <list>
+#include <vector>
 #include <unordered_map>
 #include "../MipsExecutor.h"
 
 class CVuExecutor : public CMipsExecutor
 {
 public:
-							CVuExecutor(CMIPS&);
+							CVuExecutor(CMIPS&, const uint8* = nullptr, uint32 = 0);
 	virtual					~CVuExecutor();
 
 	virtual void			Reset();
 
+	void					InvalidateMicroProgram();
+	void					UpdateMicroProgram();
+
 protected:
 	typedef std::unordered_multimap<uint32, BasicBlockPtr> CachedBlockMap;
 
@@ -19,6 +24,34 @@ protected:
 	virtual void			PartitionFunction(uint32);
 
 	CachedBlockMap			m_cachedBlocks;
+
+private:
+	enum
+	{
+		MAX_CACHED_MICROPROGRAMS = 32,
+	};
+
+	//Blocks compiled for a given micro memory content
+	struct MICROPROGRAM
+	{
+		uint32					checksum = 0;
+		std::vector<uint8>		microMem;
+		BlockList				blocks;
+		CBasicBlock**			blockTable = nullptr;
+	};
+	typedef std::list<MICROPROGRAM> MicroProgramList;
+	typedef std::unordered_multimap<uint32, MicroProgramList::iterator> MicroProgramMap;
+
+	void					SaveActiveMicroProgram();
+	bool					RestoreMicroProgram(uint32);
+	void					ClearMicroPrograms();
+
+	const uint8*			m_microMem = nullptr;
+	uint32					m_microMemSize = 0;
+	bool					m_microProgramDirty = true;
+	MICROPROGRAM			m_activeMicroProgram;
+	MicroProgramList		m_microPrograms;
+	MicroProgramMap			m_microProgramMap;
 };
 
 #endif
@@ -65,11 +65,6 @@ void CGSH_OpenGL::InitializeImpl()
 
 	m_nVtxCount = 0;
 
-	for(unsigned int i = 0; i < MAX_TEXTURE_CACHE; i++)
-	{
-		m_textureCache.push_back(TexturePtr(new CTexture()));
-	}
-
 	for(unsigned int i = 0; i < MAX_PALETTE_CACHE; i++)
 	{
 		m_paletteCache.push_back(PalettePtr(new CPalette()));
@@ -84,7 +79,6 @@ void CGSH_OpenGL::ReleaseImpl()
 {
 	ResetImpl();
 
-	m_textureCache.clear();
 	m_paletteCache.clear();
 	m_shaders.clear();
 	m_presentProgram.reset();
@@ -282,11 +276,11 @@ void CGSH_OpenGL::FlipImpl()
 	CGSHandler::FlipImpl();
 }
 
-void CGSH_OpenGL::LoadState(Framework::CZipArchiveReader& archive)
+void CGSH_OpenGL::LoadState(Framework::CZipArchiveReader& archive, bool includeRam)
 {
-	CGSHandler::LoadState(archive);
+	CGSHandler::LoadState(archive, includeRam);
 
-	m_mailBox.SendCall(std::bind(&CGSH_OpenGL::TexCache_InvalidateTextures, this, 0, RAMSIZE));
+	SendGSCall(std::bind(&CGSH_OpenGL::TexCache_InvalidateTextures, this, 0, RAMSIZE));
 }
 
 void CGSH_OpenGL::RegisterPreferences()
@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include "../GSHandler.h"
 #include "../GsCachedArea.h"
+#include "../GsTextureCache.h"
 #include "opengl/OpenGlDef.h"
 #include "opengl/Program.h"
 #include "opengl/Shader.h"
@@ -20,7 +21,7 @@ public:
 
 	static void						RegisterPreferences();
 
-	virtual void					LoadState(Framework::CZipArchiveReader&) override;
+	virtual void					LoadState(Framework::CZipArchiveReader&, bool = true) override;
 	
 	void							ProcessHostToLocalTransfer() override;
 	void							ProcessLocalToHostTransfer() override;
@@ -135,7 +136,6 @@ private:
 
 	enum
 	{
-		MAX_TEXTURE_CACHE = 256,
 		MAX_PALETTE_CACHE = 256,
 	};
 
@@ -174,21 +174,7 @@ private:
 
 	typedef std::unordered_map<uint32, Framework::OpenGl::ProgramPtr> ShaderMap;
 
-	class CTexture
-	{
-	public:
-									CTexture();
-									~CTexture();
-		void						Free();
-
-		uint64						m_tex0;
-		GLuint						m_texture;
-		bool						m_live;
-
-		CGsCachedArea				m_cachedArea;
-	};
-	typedef std::shared_ptr<CTexture> TexturePtr;
-	typedef std::list<TexturePtr> TextureList;
+	typedef CGsTextureCache<Framework::OpenGl::CTexture> TextureCache;
 
 	class CPalette
 	{
@@ -376,8 +362,6 @@ private:
 
 	uint8*							m_pCvtBuffer;
 
-	CTexture*						TexCache_Search(const TEX0&);
-	void							TexCache_Insert(const TEX0&, GLuint);
 	void							TexCache_InvalidateTextures(uint32, uint32);
 
 	GLuint							PalCache_Search(const TEX0&);
@@ -402,7 +386,7 @@ private:
 	GLint							m_copyToFbSrcPositionUniform = -1;
 	GLint							m_copyToFbSrcSizeUniform = -1;
 
-	TextureList						m_textureCache;
+	TextureCache					m_textureCache;
 	PaletteList						m_paletteCache;
 	FramebufferList					m_framebuffers;
 	DepthbufferList					m_depthbuffers;
@@ -0,0 +1,1151 @@
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "GSH_Software.h"
+#include "GsPixelFormats.h"
+
+struct CGSH_Software::DRAWCONTEXT
+{
+	DRAWCONTEXT(uint8* ram, const RENDERSTATE& state)
+	: state(state)
+	, frame(make_convertible<FRAME>(state.frame))
+	, zbuf(make_convertible<ZBUF>(state.zbuf))
+	, test(make_convertible<TEST>(state.test))
+	, alpha(make_convertible<ALPHA>(state.alpha))
+	, tex0(make_convertible<TEX0>(state.tex0))
+	, clamp(make_convertible<CLAMP>(state.clamp))
+	, texa(make_convertible<TEXA>(state.texa))
+	, frame32(ram, frame.GetBasePtr(), frame.nWidth)
+	, frame16(ram, frame.GetBasePtr(), frame.nWidth)
+	, frame16S(ram, frame.GetBasePtr(), frame.nWidth)
+	, depth32(ram, zbuf.GetBasePtr(), frame.nWidth)
+	, depth16(ram, zbuf.GetBasePtr(), frame.nWidth)
+	, depth16S(ram, zbuf.GetBasePtr(), frame.nWidth)
+	, texture32(ram, tex0.GetBufPtr(), tex0.nBufWidth)
+	, texture16(ram, tex0.GetBufPtr(), tex0.nBufWidth)
+	, texture16S(ram, tex0.GetBufPtr(), tex0.nBufWidth)
+	, texture8(ram, tex0.GetBufPtr(), tex0.nBufWidth)
+	, texture4(ram, tex0.GetBufPtr(), tex0.nBufWidth)
+	{
+		texWidth = tex0.GetWidth();
+		texHeight = tex0.GetHeight();
+		fogColor[0] = static_cast<int32>((state.fogCol >>  0) & 0xFF);
+		fogColor[1] = static_cast<int32>((state.fogCol >>  8) & 0xFF);
+		fogColor[2] = static_cast<int32>((state.fogCol >> 16) & 0xFF);
+	}
+
+	const RENDERSTATE&						state;
+	FRAME									frame;
+	ZBUF									zbuf;
+	TEST									test;
+	ALPHA									alpha;
+	TEX0									tex0;
+	CLAMP									clamp;
+	TEXA									texa;
+	CGsPixelFormats::CPixelIndexorPSMCT32	frame32;
+	CGsPixelFormats::CPixelIndexorPSMCT16	frame16;
+	CGsPixelFormats::CPixelIndexorPSMCT16S	frame16S;
+	CGsPixelFormats::CPixelIndexorPSMZ32	depth32;
+	CGsPixelFormats::CPixelIndexorPSMZ16	depth16;
+	CGsPixelFormats::CPixelIndexorPSMZ16S	depth16S;
+	CGsPixelFormats::CPixelIndexorPSMCT32	texture32;
+	CGsPixelFormats::CPixelIndexorPSMCT16	texture16;
+	CGsPixelFormats::CPixelIndexorPSMCT16S	texture16S;
+	CGsPixelFormats::CPixelIndexorPSMT8		texture8;
+	CGsPixelFormats::CPixelIndexorPSMT4		texture4;
+	uint32									texWidth = 0;
+	uint32									texHeight = 0;
+	int32									fogColor[3];
+};
+
+static uint32 RGBA16ToRGBA32(uint16 color)
+{
+	return ((color & 0x8000) ? 0x80000000 : 0) | ((color & 0x7C00) << 9) | ((color & 0x03E0) << 6) | ((color & 0x001F) << 3);
+}
+
+static uint16 RGBA32ToRGBA16(uint32 color)
+{
+	return static_cast<uint16>(((color >> 3) & 0x001F) | ((color >> 6) & 0x03E0) | ((color >> 9) & 0x7C00) | ((color >> 16) & 0x8000));
+}
+
+static uint32 ExpandAlpha(uint32 color, bool hasAlphaBit, const CGSHandler::TEXA& texa)
+{
+	//Alpha of 24 and 16 bits texels comes from TEXA
+	uint32 rgb = color & 0x00FFFFFF;
+	if(hasAlphaBit && (color & 0xFF000000))
+	{
+		return rgb | (static_cast<uint32>(texa.nTA1) << 24);
+	}
+	if(texa.nAEM && (rgb == 0))
+	{
+		return rgb;
+	}
+	return rgb | (static_cast<uint32>(texa.nTA0) << 24);
+}
+
+static int32 ClampTexCoord(unsigned int mode, int32 coord, int32 size, int32 min, int32 max)
+{
+	switch(mode)
+	{
+	default:
+	case 0:
+		return coord & (size - 1);
+	case 1:
+		return std::min<int32>(std::max<int32>(coord, 0), size - 1);
+	case 2:
+		return std::min<int32>(std::max<int32>(coord, min), max);
+	case 3:
+		return (coord & min) | max;
+	}
+}
+
+static int64 EdgeFunction(int32 ax, int32 ay, int32 bx, int32 by, int32 px, int32 py)
+{
+	return (static_cast<int64>(bx - ax) * static_cast<int64>(py - ay)) - (static_cast<int64>(by - ay) * static_cast<int64>(px - ax));
+}
+
+static float Lerp(float a, float b, float factor)
+{
+	return a + ((b - a) * factor);
+}
+
+CGSH_Software::CGSH_Software()
+{
+	//Page offset tables are built lazily and aren't thread safe, make sure they exist before workers use them
+	CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMCT16(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMCT16S(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMZ32(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMZ16(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMZ16S(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMT8(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMT4(m_pRAM, 0, 1);
+}
+
+CGSH_Software::~CGSH_Software()
+{
+
+}
+
+void CGSH_Software::InitializeImpl()
+{
+	unsigned int workerCount = std::min<unsigned int>(std::max<unsigned int>(std::thread::hardware_concurrency(), 1), MAX_WORKER_COUNT);
+	m_workersDone = false;
+	for(unsigned int i = 0; i < workerCount; i++)
+	{
+		m_workerThreads.emplace_back([this, i] () { WorkerThreadProc(i); });
+	}
+}
+
+void CGSH_Software::ReleaseImpl()
+{
+	FlushPrimitives();
+	{
+		std::lock_guard<std::mutex> workerLock(m_workerMutex);
+		m_workersDone = true;
+	}
+	m_workerCondition.notify_all();
+	for(auto& workerThread : m_workerThreads)
+	{
+		workerThread.join();
+	}
+	m_workerThreads.clear();
+}
+
+void CGSH_Software::ResetImpl()
+{
+	FlushPrimitives();
+	m_vtxCount = 0;
+	m_primitiveType = PRIM_INVALID;
+	m_renderStateDirty = true;
+}
+
+void CGSH_Software::FlipImpl()
+{
+	FlushPrimitives();
+}
+
+void CGSH_Software::MarkNewFrame()
+{
+	//Frame observers (ie.: frame dumps) may look at GS memory
+	FlushPrimitives();
+	CGSHandler::MarkNewFrame();
+}
+
+void CGSH_Software::WriteRegisterImpl(uint8 registerId, uint64 data)
+{
+	switch(registerId)
+	{
+	case GS_REG_TEX0_1:
+	case GS_REG_TEX0_2:
+	case GS_REG_TEX2_1:
+	case GS_REG_TEX2_2:
+		{
+			//CLUT loads read GS memory right away, make sure it's up to date if we've been drawing there
+			//TEX2 has the same layout as TEX0 for the fields used here
+			auto tex0 = make_convertible<TEX0>(data);
+			if((tex0.nCLD != 0) && CGsPixelFormats::IsPsmIDTEX(tex0.nPsm) && IsBatchWritingTo(tex0.GetCLUTPtr(), CGsPixelFormats::PAGESIZE))
+			{
+				FlushPrimitives();
+			}
+		}
+		break;
+	case GS_REG_TRXDIR:
+		FlushPrimitives();
+		break;
+	}
+
+	CGSHandler::WriteRegisterImpl(registerId, data);
+
+	switch(registerId)
+	{
+	case GS_REG_PRIM:
+		m_primitiveType = static_cast<unsigned int>(data & 0x07);
+		switch(m_primitiveType)
+		{
+		case PRIM_POINT:
+			m_vtxCount = 1;
+			break;
+		case PRIM_LINE:
+		case PRIM_LINESTRIP:
+			m_vtxCount = 2;
+			break;
+		case PRIM_TRIANGLE:
+		case PRIM_TRIANGLESTRIP:
+		case PRIM_TRIANGLEFAN:
+			m_vtxCount = 3;
+			break;
+		case PRIM_SPRITE:
+			m_vtxCount = 2;
+			break;
+		default:
+			m_vtxCount = 0;
+			break;
+		}
+		m_renderStateDirty = true;
+		break;
+
+	case GS_REG_RGBAQ:
+	case GS_REG_ST:
+	case GS_REG_UV:
+	case GS_REG_FOG:
+		break;
+
+	case GS_REG_XYZ2:
+	case GS_REG_XYZ3:
+	case GS_REG_XYZF2:
+	case GS_REG_XYZF3:
+		VertexKick(registerId, data);
+		break;
+
+	default:
+		m_renderStateDirty = true;
+		break;
+	}
+}
+
+void CGSH_Software::VertexKick(uint8 registerId, uint64 value)
+{
+	if(m_vtxCount == 0) return;
+
+	bool drawingKick = (registerId == GS_REG_XYZ2) || (registerId == GS_REG_XYZF2);
+	bool fog = (registerId == GS_REG_XYZF2) || (registerId == GS_REG_XYZF3);
+
+	if(!m_drawEnabled) drawingKick = false;
+
+	auto& vertex = m_vtxBuffer[m_vtxCount - 1];
+	vertex.nPosition	= fog ? (value & 0x00FFFFFFFFFFFFFFULL) : value;
+	vertex.nRGBAQ		= m_nReg[GS_REG_RGBAQ];
+	vertex.nUV			= m_nReg[GS_REG_UV];
+	vertex.nST			= m_nReg[GS_REG_ST];
+	vertex.nFog			= fog ? static_cast<uint8>(value >> 56) : static_cast<uint8>(m_nReg[GS_REG_FOG] >> 56);
+
+	m_vtxCount--;
+
+	if(m_vtxCount == 0)
+	{
+		if((m_nReg[GS_REG_PRMODECONT] & 1) != 0)
+		{
+			m_primitiveMode <<= m_nReg[GS_REG_PRIM];
+		}
+		else
+		{
+			m_primitiveMode <<= m_nReg[GS_REG_PRMODE];
+		}
+
+		if(drawingKick)
+		{
+			SetRenderState(m_primitiveMode);
+		}
+
+		switch(m_primitiveType)
+		{
+		case PRIM_POINT:
+			if(drawingKick) AddPrimitive(PRIM_POINT, 1);
+			m_vtxCount = 1;
+			break;
+		case PRIM_LINE:
+			if(drawingKick) AddPrimitive(PRIM_LINE, 2);
+			m_vtxCount = 2;
+			break;
+		case PRIM_LINESTRIP:
+			if(drawingKick) AddPrimitive(PRIM_LINE, 2);
+			memcpy(&m_vtxBuffer[1], &m_vtxBuffer[0], sizeof(VERTEX));
+			m_vtxCount = 1;
+			break;
+		case PRIM_TRIANGLE:
+			if(drawingKick) AddPrimitive(PRIM_TRIANGLE, 3);
+			m_vtxCount = 3;
+			break;
+		case PRIM_TRIANGLESTRIP:
+			if(drawingKick) AddPrimitive(PRIM_TRIANGLE, 3);
+			memcpy(&m_vtxBuffer[2], &m_vtxBuffer[1], sizeof(VERTEX));
+			memcpy(&m_vtxBuffer[1], &m_vtxBuffer[0], sizeof(VERTEX));
+			m_vtxCount = 1;
+			break;
+		case PRIM_TRIANGLEFAN:
+			if(drawingKick) AddPrimitive(PRIM_TRIANGLE, 3);
+			memcpy(&m_vtxBuffer[1], &m_vtxBuffer[0], sizeof(VERTEX));
+			m_vtxCount = 1;
+			break;
+		case PRIM_SPRITE:
+			if(drawingKick) AddPrimitive(PRIM_SPRITE, 2);
+			m_vtxCount = 2;
+			break;
+		}
+	}
+}
+
+void CGSH_Software::SetRenderState(const PRMODE& primitiveMode)
+{
+	if(!m_renderStateDirty) return;
+
+	unsigned int context = primitiveMode.nContext;
+
+	RENDERSTATE state;
+	state.gouraud	= primitiveMode.nShading != 0;
+	state.textured	= primitiveMode.nTexture != 0;
+	state.fogged	= primitiveMode.nFog != 0;
+	state.blended	= primitiveMode.nAlpha != 0;
+	state.useUV		= primitiveMode.nUseUV != 0;
+	state.pabe		= (m_nReg[GS_REG_PABE] & 1) != 0;
+	state.fba		= (m_nReg[GS_REG_FBA_1 + context] & 1) != 0;
+	state.colClamp	= (m_nReg[GS_REG_COLCLAMP] & 1) != 0;
+	state.frame		= m_nReg[GS_REG_FRAME_1 + context];
+	state.zbuf		= m_nReg[GS_REG_ZBUF_1 + context];
+	state.test		= m_nReg[GS_REG_TEST_1 + context];
+	state.alpha		= m_nReg[GS_REG_ALPHA_1 + context];
+	state.tex0		= m_nReg[GS_REG_TEX0_1 + context];
+	state.clamp		= m_nReg[GS_REG_CLAMP_1 + context];
+	state.texa		= m_nReg[GS_REG_TEXA];
+	state.scissor	= m_nReg[GS_REG_SCISSOR_1 + context];
+	state.fogCol	= m_nReg[GS_REG_FOGCOL];
+
+	auto tex0 = make_convertible<TEX0>(state.tex0);
+	if(state.textured && CGsPixelFormats::IsPsmIDTEX(tex0.nPsm))
+	{
+		MakeLinearCLUT(tex0, state.clut);
+		if(tex0.nCPSM == PSMCT16)
+		{
+			auto texa = make_convertible<TEXA>(state.texa);
+			for(auto& color : state.clut)
+			{
+				color = ExpandAlpha(color, true, texa);
+			}
+		}
+	}
+
+	//Workers only order primitives within a tile, so a batch can't span several render targets
+	uint64 targetMask = 0xFFFFFFFFULL;
+	if(!m_primitives.empty() &&
+		(((state.frame ^ m_batchFrame) & targetMask) || ((state.zbuf ^ m_batchZbuf) & targetMask)))
+	{
+		FlushPrimitives();
+	}
+
+	//Workers don't see each other's writes, so we can't sample what the batch is drawing
+	if(state.textured)
+	{
+		auto pageSize = CGsPixelFormats::GetPsmPageSize(tex0.nPsm);
+		uint32 pageCountX = std::max<uint32>(tex0.GetBufWidth() / pageSize.first, 1);
+		uint32 pageCountY = (tex0.GetHeight() + pageSize.second - 1) / pageSize.second;
+		if(IsBatchWritingTo(tex0.GetBufPtr(), pageCountX * pageCountY * CGsPixelFormats::PAGESIZE))
+		{
+			FlushPrimitives();
+		}
+	}
+
+	m_batchFrame = state.frame;
+	m_batchZbuf = state.zbuf;
+	m_renderStates.push_back(state);
+	m_renderStateDirty = false;
+}
+
+CGSH_Software::RASTERVERTEX CGSH_Software::MakeRasterVertex(const VERTEX& vertex, const XYOFFSET& offset, const RENDERSTATE& state) const
+{
+	auto position = make_convertible<XYZ>(vertex.nPosition);
+	auto rgbaq = make_convertible<RGBAQ>(vertex.nRGBAQ);
+
+	RASTERVERTEX result;
+	result.x = static_cast<int32>(position.nX) - static_cast<int32>(offset.nOffsetX);
+	result.y = static_cast<int32>(position.nY) - static_cast<int32>(offset.nOffsetY);
+	result.z = static_cast<double>(position.nZ);
+	result.r = rgbaq.nR;
+	result.g = rgbaq.nG;
+	result.b = rgbaq.nB;
+	result.a = rgbaq.nA;
+	if(state.useUV)
+	{
+		auto uv = make_convertible<UV>(vertex.nUV);
+		result.s = uv.GetU();
+		result.t = uv.GetV();
+		result.q = 1;
+	}
+	else
+	{
+		auto st = make_convertible<ST>(vertex.nST);
+		result.s = st.nS;
+		result.t = st.nT;
+		result.q = rgbaq.nQ;
+	}
+	result.fog = vertex.nFog;
+	return result;
+}
+
+void CGSH_Software::AddPrimitive(unsigned int primitiveType, unsigned int vertexCount)
+{
+	assert(!m_renderStates.empty());
+	const auto& state = m_renderStates.back();
+	auto offset = make_convertible<XYOFFSET>(m_nReg[GS_REG_XYOFFSET_1 + m_primitiveMode.nContext]);
+	auto scissor = make_convertible<SCISSOR>(state.scissor);
+
+	PRIMITIVE primitive;
+	primitive.type = primitiveType;
+	primitive.stateIndex = static_cast<uint32>(m_renderStates.size() - 1);
+
+	//Vertex buffer is filled from the end, put vertices back in the order they were kicked
+	auto& vertices = primitive.vertices;
+	for(unsigned int i = 0; i < vertexCount; i++)
+	{
+		vertices[i] = MakeRasterVertex(m_vtxBuffer[vertexCount - 1 - i], offset, state);
+	}
+
+	if(!state.gouraud)
+	{
+		//Flat shading uses the color of the last vertex
+		const auto& lastVertex = vertices[vertexCount - 1];
+		for(unsigned int i = 0; i < vertexCount - 1; i++)
+		{
+			vertices[i].r = lastVertex.r;
+			vertices[i].g = lastVertex.g;
+			vertices[i].b = lastVertex.b;
+			vertices[i].a = lastVertex.a;
+		}
+	}
+
+	int32 minX = INT32_MAX, minY = INT32_MAX, maxX = INT32_MIN, maxY = INT32_MIN;
+	for(unsigned int i = 0; i < vertexCount; i++)
+	{
+		minX = std::min(minX, vertices[i].x);
+		minY = std::min(minY, vertices[i].y);
+		maxX = std::max(maxX, vertices[i].x);
+		maxY = std::max(maxY, vertices[i].y);
+	}
+
+	switch(primitiveType)
+	{
+	case PRIM_POINT:
+	case PRIM_LINE:
+		primitive.minX = (minX + 8) >> 4;
+		primitive.minY = (minY + 8) >> 4;
+		primitive.maxX = (maxX + 8) >> 4;
+		primitive.maxY = (maxY + 8) >> 4;
+		break;
+	case PRIM_TRIANGLE:
+		{
+			int64 area = EdgeFunction(vertices[0].x, vertices[0].y, vertices[1].x, vertices[1].y, vertices[2].x, vertices[2].y);
+			if(area == 0) return;
+			if(area < 0)
+			{
+				std::swap(vertices[1], vertices[2]);
+			}
+			primitive.minX = (minX + 15) >> 4;
+			primitive.minY = (minY + 15) >> 4;
+			primitive.maxX = maxX >> 4;
+			primitive.maxY = maxY >> 4;
+		}
+		break;
+	case PRIM_SPRITE:
+		//Right and bottom edges are excluded
+		primitive.minX = (minX + 15) >> 4;
+		primitive.minY = (minY + 15) >> 4;
+		primitive.maxX = ((maxX + 15) >> 4) - 1;
+		primitive.maxY = ((maxY + 15) >> 4) - 1;
+		break;
+	}
+
+	primitive.minX = std::max<int32>(primitive.minX, scissor.scax0);
+	primitive.minY = std::max<int32>(primitive.minY, scissor.scay0);
+	primitive.maxX = std::min<int32>(primitive.maxX, std::min<int32>(scissor.scax1, MAX_COORD - 1));
+	primitive.maxY = std::min<int32>(primitive.maxY, std::min<int32>(scissor.scay1, MAX_COORD - 1));
+	if((primitive.minX > primitive.maxX) || (primitive.minY > primitive.maxY)) return;
+
+	m_primitives.push_back(primitive);
+	m_batchMaxY = std::max(m_batchMaxY, primitive.maxY);
+	if(m_primitives.size() >= MAX_BATCH_PRIMITIVE_COUNT)
+	{
+		FlushPrimitives();
+	}
+}
+
+void CGSH_Software::FlushPrimitives()
+{
+	if(m_primitives.empty()) return;
+	assert(!m_workerThreads.empty());
+
+	{
+		std::lock_guard<std::mutex> workerLock(m_workerMutex);
+		m_pendingWorkerCount = static_cast<unsigned int>(m_workerThreads.size());
+		m_batchId++;
+	}
+	m_workerCondition.notify_all();
+
+	{
+		std::unique_lock<std::mutex> workerLock(m_workerMutex);
+		m_batchDoneCondition.wait(workerLock, [this] () { return m_pendingWorkerCount == 0; });
+	}
+
+	DiscardPrimitives();
+	m_drawCallCount++;
+}
+
+void CGSH_Software::DiscardPrimitives()
+{
+	m_primitives.clear();
+	m_renderStates.clear();
+	m_batchMaxY = 0;
+	m_renderStateDirty = true;
+}
+
+bool CGSH_Software::IsBatchWritingTo(uint32 address, uint32 size) const
+{
+	if(m_primitives.empty()) return false;
+
+	auto frame = make_convertible<FRAME>(m_batchFrame);
+	auto zbuf = make_convertible<ZBUF>(m_batchZbuf);
+
+	auto overlaps =
+		[&] (uint32 targetAddress, unsigned int targetPsm)
+		{
+			auto pageSize = CGsPixelFormats::GetPsmPageSize(targetPsm);
+			uint32 pageCountX = std::max<uint32>(frame.GetWidth() / pageSize.first, 1);
+			uint32 targetSize = ((m_batchMaxY / pageSize.second) + 1) * pageCountX * CGsPixelFormats::PAGESIZE;
+			return (((address - targetAddress) & (RAMSIZE - 1)) < targetSize) ||
+				(((targetAddress - address) & (RAMSIZE - 1)) < size);
+		};
+
+	return overlaps(frame.GetBasePtr(), frame.nPsm) || overlaps(zbuf.GetBasePtr(), zbuf.nPsm | 0x30);
+}
+
+void CGSH_Software::WorkerThreadProc(unsigned int workerIndex)
+{
+	uint32 batchId = 0;
+	while(1)
+	{
+		{
+			std::unique_lock<std::mutex> workerLock(m_workerMutex);
+			m_workerCondition.wait(workerLock, [&] () { return m_workersDone || (m_batchId != batchId); });
+			if(m_workersDone) break;
+			batchId = m_batchId;
+		}
+
+		DrawPrimitives(workerIndex);
+
+		{
+			std::lock_guard<std::mutex> workerLock(m_workerMutex);
+			m_pendingWorkerCount--;
+		}
+		m_batchDoneCondition.notify_one();
+	}
+}
+
+void CGSH_Software::DrawPrimitives(unsigned int workerIndex)
+{
+	unsigned int workerCount = static_cast<unsigned int>(m_workerThreads.size());
+	for(const auto& primitive : m_primitives)
+	{
+		DRAWCONTEXT context(m_pRAM, m_renderStates[primitive.stateIndex]);
+		for(int32 tileY = primitive.minY / TILE_SIZE; tileY <= primitive.maxY / TILE_SIZE; tileY++)
+		{
+			for(int32 tileX = primitive.minX / TILE_SIZE; tileX <= primitive.maxX / TILE_SIZE; tileX++)
+			{
+				//Tiles are always drawn by the same worker, which keeps primitive order within each tile
+				if(((tileX + tileY) % workerCount) != workerIndex) continue;
+				int32 x0 = std::max<int32>(primitive.minX, tileX * TILE_SIZE);
+				int32 y0 = std::max<int32>(primitive.minY, tileY * TILE_SIZE);
+				int32 x1 = std::min<int32>(primitive.maxX, (tileX * TILE_SIZE) + TILE_SIZE - 1);
+				int32 y1 = std::min<int32>(primitive.maxY, (tileY * TILE_SIZE) + TILE_SIZE - 1);
+				switch(primitive.type)
+				{
+				case PRIM_POINT:
+					DrawPoint(context, primitive, x0, y0, x1, y1);
+					break;
+				case PRIM_LINE:
+					DrawLine(context, primitive, x0, y0, x1, y1);
+					break;
+				case PRIM_TRIANGLE:
+					DrawTriangle(context, primitive, x0, y0, x1, y1);
+					break;
+				case PRIM_SPRITE:
+					DrawSprite(context, primitive, x0, y0, x1, y1);
+					break;
+				}
+			}
+		}
+	}
+}
+
+void CGSH_Software::DrawPoint(DRAWCONTEXT& context, const PRIMITIVE& primitive, int32 x0, int32 y0, int32 x1, int32 y1)
+{
+	const auto& v = primitive.vertices[0];
+	int32 x = (v.x + 8) >> 4;
+	int32 y = (v.y + 8) >> 4;
+	if((x < x0) || (x > x1) || (y < y0) || (y > y1)) return;
+	DrawPixel(context, x, y, v.z, v.r, v.g, v.b, v.a, v.s, v.t, v.q, v.fog);
+}
+
+void CGSH_Software::DrawLine(DRAWCONTEXT& context, const PRIMITIVE& primitive, int32 x0, int32 y0, int32 x1, int32 y1)
+{
+	const auto& v0 = primitive.vertices[0];
+	const auto& v1 = primitive.vertices[1];
+	int32 dx = v1.x - v0.x;
+	int32 dy = v1.y - v0.y;
+	int32 stepCount = std::max(std::abs(dx), std::abs(dy)) >> 4;
+	if(stepCount == 0) stepCount = 1;
+
+	//Last pixel of the line is not drawn
+	for(int32 i = 0; i < stepCount; i++)
+	{
+		int32 x = (v0.x + ((dx * i) / stepCount) + 8) >> 4;
+		int32 y = (v0.y + ((dy * i) / stepCount) + 8) >> 4;
+		if((x < x0) || (x > x1) || (y < y0) || (y > y1)) continue;
+		float f = static_cast<float>(i) / static_cast<float>(stepCount);
+		DrawPixel(context, x, y, v0.z + ((v1.z - v0.z) * f),
+			Lerp(v0.r, v1.r, f), Lerp(v0.g, v1.g, f), Lerp(v0.b, v1.b, f), Lerp(v0.a, v1.a, f),
+			Lerp(v0.s, v1.s, f), Lerp(v0.t, v1.t, f), Lerp(v0.q, v1.q, f), Lerp(v0.fog, v1.fog, f));
+	}
+}
+
+void CGSH_Software::DrawTriangle(DRAWCONTEXT& context, const PRIMITIVE& primitive, int32 x0, int32 y0, int32 x1, int32 y1)
+{
+	const auto& v0 = primitive.vertices[0];
+	const auto& v1 = primitive.vertices[1];
+	const auto& v2 = primitive.vertices[2];
+
+	int64 area = EdgeFunction(v0.x, v0.y, v1.x, v1.y, v2.x, v2.y);
+	assert(area > 0);
+	double invArea = 1.0 / static_cast<double>(area);
+
+	//Top-left fill rule: pixels right on an edge are only drawn if it's a top or a left edge
+	const RASTERVERTEX* edges[3][2] = { { &v1, &v2 }, { &v2, &v0 }, { &v0, &v1 } };
+	int64 biases[3];
+	int64 stepsX[3];
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		int32 dx = edges[i][1]->x - edges[i][0]->x;
+		int32 dy = edges[i][1]->y - edges[i][0]->y;
+		bool topLeft = (dy < 0) || ((dy == 0) && (dx > 0));
+		biases[i] = topLeft ? 0 : -1;
+		stepsX[i] = -static_cast<int64>(dy) * 16;
+	}
+
+	for(int32 y = y0; y <= y1; y++)
+	{
+		int64 weights[3];
+		for(unsigned int i = 0; i < 3; i++)
+		{
+			weights[i] = EdgeFunction(edges[i][0]->x, edges[i][0]->y, edges[i][1]->x, edges[i][1]->y, x0 * 16, y * 16);
+		}
+		for(int32 x = x0; x <= x1; x++)
+		{
+			if(((weights[0] + biases[0]) >= 0) && ((weights[1] + biases[1]) >= 0) && ((weights[2] + biases[2]) >= 0))
+			{
+				double l0 = static_cast<double>(weights[0]) * invArea;
+				double l1 = static_cast<double>(weights[1]) * invArea;
+				double l2 = static_cast<double>(weights[2]) * invArea;
+				float f0 = static_cast<float>(l0);
+				float f1 = static_cast<float>(l1);
+				float f2 = static_cast<float>(l2);
+				DrawPixel(context, x, y, (v0.z * l0) + (v1.z * l1) + (v2.z * l2),
+					(v0.r * f0) + (v1.r * f1) + (v2.r * f2),
+					(v0.g * f0) + (v1.g * f1) + (v2.g * f2),
+					(v0.b * f0) + (v1.b * f1) + (v2.b * f2),
+					(v0.a * f0) + (v1.a * f1) + (v2.a * f2),
+					(v0.s * f0) + (v1.s * f1) + (v2.s * f2),
+					(v0.t * f0) + (v1.t * f1) + (v2.t * f2),
+					(v0.q * f0) + (v1.q * f1) + (v2.q * f2),
+					(v0.fog * f0) + (v1.fog * f1) + (v2.fog * f2));
+			}
+			weights[0] += stepsX[0];
+			weights[1] += stepsX[1];
+			weights[2] += stepsX[2];
+		}
+	}
+}
+
+void CGSH_Software::DrawSprite(DRAWCONTEXT& context, const PRIMITIVE& primitive, int32 x0, int32 y0, int32 x1, int32 y1)
+{
+	const auto& v0 = primitive.vertices[0];
+	const auto& v1 = primitive.vertices[1];
+
+	//Texture coordinates are interpolated linearly between both corners, everything else comes from the second vertex
+	float s0 = v0.s, t0 = v0.t, s1 = v1.s, t1 = v1.t;
+	if(!context.state.useUV)
+	{
+		float invQ0 = (v0.q != 0) ? (1.0f / v0.q) : 0;
+		float invQ1 = (v1.q != 0) ? (1.0f / v1.q) : 0;
+		s0 *= invQ0; t0 *= invQ0;
+		s1 *= invQ1; t1 *= invQ1;
+	}
+
+	float spanX = static_cast<float>(v1.x - v0.x);
+	float spanY = static_cast<float>(v1.y - v0.y);
+
+	for(int32 y = y0; y <= y1; y++)
+	{
+		float fy = (spanY != 0) ? (static_cast<float>((y * 16) - v0.y) / spanY) : 0;
+		float t = Lerp(t0, t1, fy);
+		for(int32 x = x0; x <= x1; x++)
+		{
+			float fx = (spanX != 0) ? (static_cast<float>((x * 16) - v0.x) / spanX) : 0;
+			float s = Lerp(s0, s1, fx);
+			DrawPixel(context, x, y, v1.z, v1.r, v1.g, v1.b, v1.a, s, t, 1, v1.fog);
+		}
+	}
+}
+
+void CGSH_Software::DrawPixel(DRAWCONTEXT& context, int32 x, int32 y, double z, float r, float g, float b, float a, float s, float t, float q, float fog)
+{
+	const auto& state = context.state;
+
+	int32 color[4] =
+	{
+		static_cast<int32>(r + 0.5f),
+		static_cast<int32>(g + 0.5f),
+		static_cast<int32>(b + 0.5f),
+		static_cast<int32>(a + 0.5f),
+	};
+
+	if(state.textured)
+	{
+		float u = s;
+		float v = t;
+		if(!state.useUV)
+		{
+			float invQ = (q != 0) ? (1.0f / q) : 0;
+			u *= invQ * static_cast<float>(context.texWidth);
+			v *= invQ * static_cast<float>(context.texHeight);
+		}
+		uint32 texel = FetchTexel(context, u, v);
+		int32 texelColor[4] =
+		{
+			static_cast<int32>((texel >>  0) & 0xFF),
+			static_cast<int32>((texel >>  8) & 0xFF),
+			static_cast<int32>((texel >> 16) & 0xFF),
+			static_cast<int32>((texel >> 24) & 0xFF),
+		};
+		bool useTexelAlpha = context.tex0.nColorComp != 0;
+		switch(context.tex0.nFunction)
+		{
+		case TEX0_FUNCTION_MODULATE:
+			for(unsigned int i = 0; i < 3; i++) color[i] = (texelColor[i] * color[i]) >> 7;
+			if(useTexelAlpha) color[3] = (texelColor[3] * color[3]) >> 7;
+			break;
+		case TEX0_FUNCTION_DECAL:
+			for(unsigned int i = 0; i < 3; i++) color[i] = texelColor[i];
+			if(useTexelAlpha) color[3] = texelColor[3];
+			break;
+		case TEX0_FUNCTION_HIGHLIGHT:
+			for(unsigned int i = 0; i < 3; i++) color[i] = ((texelColor[i] * color[i]) >> 7) + color[3];
+			if(useTexelAlpha) color[3] += texelColor[3];
+			break;
+		case TEX0_FUNCTION_HIGHLIGHT2:
+			for(unsigned int i = 0; i < 3; i++) color[i] = ((texelColor[i] * color[i]) >> 7) + color[3];
+			if(useTexelAlpha) color[3] = texelColor[3];
+			break;
+		}
+		for(unsigned int i = 0; i < 4; i++) color[i] = std::min<int32>(color[i], 0xFF);
+	}
+
+	if(state.fogged)
+	{
+		int32 fogFactor = static_cast<int32>(fog + 0.5f);
+		for(unsigned int i = 0; i < 3; i++)
+		{
+			color[i] = ((fogFactor * color[i]) + ((0xFF - fogFactor) * context.fogColor[i])) >> 8;
+		}
+	}
+
+	bool writeFrame = true;
+	bool writeAlpha = true;
+	bool writeDepth = (context.zbuf.nMask == 0);
+
+	const auto& test = context.test;
+	if(test.nAlphaEnabled)
+	{
+		bool alphaPassed = true;
+		int32 alphaRef = test.nAlphaRef;
+		switch(test.nAlphaMethod)
+		{
+		case ALPHA_TEST_NEVER:		alphaPassed = false;					break;
+		case ALPHA_TEST_ALWAYS:		alphaPassed = true;						break;
+		case ALPHA_TEST_LESS:		alphaPassed = (color[3] <  alphaRef);	break;
+		case ALPHA_TEST_LEQUAL:		alphaPassed = (color[3] <= alphaRef);	break;
+		case ALPHA_TEST_EQUAL:		alphaPassed = (color[3] == alphaRef);	break;
+		case ALPHA_TEST_GEQUAL:		alphaPassed = (color[3] >= alphaRef);	break;
+		case ALPHA_TEST_GREATER:	alphaPassed = (color[3] >  alphaRef);	break;
+		case ALPHA_TEST_NOTEQUAL:	alphaPassed = (color[3] != alphaRef);	break;
+		}
+		if(!alphaPassed)
+		{
+			switch(test.nAlphaFail)
+			{
+			case ALPHA_TEST_FAIL_KEEP:
+				return;
+			case ALPHA_TEST_FAIL_FBONLY:
+				writeDepth = false;
+				break;
+			case ALPHA_TEST_FAIL_ZBONLY:
+				writeFrame = false;
+				break;
+			case ALPHA_TEST_FAIL_RGBONLY:
+				writeAlpha = false;
+				writeDepth = false;
+				break;
+			}
+		}
+	}
+
+	//Fetch destination
+	uint32* framePixel32 = nullptr;
+	uint16* framePixel16 = nullptr;
+	uint32 dstColor = 0;
+	switch(context.frame.nPsm)
+	{
+	case PSMCT32:
+		framePixel32 = context.frame32.GetPixelAddress(x, y);
+		dstColor = *framePixel32;
+		break;
+	case PSMCT24:
+	case PSMCT24_UNK:
+		framePixel32 = context.frame32.GetPixelAddress(x, y);
+		dstColor = (*framePixel32 & 0x00FFFFFF) | 0x80000000;
+		break;
+	case PSMCT16:
+		framePixel16 = context.frame16.GetPixelAddress(x, y);
+		dstColor = RGBA16ToRGBA32(*framePixel16);
+		break;
+	case PSMCT16S:
+		framePixel16 = context.frame16S.GetPixelAddress(x, y);
+		dstColor = RGBA16ToRGBA32(*framePixel16);
+		break;
+	default:
+		return;
+	}
+
+	if(test.nDestAlphaEnabled && (context.frame.nPsm != PSMCT24))
+	{
+		uint32 dstAlphaBit = (dstColor >> 31) & 1;
+		if(dstAlphaBit != test.nDestAlphaMode) return;
+	}
+
+	//Depth test
+	uint32* depthPixel32 = nullptr;
+	uint16* depthPixel16 = nullptr;
+	uint32 depthMask = 0xFFFFFFFF;
+	switch(context.zbuf.nPsm)
+	{
+	case (PSMZ32 & 0x0F):
+		depthPixel32 = context.depth32.GetPixelAddress(x, y);
+		break;
+	case (PSMZ24 & 0x0F):
+		depthPixel32 = context.depth32.GetPixelAddress(x, y);
+		depthMask = 0x00FFFFFF;
+		break;
+	case (PSMZ16 & 0x0F):
+		depthPixel16 = context.depth16.GetPixelAddress(x, y);
+		depthMask = 0xFFFF;
+		break;
+	case (PSMZ16S & 0x0F):
+		depthPixel16 = context.depth16S.GetPixelAddress(x, y);
+		depthMask = 0xFFFF;
+		break;
+	}
+
+	uint32 depth = static_cast<uint32>(std::min<double>(std::max<double>(z, 0), depthMask));
+	if(test.nDepthEnabled && (depthPixel32 || depthPixel16))
+	{
+		uint32 dstDepth = depthPixel32 ? (*depthPixel32 & depthMask) : *depthPixel16;
+		switch(test.nDepthMethod)
+		{
+		case 0:
+			return;
+		case 1:
+			break;
+		case 2:
+			if(depth < dstDepth) return;
+			break;
+		case 3:
+			if(depth <= dstDepth) return;
+			break;
+		}
+	}
+
+	if(writeFrame)
+	{
+		if(state.blended && !(state.pabe && (color[3] < 0x80)))
+		{
+			int32 dst[4] =
+			{
+				static_cast<int32>((dstColor >>  0) & 0xFF),
+				static_cast<int32>((dstColor >>  8) & 0xFF),
+				static_cast<int32>((dstColor >> 16) & 0xFF),
+				static_cast<int32>((dstColor >> 24) & 0xFF),
+			};
+			const auto& alpha = context.alpha;
+			const int32 zero[4] = { 0, 0, 0, 0 };
+			const int32* colorSources[3] = { color, dst, zero };
+			const int32* sourceA = colorSources[std::min<unsigned int>(alpha.nA, 2)];
+			const int32* sourceB = colorSources[std::min<unsigned int>(alpha.nB, 2)];
+			const int32* sourceD = colorSources[std::min<unsigned int>(alpha.nD, 2)];
+			int32 factor = (alpha.nC == ALPHABLEND_C_AS) ? color[3] : (alpha.nC == ALPHABLEND_C_AD) ? dst[3] : static_cast<int32>(alpha.nFix);
+			for(unsigned int i = 0; i < 3; i++)
+			{
+				color[i] = (((sourceA[i] - sourceB[i]) * factor) >> 7) + sourceD[i];
+			}
+		}
+
+		for(unsigned int i = 0; i < 3; i++)
+		{
+			color[i] = state.colClamp ? std::min<int32>(std::max<int32>(color[i], 0), 0xFF) : (color[i] & 0xFF);
+		}
+		if(state.fba) color[3] |= 0x80;
+
+		uint32 srcColor = color[0] | (color[1] << 8) | (color[2] << 16) | (color[3] << 24);
+		uint32 writeMask = context.frame.nMask;
+		if(!writeAlpha) writeMask |= 0xFF000000;
+		if(framePixel32)
+		{
+			if(context.frame.nPsm != PSMCT32) writeMask |= 0xFF000000;
+			*framePixel32 = (*framePixel32 & writeMask) | (srcColor & ~writeMask);
+		}
+		else
+		{
+			uint16 writeMask16 = RGBA32ToRGBA16(writeMask);
+			*framePixel16 = (*framePixel16 & writeMask16) | (RGBA32ToRGBA16(srcColor) & ~writeMask16);
+		}
+	}
+
+	if(writeDepth)
+	{
+		if(depthPixel32)
+		{
+			*depthPixel32 = (*depthPixel32 & ~depthMask) | depth;
+		}
+		else if(depthPixel16)
+		{
+			*depthPixel16 = static_cast<uint16>(depth);
+		}
+	}
+}
+
+uint32 CGSH_Software::FetchTexel(DRAWCONTEXT& context, float u, float v)
+{
+	auto& clamp = context.clamp;
+	auto& tex0 = context.tex0;
+	int32 texelX = ClampTexCoord(clamp.nWMS, static_cast<int32>(std::floor(u)), context.texWidth, clamp.GetMinU(), clamp.GetMaxU());
+	int32 texelY = ClampTexCoord(clamp.nWMT, static_cast<int32>(std::floor(v)), context.texHeight, clamp.GetMinV(), clamp.GetMaxV());
+	texelX &= (MAX_COORD - 1);
+	texelY &= (MAX_COORD - 1);
+
+	const auto& clut = context.state.clut;
+	switch(tex0.nPsm)
+	{
+	case PSMCT32:
+		return context.texture32.GetPixel(texelX, texelY);
+	case PSMCT24:
+	case PSMCT24_UNK:
+		return ExpandAlpha(context.texture32.GetPixel(texelX, texelY), false, context.texa);
+	case PSMCT16:
+		return ExpandAlpha(RGBA16ToRGBA32(context.texture16.GetPixel(texelX, texelY)), true, context.texa);
+	case PSMCT16S:
+		return ExpandAlpha(RGBA16ToRGBA32(context.texture16S.GetPixel(texelX, texelY)), true, context.texa);
+	case PSMT8:
+		return clut[context.texture8.GetPixel(texelX, texelY)];
+	case PSMT4:
+		return clut[context.texture4.GetPixel(texelX, texelY)];
+	case PSMT8H:
+		return clut[context.texture32.GetPixel(texelX, texelY) >> 24];
+	case PSMT4HL:
+		return clut[(context.texture32.GetPixel(texelX, texelY) >> 24) & 0x0F];
+	case PSMT4HH:
+		return clut[context.texture32.GetPixel(texelX, texelY) >> 28];
+	default:
+		return 0;
+	}
+}
+
+void CGSH_Software::ProcessHostToLocalTransfer()
+{
+	//Data has already been written to GS memory
+}
+
+void CGSH_Software::ProcessLocalToHostTransfer()
+{
+	//Data is read straight from GS memory
+}
+
+template <typename Storage>
+void CGSH_Software::CopyLocalToLocal()
+{
+	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+	auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+
+	CGsPixelFormats::CPixelIndexor<Storage> srcIndexor(m_pRAM, bltBuf.GetSrcPtr(), bltBuf.nSrcWidth);
+	CGsPixelFormats::CPixelIndexor<Storage> dstIndexor(m_pRAM, bltBuf.GetDstPtr(), bltBuf.nDstWidth);
+
+	//Go through a temporary buffer in case both areas overlap
+	std::vector<typename Storage::Unit> pixels(trxReg.nRRW * trxReg.nRRH);
+	auto pixel = pixels.begin();
+	for(uint32 y = 0; y < trxReg.nRRH; y++)
+	{
+		for(uint32 x = 0; x < trxReg.nRRW; x++)
+		{
+			*pixel++ = srcIndexor.GetPixel((trxPos.nSSAX + x) % MAX_COORD, (trxPos.nSSAY + y) % MAX_COORD);
+		}
+	}
+	pixel = pixels.begin();
+	for(uint32 y = 0; y < trxReg.nRRH; y++)
+	{
+		for(uint32 x = 0; x < trxReg.nRRW; x++)
+		{
+			dstIndexor.SetPixel((trxPos.nDSAX + x) % MAX_COORD, (trxPos.nDSAY + y) % MAX_COORD, *pixel++);
+		}
+	}
+}
+
+void CGSH_Software::ProcessLocalToLocalTransfer()
+{
+	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+	if(bltBuf.nSrcPsm != bltBuf.nDstPsm) return;
+
+	switch(bltBuf.nSrcPsm)
+	{
+	case PSMCT32:
+	case PSMCT24:
+	case PSMZ32:
+	case PSMZ24:
+		CopyLocalToLocal<CGsPixelFormats::STORAGEPSMCT32>();
+		break;
+	case PSMCT16:
+	case PSMZ16:
+		CopyLocalToLocal<CGsPixelFormats::STORAGEPSMCT16>();
+		break;
+	case PSMCT16S:
+	case PSMZ16S:
+		CopyLocalToLocal<CGsPixelFormats::STORAGEPSMCT16S>();
+		break;
+	case PSMT8:
+		CopyLocalToLocal<CGsPixelFormats::STORAGEPSMT8>();
+		break;
+	case PSMT4:
+		CopyLocalToLocal<CGsPixelFormats::STORAGEPSMT4>();
+		break;
+	}
+}
+
+void CGSH_Software::ProcessClutTransfer(uint32, uint32)
+{
+	//CLUT is copied when render states are captured
+}
+
+void CGSH_Software::SaveState(Framework::CZipArchiveWriter& archive, bool includeRam)
+{
+	//Batches can span several packets, draw what's pending before GS memory is saved
+	SendGSCall([this] () { FlushPrimitives(); }, true);
+	CGSHandler::SaveState(archive, includeRam);
+}
+
+void CGSH_Software::LoadState(Framework::CZipArchiveReader& archive, bool includeRam)
+{
+	//Pending primitives belong to the state being replaced, GS memory might have been restored already
+	SendGSCall([this] () { DiscardPrimitives(); }, true);
+	CGSHandler::LoadState(archive, includeRam);
+}
+
+void CGSH_Software::ReadFramebuffer(uint32 width, uint32 height, void* buffer)
+{
+	SendGSCall([&] () { ReadFramebufferImpl(width, height, reinterpret_cast<uint8*>(buffer)); }, true);
+}
+
+void CGSH_Software::ReadFramebufferImpl(uint32 width, uint32 height, uint8* buffer)
+{
+	FlushPrimitives();
+
+	DISPLAY d;
+	DISPFB fb;
+	{
+		std::lock_guard<std::recursive_mutex> registerMutexLock(m_registerMutex);
+		bool useCircuit2 = !(m_nPMODE & 0x1) && (m_nPMODE & 0x2);
+		d <<= useCircuit2 ? m_nDISPLAY2.value.q : m_nDISPLAY1.value.q;
+		fb <<= useCircuit2 ? m_nDISPFB2.value.q : m_nDISPFB1.value.q;
+	}
+
+	uint32 dispWidth = (d.nW + 1) / (d.nMagX + 1);
+	uint32 dispHeight = (d.nH + 1);
+	if(GetCrtIsInterlaced() && GetCrtIsFrameMode()) dispHeight /= 2;
+
+	CGsPixelFormats::CPixelIndexorPSMCT32 indexor32(m_pRAM, fb.GetBufPtr(), fb.nBufWidth);
+	CGsPixelFormats::CPixelIndexorPSMCT16 indexor16(m_pRAM, fb.GetBufPtr(), fb.nBufWidth);
+	CGsPixelFormats::CPixelIndexorPSMCT16S indexor16S(m_pRAM, fb.GetBufPtr(), fb.nBufWidth);
+
+	//Output is BGR, bottom-up
+	for(uint32 y = 0; y < height; y++)
+	{
+		uint8* row = buffer + ((height - 1 - y) * width * 3);
+		uint32 srcY = (fb.nY + ((y * dispHeight) / height)) % MAX_COORD;
+		for(uint32 x = 0; x < width; x++)
+		{
+			uint32 srcX = (fb.nX + ((x * dispWidth) / width)) % MAX_COORD;
+			uint32 color = 0;
+			switch(fb.nPSM)
+			{
+			case PSMCT32:
+			case PSMCT24:
+				color = indexor32.GetPixel(srcX, srcY);
+				break;
+			case PSMCT16:
+				color = RGBA16ToRGBA32(indexor16.GetPixel(srcX, srcY));
+				break;
+			case PSMCT16S:
+				color = RGBA16ToRGBA32(indexor16S.GetPixel(srcX, srcY));
+				break;
+			}
+			row[(x * 3) + 0] = static_cast<uint8>(color >> 16);
+			row[(x * 3) + 1] = static_cast<uint8>(color >> 8);
+			row[(x * 3) + 2] = static_cast<uint8>(color >> 0);
+		}
+	}
+}
+
+CGSHandler::FactoryFunction CGSH_Software::GetFactoryFunction()
+{
+	return std::bind(&CGSH_Software::GSHandlerFactory);
+}
+
+CGSHandler* CGSH_Software::GSHandlerFactory()
+{
+	return new CGSH_Software();
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "GSHandler.h"
+
+//Renders into GS memory on the CPU. Primitives are accumulated on the GS thread and drawn
+//in batches by a pool of workers, each one owning a fixed set of screen tiles.
+class CGSH_Software : public CGSHandler
+{
+public:
+								CGSH_Software();
+	virtual						~CGSH_Software();
+
+	virtual void				ProcessHostToLocalTransfer() override;
+	virtual void				ProcessLocalToHostTransfer() override;
+	virtual void				ProcessLocalToLocalTransfer() override;
+	virtual void				ProcessClutTransfer(uint32, uint32) override;
+	virtual void				ReadFramebuffer(uint32, uint32, void*) override;
+
+	virtual void				SaveState(Framework::CZipArchiveWriter&, bool = true) override;
+	virtual void				LoadState(Framework::CZipArchiveReader&, bool = true) override;
+
+	static FactoryFunction		GetFactoryFunction();
+
+protected:
+	virtual void				ResetImpl() override;
+	virtual void				FlipImpl() override;
+	virtual void				MarkNewFrame() override;
+	virtual void				WriteRegisterImpl(uint8, uint64) override;
+
+private:
+	enum
+	{
+		TILE_SIZE = 64,
+		MAX_COORD = 2048,
+		MAX_WORKER_COUNT = 16,
+		MAX_BATCH_PRIMITIVE_COUNT = 0x2000,
+	};
+
+	struct VERTEX
+	{
+		uint64						nPosition;
+		uint64						nRGBAQ;
+		uint64						nUV;
+		uint64						nST;
+		uint8						nFog;
+	};
+
+	//Context registers captured when a primitive is kicked
+	struct RENDERSTATE
+	{
+		bool						gouraud;
+		bool						textured;
+		bool						fogged;
+		bool						blended;
+		bool						useUV;
+		bool						pabe;
+		bool						fba;
+		bool						colClamp;
+		uint64						frame;
+		uint64						zbuf;
+		uint64						test;
+		uint64						alpha;
+		uint64						tex0;
+		uint64						clamp;
+		uint64						texa;
+		uint64						scissor;
+		uint64						fogCol;
+		std::array<uint32, 256>		clut;
+	};
+
+	struct RASTERVERTEX
+	{
+		int32						x;
+		int32						y;
+		double						z;
+		float						r;
+		float						g;
+		float						b;
+		float						a;
+		float						s;
+		float						t;
+		float						q;
+		float						fog;
+	};
+
+	struct PRIMITIVE
+	{
+		unsigned int				type;
+		uint32						stateIndex;
+		int32						minX;
+		int32						minY;
+		int32						maxX;
+		int32						maxY;
+		RASTERVERTEX				vertices[3];
+	};
+
+	struct DRAWCONTEXT;
+
+	virtual void				InitializeImpl() override;
+	virtual void				ReleaseImpl() override;
+
+	void						VertexKick(uint8, uint64);
+	void						SetRenderState(const PRMODE&);
+	void						AddPrimitive(unsigned int, unsigned int);
+	RASTERVERTEX				MakeRasterVertex(const VERTEX&, const XYOFFSET&, const RENDERSTATE&) const;
+
+	void						FlushPrimitives();
+	void						DiscardPrimitives();
+	bool						IsBatchWritingTo(uint32, uint32) const;
+	void						WorkerThreadProc(unsigned int);
+	void						DrawPrimitives(unsigned int);
+
+	void						DrawPoint(DRAWCONTEXT&, const PRIMITIVE&, int32, int32, int32, int32);
+	void						DrawLine(DRAWCONTEXT&, const PRIMITIVE&, int32, int32, int32, int32);
+	void						DrawTriangle(DRAWCONTEXT&, const PRIMITIVE&, int32, int32, int32, int32);
+	void						DrawSprite(DRAWCONTEXT&, const PRIMITIVE&, int32, int32, int32, int32);
+	void						DrawPixel(DRAWCONTEXT&, int32, int32, double, float, float, float, float, float, float, float, float);
+
+	uint32						FetchTexel(DRAWCONTEXT&, float, float);
+	void						ReadFramebufferImpl(uint32, uint32, uint8*);
+
+	template <typename Storage> void	CopyLocalToLocal();
+
+	static CGSHandler*			GSHandlerFactory();
+
+	VERTEX						m_vtxBuffer[3];
+	int							m_vtxCount = 0;
+	unsigned int				m_primitiveType = PRIM_INVALID;
+	PRMODE						m_primitiveMode;
+
+	bool						m_renderStateDirty = true;
+	std::vector<RENDERSTATE>	m_renderStates;
+	std::vector<PRIMITIVE>		m_primitives;
+	uint64						m_batchFrame = 0;
+	uint64						m_batchZbuf = 0;
+	int32						m_batchMaxY = 0;
+
+	std::vector<std::thread>	m_workerThreads;
+	std::mutex					m_workerMutex;
+	std::condition_variable		m_workerCondition;
+	std::condition_variable		m_batchDoneCondition;
+	uint32						m_batchId = 0;
+	unsigned int				m_pendingWorkerCount = 0;
+	bool						m_workersDone = false;
+};
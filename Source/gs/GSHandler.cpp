@@ -1,7 +1,6 @@
 #include <stdio.h>
 #include <string.h>
 #include <functional>
-#include <boost/scoped_array.hpp>
 #include "../AppConfig.h"
 #include "../Log.h"
 #include "../MemoryStateFile.h"
@@ -67,6 +66,7 @@ CGSHandler::CGSHandler()
 , m_pRAM(nullptr)
 , m_frameDump(nullptr)
 , m_loggingEnabled(true)
+, m_commandRing(COMMAND_RING_SIZE)
 {
 	RegisterPreferences();
 	
@@ -116,13 +116,13 @@ void CGSHandler::RegisterPreferences()
 
 void CGSHandler::NotifyPreferencesChanged()
 {
-	m_mailBox.SendCall([this] () { NotifyPreferencesChangedImpl(); });
+	SendGSCall([this] () { NotifyPreferencesChangedImpl(); });
 }
 
 void CGSHandler::Reset()
 {
 	ResetBase();
-	m_mailBox.SendCall(std::bind(&CGSHandler::ResetImpl, this), true);
+	SendGSCall(std::bind(&CGSHandler::ResetImpl, this), true);
 }
 
 void CGSHandler::ResetBase()
@@ -165,9 +165,12 @@ void CGSHandler::SetPresentationParams(const PRESENTATION_PARAMS& presentationPa
 	m_presentationParams = presentationParams;
 }
 
-void CGSHandler::SaveState(Framework::CZipArchiveWriter& archive)
+void CGSHandler::SaveState(Framework::CZipArchiveWriter& archive, bool includeRam)
 {
-	archive.InsertFile(new CMemoryStateFile(STATE_RAM,		m_pRAM,		RAMSIZE));
+	if(includeRam)
+	{
+		archive.InsertFile(new CMemoryStateFile(STATE_RAM,	m_pRAM,		RAMSIZE));
+	}
 	archive.InsertFile(new CMemoryStateFile(STATE_REGS,		m_nReg,		sizeof(uint64) * CGSHandler::REGISTER_MAX));
 	archive.InsertFile(new CMemoryStateFile(STATE_TRXCTX,	&m_trxCtx,	sizeof(TRXCONTEXT)));
 
@@ -189,9 +192,12 @@ void CGSHandler::SaveState(Framework::CZipArchiveWriter& archive)
 	}
 }
 
-void CGSHandler::LoadState(Framework::CZipArchiveReader& archive)
+void CGSHandler::LoadState(Framework::CZipArchiveReader& archive, bool includeRam)
 {
-	archive.BeginReadFile(STATE_RAM		)->Read(m_pRAM,		RAMSIZE);
+	if(includeRam)
+	{
+		archive.BeginReadFile(STATE_RAM	)->Read(m_pRAM,		RAMSIZE);
+	}
 	archive.BeginReadFile(STATE_REGS	)->Read(m_nReg,		sizeof(uint64) * 0x80);
 	archive.BeginReadFile(STATE_TRXCTX	)->Read(&m_trxCtx,	sizeof(TRXCONTEXT));
 
@@ -356,22 +362,22 @@ void CGSHandler::WritePrivRegister(uint32 nAddress, uint32 nData)
 
 void CGSHandler::Initialize()
 {
-	m_mailBox.SendCall(std::bind(&CGSHandler::InitializeImpl, this), true);
+	SendGSCall(std::bind(&CGSHandler::InitializeImpl, this), true);
 }
 
 void CGSHandler::Release()
 {
-	m_mailBox.SendCall(std::bind(&CGSHandler::ReleaseImpl, this), true);
+	SendGSCall(std::bind(&CGSHandler::ReleaseImpl, this), true);
 }
 
 void CGSHandler::Flip(bool showOnly)
 {
 	if(!showOnly)
 	{
-		m_mailBox.FlushCalls();
-		m_mailBox.SendCall(std::bind(&CGSHandler::MarkNewFrame, this));
+		SendGSCall([] () { }, true);
+		SendGSCall(std::bind(&CGSHandler::MarkNewFrame, this));
 	}
-	m_mailBox.SendCall(std::bind(&CGSHandler::FlipImpl, this), true);
+	SendGSCall(std::bind(&CGSHandler::FlipImpl, this), true);
 }
 
 void CGSHandler::FlipImpl()
@@ -410,24 +416,38 @@ void CGSHandler::SetSMODE2(uint64 value)
 
 void CGSHandler::WriteRegister(uint8 registerId, uint64 value)
 {
-	m_mailBox.SendCall(std::bind(&CGSHandler::WriteRegisterImpl, this, registerId, value));
+	auto write = reinterpret_cast<RegisterWrite*>(m_commandRing.BeginCommand(COMMAND_WRITEREGISTER, sizeof(RegisterWrite)));
+	write->first = registerId;
+	write->second = value;
+	SubmitCommand();
 }
 
 void CGSHandler::FeedImageData(const void* data, uint32 length)
 {
-	m_transferCount++;
+	//Big transfers are split in chunks that fit in the command ring. Chunk size is a multiple
+	//of 0x30 bytes to make sure no pixel straddles two chunks (ie.: PSMCT24 pixels are 3 bytes long)
+	uint32 maxChunkSize = ((m_commandRing.GetMaxCommandSize() - 0x10) / 0x30) * 0x30;
+	auto src = reinterpret_cast<const uint8*>(data);
+	while(length != 0)
+	{
+		uint32 chunkSize = std::min<uint32>(length, maxChunkSize);
 
-	//Allocate 0x10 more bytes to allow transfer handlers
-	//to read beyond the actual length of the buffer (ie.: PSMCT24)
-	
-	uint8* buffer = new uint8[length + 0x10];
-	memcpy(buffer, data, length);
-	m_mailBox.SendCall(std::bind(&CGSHandler::FeedImageDataImpl, this, buffer, length));
+		m_transferCount++;
+
+		//Reserve 0x10 more bytes to allow transfer handlers
+		//to read beyond the actual length of the buffer (ie.: PSMCT24)
+		auto buffer = m_commandRing.BeginCommand(COMMAND_FEEDIMAGEDATA, chunkSize + 0x10);
+		memcpy(buffer, src, chunkSize);
+		SubmitCommand();
+
+		src += chunkSize;
+		length -= chunkSize;
+	}
 }
 
 void CGSHandler::ReadImageData(void* data, uint32 length)
 {
-	m_mailBox.SendCall([this, data, length] () { ReadImageDataImpl(data, length); }, true);
+	SendGSCall([this, data, length] () { ReadImageDataImpl(data, length); }, true);
 }
 
 void CGSHandler::WriteRegisterMassively(const RegisterWrite* writeList, unsigned int count, const CGsPacketMetadata* metadata)
@@ -463,23 +483,33 @@ void CGSHandler::WriteRegisterMassively(const RegisterWrite* writeList, unsigned
 		}
 	}
 
-	m_transferCount++;
+	//Big packets are split in chunks that fit in the command ring
+	uint32 maxChunkCount = (m_commandRing.GetMaxCommandSize() - sizeof(MASSIVEWRITE_INFO)) / sizeof(RegisterWrite);
+	while(count != 0)
+	{
+		unsigned int chunkCount = std::min<unsigned int>(count, maxChunkCount);
+
+		m_transferCount++;
 
-	auto massiveWrite = reinterpret_cast<MASSIVEWRITE_INFO*>(malloc(sizeof(MASSIVEWRITE_INFO) + (count * sizeof(RegisterWrite))));
-	memcpy(massiveWrite->writes, writeList, sizeof(CGSHandler::RegisterWrite) * count);
-	massiveWrite->count = count;
+		uint32 commandSize = sizeof(MASSIVEWRITE_INFO) + (chunkCount * sizeof(RegisterWrite));
+		auto massiveWrite = reinterpret_cast<MASSIVEWRITE_INFO*>(m_commandRing.BeginCommand(COMMAND_WRITEREGISTERMASSIVELY, commandSize));
+		memcpy(massiveWrite->writes, writeList, sizeof(CGSHandler::RegisterWrite) * chunkCount);
+		massiveWrite->count = chunkCount;
 #ifdef DEBUGGER_INCLUDED
-	if(metadata != nullptr)
-	{
-		memcpy(&massiveWrite->metadata, metadata, sizeof(CGsPacketMetadata));
-	}
-	else
-	{
-		massiveWrite->metadata = CGsPacketMetadata();
-	}
+		if(metadata != nullptr)
+		{
+			memcpy(&massiveWrite->metadata, metadata, sizeof(CGsPacketMetadata));
+		}
+		else
+		{
+			massiveWrite->metadata = CGsPacketMetadata();
+		}
 #endif
-	//Bind is used here because using a lambda seems to cause problems on Android/clang
-	m_mailBox.SendCall(std::bind(&CGSHandler::WriteRegisterMassivelyImpl, this, massiveWrite));
+		SubmitCommand();
+
+		writeList += chunkCount;
+		count -= chunkCount;
+	}
 }
 
 void CGSHandler::WriteRegisterImpl(uint8 nRegister, uint64 nData)
@@ -530,8 +560,6 @@ void CGSHandler::WriteRegisterImpl(uint8 nRegister, uint64 nData)
 
 void CGSHandler::FeedImageDataImpl(const void* pData, uint32 nLength)
 {
-	boost::scoped_array<const uint8> dataPtr(reinterpret_cast<const uint8*>(pData));
-
 #ifdef DEBUGGER_INCLUDED
 	if(m_frameDump)
 	{
@@ -602,7 +630,6 @@ void CGSHandler::WriteRegisterMassivelyImpl(MASSIVEWRITE_INFO* massiveWrite)
 		WriteRegisterImpl(writeIterator->first, writeIterator->second);
 		writeIterator++;
 	}
-	free(massiveWrite);
 
 	assert(m_transferCount != 0);
 	m_transferCount--;
@@ -1647,14 +1674,83 @@ void CGSHandler::WriteToDelayedRegister(uint32 address, uint32 value, DELAYED_RE
 	}
 }
 
+void CGSHandler::SubmitCommand()
+{
+	if(m_commandRing.EndCommand())
+	{
+		//GS thread went to sleep waiting on the mailbox, wake it up
+		m_mailBox.SendCall([] () { });
+	}
+}
+
+void CGSHandler::SendGSCall(const CMailBox::FunctionType& function, bool waitForCompletion)
+{
+	//Commands written to the ring before the call was sent need to be processed before it
+	uint64 ringPosition = m_commandRing.GetWritePosition();
+	m_mailBox.SendCall(
+		[this, function, ringPosition] ()
+		{
+			ProcessCommands(ringPosition);
+			function();
+		},
+		waitForCompletion
+	);
+}
+
+bool CGSHandler::ProcessCommand()
+{
+	uint32 type = 0;
+	uint32 size = 0;
+	void* command = m_commandRing.ReadCommand(type, size);
+	if(command == nullptr) return false;
+	switch(type)
+	{
+	case COMMAND_WRITEREGISTER:
+		{
+			auto write = reinterpret_cast<const RegisterWrite*>(command);
+			WriteRegisterImpl(write->first, write->second);
+		}
+		break;
+	case COMMAND_FEEDIMAGEDATA:
+		assert(size >= 0x10);
+		FeedImageDataImpl(command, size - 0x10);
+		break;
+	case COMMAND_WRITEREGISTERMASSIVELY:
+		WriteRegisterMassivelyImpl(reinterpret_cast<MASSIVEWRITE_INFO*>(command));
+		break;
+	default:
+		assert(false);
+		break;
+	}
+	m_commandRing.ReleaseCommand();
+	return true;
+}
+
+void CGSHandler::ProcessCommands(uint64 endPosition)
+{
+	while(m_commandRing.GetReadPosition() < endPosition)
+	{
+		bool processed = ProcessCommand();
+		assert(processed);
+	}
+}
+
 void CGSHandler::ThreadProc()
 {
 	while(!m_threadDone)
 	{
-		m_mailBox.WaitForCall(100);
-		while(m_mailBox.IsPending())
+		//Calls process the commands that were sent before them, commands are processed one by one
+		//to make sure none of the ones written after a call was sent get processed before it
+		if(m_mailBox.IsPending())
 		{
 			m_mailBox.ReceiveCall();
+			continue;
+		}
+		if(ProcessCommand()) continue;
+		if(m_commandRing.BeginWait())
+		{
+			m_mailBox.WaitForCall(100);
+			m_commandRing.EndWait();
 		}
 	}
 }
@@ -10,6 +10,7 @@
 #include "Types.h"
 #include "Convertible.h"
 #include "../MailBox.h"
+#include "../CommandRing.h"
 #include "../Integer64.h"
 #include "zip/ZipArchiveWriter.h"
 #include "zip/ZipArchiveReader.h"
@@ -55,6 +56,7 @@ enum GS_REGS
 	GS_REG_SCISSOR_2	= 0x41,
 	GS_REG_ALPHA_1		= 0x42,
 	GS_REG_ALPHA_2		= 0x43,
+	GS_REG_COLCLAMP		= 0x46,
 	GS_REG_TEST_1		= 0x47,
 	GS_REG_TEST_2		= 0x48,
 	GS_REG_PABE			= 0x49,
@@ -581,8 +583,8 @@ public:
 	void									Reset();
 	void									SetPresentationParams(const PRESENTATION_PARAMS&);
 
-	virtual void							SaveState(Framework::CZipArchiveWriter&);
-	virtual void							LoadState(Framework::CZipArchiveReader&);
+	virtual void							SaveState(Framework::CZipArchiveWriter&, bool = true);
+	virtual void							LoadState(Framework::CZipArchiveReader&, bool = true);
 
 	void									SetFrameDump(CFrameDump*);
 
@@ -644,6 +646,18 @@ protected:
 		CLUTENTRYCOUNT	= (CLUTSIZE / 2)
 	};
 
+	enum COMMAND_RING_SIZE
+	{
+		COMMAND_RING_SIZE	= 0x400000,
+	};
+
+	enum COMMAND
+	{
+		COMMAND_WRITEREGISTER,
+		COMMAND_FEEDIMAGEDATA,
+		COMMAND_WRITEREGISTERMASSIVELY,
+	};
+
 	enum CLAMP_MODE
 	{
 		CLAMP_MODE_REPEAT,
@@ -763,13 +777,17 @@ protected:
 	void									WriteToDelayedRegister(uint32, uint32, DELAYED_REGISTER&);
 
 	void									ThreadProc();
+	bool									ProcessCommand();
+	void									ProcessCommands(uint64);
+	void									SubmitCommand();
+	void									SendGSCall(const CMailBox::FunctionType&, bool = false);
 	virtual void							InitializeImpl() = 0;
 	virtual void							ReleaseImpl() = 0;
 	void									ResetBase();
 	virtual void							ResetImpl();
 	virtual void							NotifyPreferencesChangedImpl();
 	virtual void							FlipImpl();
-	void									MarkNewFrame();
+	virtual void							MarkNewFrame();
 	virtual void							WriteRegisterImpl(uint8, uint64);
 	void									FeedImageDataImpl(const void*, uint32);
 	void									ReadImageDataImpl(void*, uint32);
@@ -827,6 +845,7 @@ protected:
 	std::recursive_mutex					m_registerMutex;
 	std::atomic<int>						m_transferCount;
 	CMailBox								m_mailBox;
+	CCommandRing							m_commandRing;
 	bool									m_threadDone;
 	CFrameDump*								m_frameDump;
 	bool									m_drawEnabled = true;
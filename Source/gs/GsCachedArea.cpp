@@ -29,6 +29,11 @@ void CGsCachedArea::SetArea(uint32 psm, uint32 bufPtr, uint32 bufWidth, uint32 h
 	m_height = height;
 }
 
+uint32 CGsCachedArea::GetBufPtr() const
+{
+	return m_bufPtr;
+}
+
 std::pair<uint32, uint32> CGsCachedArea::GetPageRect() const
 {
 	auto texturePageSize = CGsPixelFormats::GetPsmPageSize(m_psm);
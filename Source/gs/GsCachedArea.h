@@ -18,6 +18,7 @@ public:
 
 	void						SetArea(uint32 psm, uint32 bufPtr, uint32 bufWidth, uint32 height);
 
+	uint32						GetBufPtr() const;
 	std::pair<uint32, uint32>	GetPageRect() const;
 	uint32						GetPageCount() const;
 	uint32						GetSize() const;
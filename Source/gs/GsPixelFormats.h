@@ -71,6 +71,51 @@ public:
 		typedef uint16 Unit;
 	};
 
+	struct STORAGEPSMZ32
+	{
+		enum PAGEWIDTH		{ PAGEWIDTH = 64 };
+		enum PAGEHEIGHT		{ PAGEHEIGHT = 32 };
+		enum BLOCKWIDTH		{ BLOCKWIDTH = 8 };
+		enum BLOCKHEIGHT	{ BLOCKHEIGHT = 8 };
+		enum COLUMNWIDTH	{ COLUMNWIDTH = 8 };
+		enum COLUMNHEIGHT	{ COLUMNHEIGHT = 2 };
+
+		static const int m_nBlockSwizzleTable[4][8];
+		static const int m_nColumnSwizzleTable[2][8];
+
+		typedef uint32 Unit;
+	};
+
+	struct STORAGEPSMZ16
+	{
+		enum PAGEWIDTH		{ PAGEWIDTH = 64 };
+		enum PAGEHEIGHT		{ PAGEHEIGHT = 64 };
+		enum BLOCKWIDTH		{ BLOCKWIDTH = 16 };
+		enum BLOCKHEIGHT	{ BLOCKHEIGHT = 8 };
+		enum COLUMNWIDTH	{ COLUMNWIDTH = 16 };
+		enum COLUMNHEIGHT	{ COLUMNHEIGHT = 2 };
+
+		static const int m_nBlockSwizzleTable[8][4];
+		static const int m_nColumnSwizzleTable[2][16];
+
+		typedef uint16 Unit;
+	};
+
+	struct STORAGEPSMZ16S
+	{
+		enum PAGEWIDTH		{ PAGEWIDTH = 64 };
+		enum PAGEHEIGHT		{ PAGEHEIGHT = 64 };
+		enum BLOCKWIDTH		{ BLOCKWIDTH = 16 };
+		enum BLOCKHEIGHT	{ BLOCKHEIGHT = 8 };
+		enum COLUMNWIDTH	{ COLUMNWIDTH = 16 };
+		enum COLUMNHEIGHT	{ COLUMNHEIGHT = 2 };
+
+		static const int m_nBlockSwizzleTable[8][4];
+		static const int m_nColumnSwizzleTable[2][16];
+
+		typedef uint16 Unit;
+	};
+
 	struct STORAGEPSMT8
 	{
 		enum PAGEWIDTH		{ PAGEWIDTH = 128 };
@@ -200,6 +245,9 @@ public:
 	typedef CPixelIndexor<STORAGEPSMCT32>	CPixelIndexorPSMCT32;
 	typedef CPixelIndexor<STORAGEPSMCT16>	CPixelIndexorPSMCT16;
 	typedef CPixelIndexor<STORAGEPSMCT16S>	CPixelIndexorPSMCT16S;
+	typedef CPixelIndexor<STORAGEPSMZ32>	CPixelIndexorPSMZ32;
+	typedef CPixelIndexor<STORAGEPSMZ16>	CPixelIndexorPSMZ16;
+	typedef CPixelIndexor<STORAGEPSMZ16S>	CPixelIndexorPSMZ16S;
 	typedef CPixelIndexor<STORAGEPSMT8>		CPixelIndexorPSMT8;
 	typedef CPixelIndexor<STORAGEPSMT4>		CPixelIndexorPSMT4;
 };
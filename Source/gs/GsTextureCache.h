@@ -1,8 +1,11 @@
 #pragma once
 
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include "GSHandler.h"
 #include "GsCachedArea.h"
+#include "GsPixelFormats.h"
 
 #define TEX0_CLUTINFO_MASK (~0xFFFFFFE000000000ULL)
 
@@ -16,6 +19,7 @@ public:
 		void Reset()
 		{
 			m_live = false;
+			m_cachedArea.ClearDirtyPages();
 			m_textureHandle = TextureHandleType();
 		}
 
@@ -25,6 +29,12 @@ public:
 
 		//Platform specific
 		TextureHandleType m_textureHandle;
+
+	private:
+		friend class CGsTextureCache;
+
+		uint32        m_pageStart = 0;
+		uint32        m_pageEnd = 0;
 	};
 
 	enum
@@ -38,56 +48,118 @@ public:
 		{
 			m_textureCache.push_back(std::make_shared<CTexture>());
 		}
+		m_pageTextures.resize(PAGE_COUNT);
 	}
 
 	CTexture* Search(const CGSHandler::TEX0& tex0)
 	{
 		uint64 maskedTex0 = static_cast<uint64>(tex0) & TEX0_CLUTINFO_MASK;
 
-		for(auto textureIterator(m_textureCache.begin());
-			textureIterator != m_textureCache.end(); textureIterator++)
+		auto textureIterator = m_textureMap.find(maskedTex0);
+		if(textureIterator == std::end(m_textureMap))
 		{
-			auto texture = *textureIterator;
-			if(!texture->m_live) continue;
-			if(maskedTex0 != texture->m_tex0) continue;
-			m_textureCache.erase(textureIterator);
-			m_textureCache.push_front(texture);
-			return texture.get();
+			return nullptr;
 		}
 
-		return nullptr;
+		//Move the texture at the front of the list
+		m_textureCache.splice(std::begin(m_textureCache), m_textureCache, textureIterator->second);
+
+		auto texture = textureIterator->second->get();
+		assert(texture->m_live);
+		assert(texture->m_tex0 == maskedTex0);
+		return texture;
 	}
 
-	void Insert(const CGSHandler::TEX0& tex0, TextureHandleType& textureHandle)
+	void Insert(const CGSHandler::TEX0& tex0, TextureHandleType textureHandle)
 	{
-		auto texture = *m_textureCache.rbegin();
+		auto textureIterator = std::prev(std::end(m_textureCache));
+		auto texture = textureIterator->get();
+		if(texture->m_live)
+		{
+			Unindex(texture);
+		}
 		texture->Reset();
 
 		texture->m_cachedArea.SetArea(tex0.nPsm, tex0.GetBufPtr(), tex0.GetBufWidth(), tex0.GetHeight());
 
 		texture->m_tex0          = static_cast<uint64>(tex0) & TEX0_CLUTINFO_MASK;
-		texture->m_textureHandle = textureHandle;
+		texture->m_textureHandle = std::move(textureHandle);
 		texture->m_live          = true;
 
-		m_textureCache.pop_back();
-		m_textureCache.push_front(texture);
+		m_textureCache.splice(std::begin(m_textureCache), m_textureCache, textureIterator);
+		Index(texture, textureIterator);
 	}
 
 	void InvalidateRange(uint32 start, uint32 size)
 	{
-		std::for_each(std::begin(m_textureCache), std::end(m_textureCache), 
-			[start, size] (TexturePtr& texture) { if(texture->m_live) { texture->m_cachedArea.Invalidate(start, size); } });
+		if(size == 0) return;
+		uint32 pageStart = std::min<uint32>(start / CGsPixelFormats::PAGESIZE, PAGE_COUNT - 1);
+		uint32 pageEnd = std::min<uint32>((start + size - 1) / CGsPixelFormats::PAGESIZE, PAGE_COUNT - 1);
+		for(uint32 page = pageStart; page <= pageEnd; page++)
+		{
+			for(const auto& texture : m_pageTextures[page])
+			{
+				assert(texture->m_live);
+				texture->m_cachedArea.Invalidate(start, size);
+			}
+		}
 	}
 
 	void Flush()
 	{
-		std::for_each(std::begin(m_textureCache), std::end(m_textureCache), 
-			[] (TexturePtr& texture) { texture->Reset(); });
+		for(auto& texture : m_textureCache)
+		{
+			texture->Reset();
+		}
+		m_textureMap.clear();
+		for(auto& pageTextures : m_pageTextures)
+		{
+			pageTextures.clear();
+		}
 	}
 
 private:
 	typedef std::shared_ptr<CTexture> TexturePtr;
 	typedef std::list<TexturePtr> TextureList;
+	typedef typename TextureList::iterator TextureIterator;
+	typedef std::unordered_map<uint64, TextureIterator> TextureMap;
+	typedef std::vector<CTexture*> TextureArray;
+
+	enum
+	{
+		//Texture areas don't wrap around, they can go up to twice the size of GS RAM
+		PAGE_COUNT = (CGSHandler::RAMSIZE * 2) / CGsPixelFormats::PAGESIZE,
+	};
+
+	void Index(CTexture* texture, TextureIterator textureIterator)
+	{
+		assert(m_textureMap.find(texture->m_tex0) == std::end(m_textureMap));
+		m_textureMap.insert(std::make_pair(texture->m_tex0, textureIterator));
+
+		uint32 areaStart = texture->m_cachedArea.GetBufPtr();
+		uint32 areaSize = std::max<uint32>(texture->m_cachedArea.GetSize(), 1);
+		texture->m_pageStart = std::min<uint32>(areaStart / CGsPixelFormats::PAGESIZE, PAGE_COUNT - 1);
+		texture->m_pageEnd = std::min<uint32>((areaStart + areaSize - 1) / CGsPixelFormats::PAGESIZE, PAGE_COUNT - 1);
+		for(uint32 page = texture->m_pageStart; page <= texture->m_pageEnd; page++)
+		{
+			m_pageTextures[page].push_back(texture);
+		}
+	}
+
+	void Unindex(CTexture* texture)
+	{
+		m_textureMap.erase(texture->m_tex0);
+
+		for(uint32 page = texture->m_pageStart; page <= texture->m_pageEnd; page++)
+		{
+			auto& pageTextures = m_pageTextures[page];
+			auto textureIterator = std::find(std::begin(pageTextures), std::end(pageTextures), texture);
+			assert(textureIterator != std::end(pageTextures));
+			pageTextures.erase(textureIterator);
+		}
+	}
 
-	TextureList    m_textureCache;
+	TextureList                m_textureCache;
+	TextureMap                 m_textureMap;
+	std::vector<TextureArray>  m_pageTextures;
 };
@@ -8,6 +8,7 @@
 #include "lexical_cast_ex.h"
 #include <boost/lexical_cast.hpp>
 #include <vector>
+#include <algorithm>
 #include "xml/FilteringNodeIterator.h"
 #include "../StructCollectionStateFile.h"
 
@@ -340,6 +341,22 @@ bool CIopBios::IsIdle()
 	return (m_cpu.m_State.nPC == m_idleFunctionAddress);
 }
 
+uint32 CIopBios::GetTicksUntilNextEvent()
+{
+	//Find the next delayed thread that will become ready
+	uint64 result = ~0U;
+	uint64 currentTime = GetCurrentTime();
+	uint32 nextThreadId = ThreadLinkHead();
+	while(nextThreadId != 0)
+	{
+		THREAD* nextThread = m_threads[nextThreadId];
+		nextThreadId = nextThread->nextThreadId;
+		if(currentTime > nextThread->nextActivateTime) return 0;
+		result = std::min<uint64>(result, nextThread->nextActivateTime - currentTime + 1);
+	}
+	return static_cast<uint32>(result);
+}
+
 void CIopBios::InitializeModuleStarter()
 {
 	ModuleStartRequestHead() = 0;
@@ -157,6 +157,7 @@ public:
 	void						LoadState(Framework::CZipArchiveReader&) override;
 
 	bool						IsIdle() override;
+	uint32						GetTicksUntilNextEvent() override;
 
 	Iop::CIoman*				GetIoman();
 	Iop::CCdvdman*				GetCdvdman();
@@ -23,6 +23,7 @@ namespace Iop
 		virtual void				NotifyVBlankEnd() = 0;
 
 		virtual bool				IsIdle() = 0;
+		virtual uint32				GetTicksUntilNextEvent() = 0;
 
 		virtual void				SaveState(Framework::CZipArchiveWriter&) = 0;
 		virtual void				LoadState(Framework::CZipArchiveReader&) = 0;
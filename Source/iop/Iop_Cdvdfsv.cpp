@@ -56,8 +56,6 @@ void CCdvdfsv::ProcessCommands(CSifMan* sifMan)
 {
 	if(m_pendingCommand != COMMAND_NONE)
 	{
-		static const uint32 sectorSize = 0x800;
-
 		uint8* eeRam = nullptr;
 		if(auto sifManPs2 = dynamic_cast<CSifManPs2*>(sifMan))
 		{
@@ -68,31 +66,22 @@ void CCdvdfsv::ProcessCommands(CSifMan* sifMan)
 		{
 			if(m_iso != nullptr)
 			{
-				for(unsigned int i = 0; i < m_pendingReadCount; i++)
-				{
-					m_iso->ReadBlock(m_pendingReadSector + i, eeRam + (m_pendingReadAddr + (i * sectorSize)));
-				}
+				m_iso->ReadBlocks(m_pendingReadSector, m_pendingReadCount, eeRam + m_pendingReadAddr);
 			}
 		}
 		else if(m_pendingCommand == COMMAND_READIOP)
 		{
 			if(m_iso != nullptr)
 			{
-				for(unsigned int i = 0; i < m_pendingReadCount; i++)
-				{
-					m_iso->ReadBlock(m_pendingReadSector + i, m_iopRam + (m_pendingReadAddr + (i * sectorSize)));
-				}
+				m_iso->ReadBlocks(m_pendingReadSector, m_pendingReadCount, m_iopRam + m_pendingReadAddr);
 			}
 		}
 		else if(m_pendingCommand == COMMAND_STREAM_READ)
 		{
 			if(m_iso != nullptr)
 			{
-				for(unsigned int i = 0; i < m_pendingReadCount; i++)
-				{
-					m_iso->ReadBlock(m_streamPos, eeRam + (m_pendingReadAddr + (i * sectorSize)));
-					m_streamPos++;
-				}
+				m_iso->ReadBlocks(m_streamPos, m_pendingReadCount, eeRam + m_pendingReadAddr);
+				m_streamPos += m_pendingReadCount;
 			}
 		}
 
@@ -80,6 +80,14 @@ void CDmac::ResumeDma(unsigned int channelIdx)
 	channel->ResumeDma();
 }
 
+bool CDmac::IsDmaActive(unsigned int channelIdx) const
+{
+	auto channel = m_channel[channelIdx];
+	assert(channel != nullptr);
+	if(channel == nullptr) return false;
+	return channel->IsActive();
+}
+
 void CDmac::AssertLine(unsigned int line)
 {
 	if(line < 7)
@@ -45,6 +45,7 @@ namespace Iop
 		uint32			WriteRegister(uint32, uint32);
 
 		void			ResumeDma(unsigned int);
+		bool			IsDmaActive(unsigned int) const;
 
 		void			AssertLine(unsigned int);
 		uint8*			GetRam();
@@ -30,6 +30,11 @@ void CChannel::SetReceiveFunction(const ReceiveFunctionType& receiveFunction)
 	m_receiveFunction = receiveFunction;
 }
 
+bool CChannel::IsActive() const
+{
+	return (m_CHCR.tr != 0);
+}
+
 void CChannel::ResumeDma()
 {
 	if(m_CHCR.tr == 0) return;
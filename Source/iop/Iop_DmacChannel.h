@@ -48,6 +48,7 @@ namespace Iop
 			void					Reset();
 			void					SetReceiveFunction(const ReceiveFunctionType&);
 			void					ResumeDma();
+			bool					IsActive() const;
 			uint32					ReadRegister(uint32);
 			void					WriteRegister(uint32, uint32);
 
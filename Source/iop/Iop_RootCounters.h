@@ -36,6 +36,7 @@ namespace Iop
 		void		SaveState(Framework::CZipArchiveWriter&);
 
 		void		Update(unsigned int);
+		uint32		GetTicksUntilNextInterrupt() const;
 
 		uint32		ReadRegister(uint32);
 		uint32		WriteRegister(uint32, uint32);
@@ -108,6 +109,9 @@ namespace Iop
 
 		static unsigned int		GetCounterIdByAddress(uint32);
 
+		unsigned int			GetCounterClockRatio(unsigned int) const;
+		uint32					GetCounterMax(unsigned int) const;
+
 		COUNTER					m_counter[MAX_COUNTERS];
 		Iop::CIntc&				m_intc;
 		unsigned int			m_hsyncClocks;
@@ -18,54 +18,61 @@ CSifManPs2::~CSifManPs2()
 
 void CSifManPs2::RegisterModule(uint32 id, CSifModule* module)
 {
-	m_sif.RegisterModule(id, module);
+	CallEe([&] () { m_sif.RegisterModule(id, module); });
 }
 
 bool CSifManPs2::IsModuleRegistered(uint32 id)
 {
-	return m_sif.IsModuleRegistered(id);
+	bool result = false;
+	CallEe([&] () { result = m_sif.IsModuleRegistered(id); });
+	return result;
 }
 
 void CSifManPs2::UnregisterModule(uint32 id)
 {
-	m_sif.UnregisterModule(id);
+	CallEe([&] () { m_sif.UnregisterModule(id); });
 }
 
 void CSifManPs2::SendPacket(void* packet, uint32 size)
 {
-	m_sif.SendPacket(packet, size);
+	CallEe([&] () { m_sif.SendPacket(packet, size); });
 }
 
 void CSifManPs2::SetDmaBuffer(uint32 bufferAddress, uint32 size)
 {
-	m_sif.SetDmaBuffer(bufferAddress, size);
+	CallEe([&] () { m_sif.SetDmaBuffer(bufferAddress, size); });
 }
 
 void CSifManPs2::SetCmdBuffer(uint32 bufferAddress, uint32 size)
 {
-	m_sif.SetCmdBuffer(bufferAddress, size);
+	CallEe([&] () { m_sif.SetCmdBuffer(bufferAddress, size); });
 }
 
 void CSifManPs2::SendCallReply(uint32 serverId, const void* returnData)
 {
-	m_sif.SendCallReply(serverId, returnData);
+	CallEe([&] () { m_sif.SendCallReply(serverId, returnData); });
 }
 
 void CSifManPs2::GetOtherData(uint32 dst, uint32 src, uint32 size)
 {
-	uint8* srcPtr = m_eeRam + (src & (PS2::EE_RAM_SIZE - 1));
-	uint8* dstPtr = m_iopRam + dst;
-	memcpy(dstPtr, srcPtr, size);
+	CallEe(
+		[&] ()
+		{
+			uint8* srcPtr = m_eeRam + (src & (PS2::EE_RAM_SIZE - 1));
+			uint8* dstPtr = m_iopRam + dst;
+			memcpy(dstPtr, srcPtr, size);
+		}
+	);
 }
 
 void CSifManPs2::SetModuleResetHandler(const ModuleResetHandler& moduleResetHandler)
 {
-	m_sif.SetModuleResetHandler(moduleResetHandler);
+	CallEe([&] () { m_sif.SetModuleResetHandler(moduleResetHandler); });
 }
 
 void CSifManPs2::SetCustomCommandHandler(const CustomCommandHandler& customCommandHandler)
 {
-	m_sif.SetCustomCommandHandler(customCommandHandler);
+	CallEe([&] () { m_sif.SetCustomCommandHandler(customCommandHandler); });
 }
 
 uint32 CSifManPs2::SifSetDma(uint32 structAddr, uint32 count)
@@ -78,12 +85,17 @@ uint32 CSifManPs2::SifSetDma(uint32 structAddr, uint32 count)
 	}
 
 	auto dmaReg = reinterpret_cast<SIFDMAREG*>(m_iopRam + structAddr);
-	for(unsigned int i = 0; i < count; i++)
-	{
-		uint8* src = m_iopRam + dmaReg[i].srcAddr;
-		uint8* dst = m_eeRam + (dmaReg[i].dstAddr & (PS2::EE_RAM_SIZE - 1));
-		memcpy(dst, src, dmaReg[i].size);
-	}
+	CallEe(
+		[&] ()
+		{
+			for(unsigned int i = 0; i < count; i++)
+			{
+				uint8* src = m_iopRam + dmaReg[i].srcAddr;
+				uint8* dst = m_eeRam + (dmaReg[i].dstAddr & (PS2::EE_RAM_SIZE - 1));
+				memcpy(dst, src, dmaReg[i].size);
+			}
+		}
+	);
 
 	return count;
 }
@@ -92,3 +104,22 @@ uint8* CSifManPs2::GetEeRam() const
 {
 	return m_eeRam;
 }
+
+void CSifManPs2::SetEeCallHandler(const EeCallHandler& eeCallHandler)
+{
+	m_eeCallHandler = eeCallHandler;
+}
+
+void CSifManPs2::CallEe(const EeFunction& function)
+{
+	//Anything that touches the EE's state needs to go through the handler
+	//since the IOP might not be running on the EE's thread
+	if(m_eeCallHandler)
+	{
+		m_eeCallHandler(function);
+	}
+	else
+	{
+		function();
+	}
+}
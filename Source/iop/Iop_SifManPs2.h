@@ -8,6 +8,9 @@ namespace Iop
 	class CSifManPs2 : public CSifMan
 	{
 	public:
+		typedef std::function<void ()> EeFunction;
+		typedef std::function<void (const EeFunction&)> EeCallHandler;
+
 						CSifManPs2(CSIF&, uint8*, uint8*);
 		virtual			~CSifManPs2();
 
@@ -26,9 +29,14 @@ namespace Iop
 
 		uint8*			GetEeRam() const;
 
+		void			SetEeCallHandler(const EeCallHandler&);
+
 	private:
+		void			CallEe(const EeFunction&);
+
 		CSIF&			m_sif;
 		uint8*			m_eeRam;
 		uint8*			m_iopRam;
+		EeCallHandler	m_eeCallHandler;
 	};
 }
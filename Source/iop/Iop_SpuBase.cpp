@@ -552,7 +552,11 @@ int32 CSpuBase::ComputeChannelVolume(const CHANNEL_VOLUME& volume, int32 current
 
 void CSpuBase::MixSamples(int32 inputSample, int32 volumeLevel, int16* output)
 {
-	inputSample = (inputSample * volumeLevel) / 0x7FFF;
+	AddSample((inputSample * volumeLevel) / 0x7FFF, output);
+}
+
+void CSpuBase::AddSample(int32 inputSample, int16* output)
+{
 	int32 resultSample = inputSample + static_cast<int32>(*output);
 	resultSample = std::max<int32>(resultSample, SHRT_MIN);
 	resultSample = std::min<int32>(resultSample, SHRT_MAX);
@@ -562,226 +566,269 @@ void CSpuBase::MixSamples(int32 inputSample, int32 volumeLevel, int16* output)
 void CSpuBase::Render(int16* samples, unsigned int sampleCount, unsigned int sampleRate)
 {
 	bool updateReverb = m_reverbEnabled && (m_ctrl & CONTROL_REVERB);
+	uint32 reverbChannels = updateReverb ? m_channelReverb.f : 0;
 
 	assert((sampleCount & 0x01) == 0);
 	//ticks are 44100Hz ticks
 	unsigned int ticks = sampleCount / 2;
 	memset(samples, 0, sizeof(int16) * sampleCount);
 
-	for(unsigned int j = 0; j < ticks; j++)
+	//Reverb parameters don't change while rendering
+	float irr_coef = GetReverbCoef(IIR_COEF);
+	float in_coef_l = GetReverbCoef(IN_COEF_L);
+	float in_coef_r = GetReverbCoef(IN_COEF_R);
+	float iir_alpha = GetReverbCoef(IIR_ALPHA);
+	float acc_coef_a = GetReverbCoef(ACC_COEF_A);
+	float acc_coef_b = GetReverbCoef(ACC_COEF_B);
+	float acc_coef_c = GetReverbCoef(ACC_COEF_C);
+	float acc_coef_d = GetReverbCoef(ACC_COEF_D);
+	float fb_alpha = GetReverbCoef(FB_ALPHA);
+	float fb_x = GetReverbCoef(FB_X);
+
+	for(unsigned int blockStart = 0; blockStart < ticks; blockStart += RENDER_BLOCK_TICKS)
 	{
-		int16 reverbSample[2] = { 0, 0 };
+		unsigned int blockTicks = std::min<unsigned int>(ticks - blockStart, RENDER_BLOCK_TICKS);
+
 		//Update channels
-		for(unsigned int i = 0; i < 24; i++)
+		uint32 activeChannels = 0;
+		for(unsigned int i = 0; i < MAX_CHANNEL; i++)
 		{
-			CHANNEL& channel(m_channel[i]);
-			if(channel.status == STOPPED) continue;
-			CSampleReader& reader(m_reader[i]);
-			if(channel.status == KEY_ON)
+			if(RenderChannel(i, blockTicks, sampleRate))
 			{
-				reader.SetParams(channel.address, channel.repeat);
-				reader.ClearEndFlag();
-				channel.status = ATTACK;
-				channel.adsrVolume = 0;
+				activeChannels |= (1 << i);
 			}
-			else
+		}
+		uint32 activeReverbChannels = activeChannels & reverbChannels;
+
+		for(unsigned int j = 0; j < blockTicks; j++)
+		{
+			//Results are saturated after every addition, channels need to be mixed in order
+			int16 reverbSample[2] = { 0, 0 };
+			for(unsigned int i = 0; i < MAX_CHANNEL; i++)
 			{
-				if(reader.IsDone())
-				{
-					channel.status = STOPPED;
-					channel.adsrVolume = 0;
-					continue;
-				}
-				if(reader.DidChangeRepeat())
+				if((activeChannels & (1 << i)) == 0) continue;
+				AddSample(m_mixSampleLeft[j][i], samples + 0);
+				AddSample(m_mixSampleRight[j][i], samples + 1);
+				//Mix in reverb if enabled for this channel
+				if(activeReverbChannels & (1 << i))
 				{
-					channel.repeat = reader.GetRepeat();
-					reader.ClearDidChangeRepeat();
+					AddSample(m_mixSampleLeft[j][i], reverbSample + 0);
+					AddSample(m_mixSampleRight[j][i], reverbSample + 1);
 				}
-				//Update repeat in case it has been changed externally (needed for FFX)
-				reader.SetRepeat(channel.repeat);
 			}
 
-			reader.SetIrqAddress(m_irqAddr);
-
-			int16 readSample = 0;
-			reader.SetPitch(m_baseSamplingRate, channel.pitch);
-			reader.GetSamples(&readSample, 1, sampleRate);
-			channel.current = reader.GetCurrent();
-
-			if((m_ctrl & CONTROL_IRQ) && reader.GetIrqPending())
+			if(!m_blockReader.CanReadSamples() && (m_blockWritePtr == SOUND_INPUT_DATA_SIZE))
 			{
-				m_irqPending = true;
+				//We're ready to consume some data
+				m_blockReader.FillBlock(m_ram + m_soundInputDataAddr);
+				m_blockWritePtr = 0;
 			}
 
-			reader.ClearIrqPending();
+			if(m_blockReader.CanReadSamples())
+			{
+				int16 sampleL = 0;
+				int16 sampleR = 0;
+				m_blockReader.GetSamples(sampleL, sampleR, sampleRate);
 
-			//Mix samples
-			UpdateAdsr(channel);
-			int32 inputSample = static_cast<int32>(readSample);
-			//Mix adsrVolume
+				MixSamples(sampleL, 0x3FFF, samples + 0);
+				MixSamples(sampleR, 0x3FFF, samples + 1);
+			}
+
+			//Update reverb
+			if(updateReverb)
 			{
-				inputSample = (inputSample * static_cast<int32>(channel.adsrVolume >> 16)) / static_cast<int32>(MAX_ADSR_VOLUME >> 16);
+				//Feed samples to FIR filter
+				if(m_reverbTicks & 1)
+				{
+					//IIR_INPUT_A0 = buffer[IIR_SRC_A0] * IIR_COEF + INPUT_SAMPLE_L * IN_COEF_L;
+					//IIR_INPUT_A1 = buffer[IIR_SRC_A1] * IIR_COEF + INPUT_SAMPLE_R * IN_COEF_R;
+					//IIR_INPUT_B0 = buffer[IIR_SRC_B0] * IIR_COEF + INPUT_SAMPLE_L * IN_COEF_L;
+					//IIR_INPUT_B1 = buffer[IIR_SRC_B1] * IIR_COEF + INPUT_SAMPLE_R * IN_COEF_R;
+
+					float input_sample_l = static_cast<float>(reverbSample[0]) * 0.5f;
+					float input_sample_r = static_cast<float>(reverbSample[1]) * 0.5f;
+
+					float iir_input_a0 = GetReverbSample(GetReverbOffset(ACC_SRC_A0)) * irr_coef + input_sample_l * in_coef_l;
+					float iir_input_a1 = GetReverbSample(GetReverbOffset(ACC_SRC_A1)) * irr_coef + input_sample_r * in_coef_r;
+					float iir_input_b0 = GetReverbSample(GetReverbOffset(ACC_SRC_B0)) * irr_coef + input_sample_l * in_coef_l;
+					float iir_input_b1 = GetReverbSample(GetReverbOffset(ACC_SRC_B1)) * irr_coef + input_sample_r * in_coef_r;
+
+					//IIR_A0 = IIR_INPUT_A0 * IIR_ALPHA + buffer[IIR_DEST_A0] * (1.0 - IIR_ALPHA);
+					//IIR_A1 = IIR_INPUT_A1 * IIR_ALPHA + buffer[IIR_DEST_A1] * (1.0 - IIR_ALPHA);
+					//IIR_B0 = IIR_INPUT_B0 * IIR_ALPHA + buffer[IIR_DEST_B0] * (1.0 - IIR_ALPHA);
+					//IIR_B1 = IIR_INPUT_B1 * IIR_ALPHA + buffer[IIR_DEST_B1] * (1.0 - IIR_ALPHA);
+
+					float iir_a0 = iir_input_a0 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_A0)) * (1.0f - iir_alpha);
+					float iir_a1 = iir_input_a1 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_A1)) * (1.0f - iir_alpha);
+					float iir_b0 = iir_input_b0 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_B0)) * (1.0f - iir_alpha);
+					float iir_b1 = iir_input_b1 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_B1)) * (1.0f - iir_alpha);
+
+					//buffer[IIR_DEST_A0 + 1sample] = IIR_A0;
+					//buffer[IIR_DEST_A1 + 1sample] = IIR_A1;
+					//buffer[IIR_DEST_B0 + 1sample] = IIR_B0;
+					//buffer[IIR_DEST_B1 + 1sample] = IIR_B1;
+
+					SetReverbSample(GetReverbOffset(IIR_DEST_A0) + 2, iir_a0);
+					SetReverbSample(GetReverbOffset(IIR_DEST_A1) + 2, iir_a1);
+					SetReverbSample(GetReverbOffset(IIR_DEST_B0) + 2, iir_b0);
+					SetReverbSample(GetReverbOffset(IIR_DEST_B1) + 2, iir_b1);
+
+					//ACC0 = buffer[ACC_SRC_A0] * ACC_COEF_A +
+					//	   buffer[ACC_SRC_B0] * ACC_COEF_B +
+					//	   buffer[ACC_SRC_C0] * ACC_COEF_C +
+					//	   buffer[ACC_SRC_D0] * ACC_COEF_D;
+					//ACC1 = buffer[ACC_SRC_A1] * ACC_COEF_A +
+					//	   buffer[ACC_SRC_B1] * ACC_COEF_B +
+					//	   buffer[ACC_SRC_C1] * ACC_COEF_C +
+					//	   buffer[ACC_SRC_D1] * ACC_COEF_D;
+
+					float acc0 = 
+						GetReverbSample(GetReverbOffset(ACC_SRC_A0)) * acc_coef_a +
+						GetReverbSample(GetReverbOffset(ACC_SRC_B0)) * acc_coef_b +
+						GetReverbSample(GetReverbOffset(ACC_SRC_C0)) * acc_coef_c +
+						GetReverbSample(GetReverbOffset(ACC_SRC_D0)) * acc_coef_d;
+
+					float acc1 = 
+						GetReverbSample(GetReverbOffset(ACC_SRC_A1)) * acc_coef_a +
+						GetReverbSample(GetReverbOffset(ACC_SRC_B1)) * acc_coef_b +
+						GetReverbSample(GetReverbOffset(ACC_SRC_C1)) * acc_coef_c +
+						GetReverbSample(GetReverbOffset(ACC_SRC_D1)) * acc_coef_d;
+
+					//FB_A0 = buffer[MIX_DEST_A0 - FB_SRC_A];
+					//FB_A1 = buffer[MIX_DEST_A1 - FB_SRC_A];
+					//FB_B0 = buffer[MIX_DEST_B0 - FB_SRC_B];
+					//FB_B1 = buffer[MIX_DEST_B1 - FB_SRC_B];
+
+					float fb_a0 = GetReverbSample(GetReverbOffset(MIX_DEST_A0) - GetReverbOffset(FB_SRC_A));
+					float fb_a1 = GetReverbSample(GetReverbOffset(MIX_DEST_A1) - GetReverbOffset(FB_SRC_A));
+					float fb_b0 = GetReverbSample(GetReverbOffset(MIX_DEST_B0) - GetReverbOffset(FB_SRC_B));
+					float fb_b1 = GetReverbSample(GetReverbOffset(MIX_DEST_B1) - GetReverbOffset(FB_SRC_B));
+
+					//buffer[MIX_DEST_A0] = ACC0 - FB_A0 * FB_ALPHA;
+					//buffer[MIX_DEST_A1] = ACC1 - FB_A1 * FB_ALPHA;
+					//buffer[MIX_DEST_B0] = (FB_ALPHA * ACC0) - FB_A0 * (FB_ALPHA^0x8000) - FB_B0 * FB_X;
+					//buffer[MIX_DEST_B1] = (FB_ALPHA * ACC1) - FB_A1 * (FB_ALPHA^0x8000) - FB_B1 * FB_X;
+
+					SetReverbSample(GetReverbOffset(MIX_DEST_A0), acc0 - fb_a0 * fb_alpha);
+					SetReverbSample(GetReverbOffset(MIX_DEST_A1), acc1 - fb_a1 * fb_alpha);
+					SetReverbSample(GetReverbOffset(MIX_DEST_B0), (fb_alpha * acc0) - fb_a0 * -fb_alpha - fb_b0 * fb_x);
+					SetReverbSample(GetReverbOffset(MIX_DEST_B1), (fb_alpha * acc1) - fb_a1 * -fb_alpha - fb_b1 * fb_x);
+
+					m_reverbCurrAddr += 2;
+					if(m_reverbCurrAddr >= m_reverbWorkAddrEnd)
+					{
+						m_reverbCurrAddr = m_reverbWorkAddrStart;
+					}
+				}
+
+				if(m_reverbWorkAddrStart != 0)
+				{
+					float sampleL = 0.333f * (GetReverbSample(GetReverbOffset(MIX_DEST_A0)) + GetReverbSample(GetReverbOffset(MIX_DEST_B0)));
+					float sampleR = 0.333f * (GetReverbSample(GetReverbOffset(MIX_DEST_A1)) + GetReverbSample(GetReverbOffset(MIX_DEST_B1)));
+
+					AddSample(static_cast<int32>(sampleL), samples + 0);
+					AddSample(static_cast<int32>(sampleR), samples + 1);
+				}
+
+				m_reverbTicks++;
 			}
+			samples += 2;
+		}
+	}
+}
 
-			channel.volumeLeftAbs  = ComputeChannelVolume(channel.volumeLeft, channel.volumeLeftAbs);
-			channel.volumeRightAbs = ComputeChannelVolume(channel.volumeRight, channel.volumeRightAbs);
+bool CSpuBase::RenderChannel(unsigned int channelIndex, unsigned int ticks, unsigned int sampleRate)
+{
+	CHANNEL& channel(m_channel[channelIndex]);
+	CSampleReader& reader(m_reader[channelIndex]);
+	bool channelReady = false;
+	bool sweepVolume = channel.volumeLeft.mode.mode || channel.volumeRight.mode.mode;
+	int32 adjustedLeftVolume = 0;
+	int32 adjustedRightVolume = 0;
+	unsigned int j = 0;
 
-			int32 adjustedLeftVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeLeftAbs >> 16) * m_volumeAdjust));
-			int32 adjustedRightVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeRightAbs >> 16) * m_volumeAdjust));
-			MixSamples(inputSample, adjustedLeftVolume, samples + 0);
-			MixSamples(inputSample, adjustedRightVolume, samples + 1);
-			//Mix in reverb if enabled for this channel
-			if(updateReverb && (m_channelReverb.f & (1 << i)))
+	for(; j < ticks; j++)
+	{
+		if(channel.status == STOPPED) break;
+		if(channel.status == KEY_ON)
+		{
+			reader.SetParams(channel.address, channel.repeat);
+			reader.ClearEndFlag();
+			channel.status = ATTACK;
+			channel.adsrVolume = 0;
+		}
+		else
+		{
+			if(reader.IsDone())
+			{
+				channel.status = STOPPED;
+				channel.adsrVolume = 0;
+				break;
+			}
+			if(reader.DidChangeRepeat())
 			{
-				MixSamples(inputSample, adjustedLeftVolume, reverbSample + 0);
-				MixSamples(inputSample, adjustedRightVolume, reverbSample + 1);
+				channel.repeat = reader.GetRepeat();
+				reader.ClearDidChangeRepeat();
 			}
+			//Update repeat in case it has been changed externally (needed for FFX)
+			reader.SetRepeat(channel.repeat);
 		}
 
-		if(!m_blockReader.CanReadSamples() && (m_blockWritePtr == SOUND_INPUT_DATA_SIZE))
+		//IRQ address and pitch can't change while rendering
+		if(!channelReady)
 		{
-			//We're ready to consume some data
-			m_blockReader.FillBlock(m_ram + m_soundInputDataAddr);
-			m_blockWritePtr = 0;
+			reader.SetIrqAddress(m_irqAddr);
+			reader.SetPitch(m_baseSamplingRate, channel.pitch, sampleRate);
 		}
 
-		if(m_blockReader.CanReadSamples())
+		int16 readSample = 0;
+		reader.GetSamples(&readSample, 1);
+		channel.current = reader.GetCurrent();
+
+		if((m_ctrl & CONTROL_IRQ) && reader.GetIrqPending())
 		{
-			int16 sampleL = 0;
-			int16 sampleR = 0;
-			m_blockReader.GetSamples(sampleL, sampleR, sampleRate);
+			m_irqPending = true;
+		}
+
+		reader.ClearIrqPending();
 
-			MixSamples(sampleL, 0x3FFF, samples + 0);
-			MixSamples(sampleR, 0x3FFF, samples + 1);
+		//Mix samples
+		UpdateAdsr(channel);
+		int32 inputSample = static_cast<int32>(readSample);
+		//Mix adsrVolume
+		{
+			inputSample = (inputSample * static_cast<int32>(channel.adsrVolume >> 16)) / static_cast<int32>(MAX_ADSR_VOLUME >> 16);
 		}
 
-		//Update reverb
-		if(updateReverb)
+		//Volume only changes from one tick to another when sweeping
+		if(!channelReady || sweepVolume)
 		{
-			//Feed samples to FIR filter
-			if(m_reverbTicks & 1)
-			{
-				//IIR_INPUT_A0 = buffer[IIR_SRC_A0] * IIR_COEF + INPUT_SAMPLE_L * IN_COEF_L;
-				//IIR_INPUT_A1 = buffer[IIR_SRC_A1] * IIR_COEF + INPUT_SAMPLE_R * IN_COEF_R;
-				//IIR_INPUT_B0 = buffer[IIR_SRC_B0] * IIR_COEF + INPUT_SAMPLE_L * IN_COEF_L;
-				//IIR_INPUT_B1 = buffer[IIR_SRC_B1] * IIR_COEF + INPUT_SAMPLE_R * IN_COEF_R;
-
-				float input_sample_l = static_cast<float>(reverbSample[0]) * 0.5f;
-				float input_sample_r = static_cast<float>(reverbSample[1]) * 0.5f;
-
-				float irr_coef = GetReverbCoef(IIR_COEF);
-				float in_coef_l = GetReverbCoef(IN_COEF_L);
-				float in_coef_r = GetReverbCoef(IN_COEF_R);
-
-				float iir_input_a0 = GetReverbSample(GetReverbOffset(ACC_SRC_A0)) * irr_coef + input_sample_l * in_coef_l;
-				float iir_input_a1 = GetReverbSample(GetReverbOffset(ACC_SRC_A1)) * irr_coef + input_sample_r * in_coef_r;
-				float iir_input_b0 = GetReverbSample(GetReverbOffset(ACC_SRC_B0)) * irr_coef + input_sample_l * in_coef_l;
-				float iir_input_b1 = GetReverbSample(GetReverbOffset(ACC_SRC_B1)) * irr_coef + input_sample_r * in_coef_r;
-
-				//IIR_A0 = IIR_INPUT_A0 * IIR_ALPHA + buffer[IIR_DEST_A0] * (1.0 - IIR_ALPHA);
-				//IIR_A1 = IIR_INPUT_A1 * IIR_ALPHA + buffer[IIR_DEST_A1] * (1.0 - IIR_ALPHA);
-				//IIR_B0 = IIR_INPUT_B0 * IIR_ALPHA + buffer[IIR_DEST_B0] * (1.0 - IIR_ALPHA);
-				//IIR_B1 = IIR_INPUT_B1 * IIR_ALPHA + buffer[IIR_DEST_B1] * (1.0 - IIR_ALPHA);
-
-				float iir_alpha = GetReverbCoef(IIR_ALPHA);
-
-				float iir_a0 = iir_input_a0 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_A0)) * (1.0f - iir_alpha);
-				float iir_a1 = iir_input_a1 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_A1)) * (1.0f - iir_alpha);
-				float iir_b0 = iir_input_b0 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_B0)) * (1.0f - iir_alpha);
-				float iir_b1 = iir_input_b1 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_B1)) * (1.0f - iir_alpha);
-
-				//buffer[IIR_DEST_A0 + 1sample] = IIR_A0;
-				//buffer[IIR_DEST_A1 + 1sample] = IIR_A1;
-				//buffer[IIR_DEST_B0 + 1sample] = IIR_B0;
-				//buffer[IIR_DEST_B1 + 1sample] = IIR_B1;
-
-				SetReverbSample(GetReverbOffset(IIR_DEST_A0) + 2, iir_a0);
-				SetReverbSample(GetReverbOffset(IIR_DEST_A1) + 2, iir_a1);
-				SetReverbSample(GetReverbOffset(IIR_DEST_B0) + 2, iir_b0);
-				SetReverbSample(GetReverbOffset(IIR_DEST_B1) + 2, iir_b1);
-
-				//ACC0 = buffer[ACC_SRC_A0] * ACC_COEF_A +
-				//	   buffer[ACC_SRC_B0] * ACC_COEF_B +
-				//	   buffer[ACC_SRC_C0] * ACC_COEF_C +
-				//	   buffer[ACC_SRC_D0] * ACC_COEF_D;
-				//ACC1 = buffer[ACC_SRC_A1] * ACC_COEF_A +
-				//	   buffer[ACC_SRC_B1] * ACC_COEF_B +
-				//	   buffer[ACC_SRC_C1] * ACC_COEF_C +
-				//	   buffer[ACC_SRC_D1] * ACC_COEF_D;
-
-				float acc_coef_a = GetReverbCoef(ACC_COEF_A);
-				float acc_coef_b = GetReverbCoef(ACC_COEF_B);
-				float acc_coef_c = GetReverbCoef(ACC_COEF_C);
-				float acc_coef_d = GetReverbCoef(ACC_COEF_D);
-
-				float acc0 = 
-					GetReverbSample(GetReverbOffset(ACC_SRC_A0)) * acc_coef_a +
-					GetReverbSample(GetReverbOffset(ACC_SRC_B0)) * acc_coef_b +
-					GetReverbSample(GetReverbOffset(ACC_SRC_C0)) * acc_coef_c +
-					GetReverbSample(GetReverbOffset(ACC_SRC_D0)) * acc_coef_d;
-
-				float acc1 = 
-					GetReverbSample(GetReverbOffset(ACC_SRC_A1)) * acc_coef_a +
-					GetReverbSample(GetReverbOffset(ACC_SRC_B1)) * acc_coef_b +
-					GetReverbSample(GetReverbOffset(ACC_SRC_C1)) * acc_coef_c +
-					GetReverbSample(GetReverbOffset(ACC_SRC_D1)) * acc_coef_d;
-
-				//FB_A0 = buffer[MIX_DEST_A0 - FB_SRC_A];
-				//FB_A1 = buffer[MIX_DEST_A1 - FB_SRC_A];
-				//FB_B0 = buffer[MIX_DEST_B0 - FB_SRC_B];
-				//FB_B1 = buffer[MIX_DEST_B1 - FB_SRC_B];
-
-				float fb_a0 = GetReverbSample(GetReverbOffset(MIX_DEST_A0) - GetReverbOffset(FB_SRC_A));
-				float fb_a1 = GetReverbSample(GetReverbOffset(MIX_DEST_A1) - GetReverbOffset(FB_SRC_A));
-				float fb_b0 = GetReverbSample(GetReverbOffset(MIX_DEST_B0) - GetReverbOffset(FB_SRC_B));
-				float fb_b1 = GetReverbSample(GetReverbOffset(MIX_DEST_B1) - GetReverbOffset(FB_SRC_B));
-
-				//buffer[MIX_DEST_A0] = ACC0 - FB_A0 * FB_ALPHA;
-				//buffer[MIX_DEST_A1] = ACC1 - FB_A1 * FB_ALPHA;
-				//buffer[MIX_DEST_B0] = (FB_ALPHA * ACC0) - FB_A0 * (FB_ALPHA^0x8000) - FB_B0 * FB_X;
-				//buffer[MIX_DEST_B1] = (FB_ALPHA * ACC1) - FB_A1 * (FB_ALPHA^0x8000) - FB_B1 * FB_X;
-
-				float fb_alpha = GetReverbCoef(FB_ALPHA);
-				float fb_x = GetReverbCoef(FB_X);
-
-				SetReverbSample(GetReverbOffset(MIX_DEST_A0), acc0 - fb_a0 * fb_alpha);
-				SetReverbSample(GetReverbOffset(MIX_DEST_A1), acc1 - fb_a1 * fb_alpha);
-				SetReverbSample(GetReverbOffset(MIX_DEST_B0), (fb_alpha * acc0) - fb_a0 * -fb_alpha - fb_b0 * fb_x);
-				SetReverbSample(GetReverbOffset(MIX_DEST_B1), (fb_alpha * acc1) - fb_a1 * -fb_alpha - fb_b1 * fb_x);
-
-				m_reverbCurrAddr += 2;
-				if(m_reverbCurrAddr >= m_reverbWorkAddrEnd)
-				{
-					m_reverbCurrAddr = m_reverbWorkAddrStart;
-				}
-			}
+			channel.volumeLeftAbs  = ComputeChannelVolume(channel.volumeLeft, channel.volumeLeftAbs);
+			channel.volumeRightAbs = ComputeChannelVolume(channel.volumeRight, channel.volumeRightAbs);
 
-			if(m_reverbWorkAddrStart != 0)
-			{
-				float sampleL = 0.333f * (GetReverbSample(GetReverbOffset(MIX_DEST_A0)) + GetReverbSample(GetReverbOffset(MIX_DEST_B0)));
-				float sampleR = 0.333f * (GetReverbSample(GetReverbOffset(MIX_DEST_A1)) + GetReverbSample(GetReverbOffset(MIX_DEST_B1)));
+			adjustedLeftVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeLeftAbs >> 16) * m_volumeAdjust));
+			adjustedRightVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeRightAbs >> 16) * m_volumeAdjust));
+		}
 
-				{
-					int16* output = samples + 0;
-					int32 resultSample = static_cast<int32>(sampleL) + static_cast<int32>(*output);
-					resultSample = std::max<int32>(resultSample, SHRT_MIN);
-					resultSample = std::min<int32>(resultSample, SHRT_MAX);
-					*output = static_cast<int16>(resultSample);
-				}
+		m_mixSampleLeft[j][channelIndex] = (inputSample * adjustedLeftVolume) / 0x7FFF;
+		m_mixSampleRight[j][channelIndex] = (inputSample * adjustedRightVolume) / 0x7FFF;
+		channelReady = true;
+	}
 
-				{
-					int16* output = samples + 1;
-					int32 resultSample = static_cast<int32>(sampleR) + static_cast<int32>(*output);
-					resultSample = std::max<int32>(resultSample, SHRT_MIN);
-					resultSample = std::min<int32>(resultSample, SHRT_MAX);
-					*output = static_cast<int16>(resultSample);
-				}
-			}
+	if(j == 0)
+	{
+		//Channel is silent for the whole block
+		return false;
+	}
 
-			m_reverbTicks++;
-		}
-		samples += 2;
+	//Channel is silent for the rest of the block
+	for(; j < ticks; j++)
+	{
+		m_mixSampleLeft[j][channelIndex] = 0;
+		m_mixSampleRight[j][channelIndex] = 0;
 	}
+
+	return true;
 }
 
 uint32 CSpuBase::GetAdsrDelta(unsigned int index) const
@@ -949,7 +996,7 @@ void CSpuBase::CSampleReader::Reset()
 	memset(m_buffer, 0, sizeof(m_buffer));
 	m_pitch = 0;
 	m_srcSampleIdx = 0;
-	m_srcSamplingRate = 0;
+	m_srcSampleStep = 0;
 	m_s1 = 0;
 	m_s2 = 0;
 	m_done = false;
@@ -979,20 +1026,21 @@ void CSpuBase::CSampleReader::SetParams(uint32 address, uint32 repeat)
 	AdvanceBuffer();
 }
 
-void CSpuBase::CSampleReader::SetPitch(uint32 baseSamplingRate, uint16 pitch)
+void CSpuBase::CSampleReader::SetPitch(uint32 baseSamplingRate, uint16 pitch, unsigned int dstSamplingRate)
 {
-	m_srcSamplingRate = baseSamplingRate * pitch / 4096;
+	uint32 srcSamplingRate = baseSamplingRate * pitch / 4096;
+	m_srcSampleStep = (srcSamplingRate * TIME_SCALE) / dstSamplingRate;
 }
 
-void CSpuBase::CSampleReader::GetSamples(int16* samples, unsigned int sampleCount, unsigned int dstSamplingRate)
+void CSpuBase::CSampleReader::GetSamples(int16* samples, unsigned int sampleCount)
 {
 	for(unsigned int i = 0; i < sampleCount; i++)
 	{
-		samples[i] = GetSample(dstSamplingRate);
+		samples[i] = GetSample();
 	}
 }
 
-int16 CSpuBase::CSampleReader::GetSample(unsigned int dstSamplingRate)
+int16 CSpuBase::CSampleReader::GetSample()
 {
 	uint32 srcSampleIdx = m_srcSampleIdx / TIME_SCALE;
 	int32 srcSampleAlpha = m_srcSampleIdx % TIME_SCALE;
@@ -1000,7 +1048,7 @@ int16 CSpuBase::CSampleReader::GetSample(unsigned int dstSamplingRate)
 	int32 nextSample = m_buffer[srcSampleIdx + 1];
 	int32 resultSample = (currentSample * (TIME_SCALE - srcSampleAlpha) / TIME_SCALE) +
 		(nextSample * srcSampleAlpha / TIME_SCALE);
-	m_srcSampleIdx += (m_srcSamplingRate * TIME_SCALE) / dstSamplingRate;
+	m_srcSampleIdx += m_srcSampleStep;
 	if(srcSampleIdx >= BUFFER_SAMPLES)
 	{
 		m_srcSampleIdx -= BUFFER_SAMPLES * TIME_SCALE;
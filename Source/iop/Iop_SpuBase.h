@@ -237,8 +237,8 @@ namespace Iop
 			void			SetMemory(uint8*, uint32);
 
 			void			SetParams(uint32, uint32);
-			void			SetPitch(uint32, uint16);
-			void			GetSamples(int16*, unsigned int, unsigned int);
+			void			SetPitch(uint32, uint16, unsigned int);
+			void			GetSamples(int16*, unsigned int);
 			uint32			GetRepeat() const;
 			void			SetRepeat(uint32);
 			uint32			GetCurrent() const;
@@ -260,13 +260,13 @@ namespace Iop
 
 			void			UnpackSamples(int16*);
 			void			AdvanceBuffer();
-			int16			GetSample(unsigned int);
+			int16			GetSample();
 
 			uint8*			m_ram = nullptr;
 			uint32			m_ramSize = 0;
 
 			uint32			m_srcSampleIdx;
-			unsigned int	m_srcSamplingRate;
+			uint32			m_srcSampleStep;
 			uint32			m_nextSampleAddr = 0;
 			uint32			m_repeatAddr = 0;
 			uint32			m_irqAddr = 0;
@@ -305,6 +305,12 @@ namespace Iop
 			MAX_ADSR_VOLUME = 0x7FFFFFFF,
 		};
 
+		enum
+		{
+			RENDER_BLOCK_TICKS = 64,
+		};
+
+		bool				RenderChannel(unsigned int, unsigned int, unsigned int);
 		void				UpdateAdsr(CHANNEL&);
 		uint32				GetAdsrDelta(unsigned int) const;
 		float				GetReverbSample(uint32) const;
@@ -313,6 +319,7 @@ namespace Iop
 		float				GetReverbCoef(unsigned int) const;
 
 		static void			MixSamples(int32, int32, int16*);
+		static void			AddSample(int32, int16*);
 		int32				ComputeChannelVolume(const CHANNEL_VOLUME&, int32);
 
 		static const uint32	g_linearIncreaseSweepDeltas[0x80];
@@ -343,5 +350,9 @@ namespace Iop
 		CBlockSampleReader	m_blockReader;
 		uint32				m_soundInputDataAddr = 0;
 		uint32				m_blockWritePtr = 0;
+
+		//Channel output for the block being rendered, indexed by tick and then by channel
+		int32				m_mixSampleLeft[RENDER_BLOCK_TICKS][MAX_CHANNEL];
+		int32				m_mixSampleRight[RENDER_BLOCK_TICKS][MAX_CHANNEL];
 	};
 }
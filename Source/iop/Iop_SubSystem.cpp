@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "Iop_SubSystem.h"
 #include "../MemoryStateFile.h"
 #include "../Ps2Const.h"
@@ -88,12 +89,15 @@ void CSubSystem::NotifyVBlankEnd()
 	m_intc.AssertLine(Iop::CIntc::LINE_EVBLANK);
 }
 
-void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
+void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive, bool includeRam)
 {
 	archive.InsertFile(new CMemoryStateFile(STATE_CPU,		&m_cpu.m_State, sizeof(MIPSSTATE)));
-	archive.InsertFile(new CMemoryStateFile(STATE_RAM,		m_ram,			IOP_RAM_SIZE));
 	archive.InsertFile(new CMemoryStateFile(STATE_SCRATCH,	m_scratchPad,	IOP_SCRATCH_SIZE));
-	archive.InsertFile(new CMemoryStateFile(STATE_SPURAM,	m_spuRam,		SPU_RAM_SIZE));
+	if(includeRam)
+	{
+		archive.InsertFile(new CMemoryStateFile(STATE_RAM,		m_ram,			IOP_RAM_SIZE));
+		archive.InsertFile(new CMemoryStateFile(STATE_SPURAM,	m_spuRam,		SPU_RAM_SIZE));
+	}
 	m_intc.SaveState(archive);
 	m_counters.SaveState(archive);
 	m_spuCore0.SaveState(archive);
@@ -101,12 +105,15 @@ void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 	m_bios->SaveState(archive);
 }
 
-void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
+void CSubSystem::LoadState(Framework::CZipArchiveReader& archive, bool includeRam)
 {
 	archive.BeginReadFile(STATE_CPU			)->Read(&m_cpu.m_State,	sizeof(MIPSSTATE));
-	archive.BeginReadFile(STATE_RAM			)->Read(m_ram,			IOP_RAM_SIZE);
 	archive.BeginReadFile(STATE_SCRATCH		)->Read(m_scratchPad,	IOP_SCRATCH_SIZE);
-	archive.BeginReadFile(STATE_SPURAM		)->Read(m_spuRam,		SPU_RAM_SIZE);
+	if(includeRam)
+	{
+		archive.BeginReadFile(STATE_RAM		)->Read(m_ram,			IOP_RAM_SIZE);
+		archive.BeginReadFile(STATE_SPURAM	)->Read(m_spuRam,		SPU_RAM_SIZE);
+	}
 	m_intc.LoadState(archive);
 	m_counters.LoadState(archive);
 	m_spuCore0.LoadState(archive);
@@ -235,7 +242,7 @@ uint32 CSubSystem::WriteIoRegister(uint32 address, uint32 value)
 
 bool CSubSystem::IsCpuIdle()
 {
-	if(m_bios->IsIdle())
+	if(m_bios->IsIdle() || m_executor.IsWaitingForCompilation())
 	{
 		return true;
 	}
@@ -254,15 +261,14 @@ bool CSubSystem::IsCpuIdle()
 
 void CSubSystem::CountTicks(int ticks)
 {
-	static int g_dmaUpdateDelay = 10000;
 	m_counters.Update(ticks);
 	m_bios->CountTicks(ticks);
 	m_dmaUpdateTicks += ticks;
-	if(m_dmaUpdateTicks >= g_dmaUpdateDelay)
+	if(m_dmaUpdateTicks >= DMA_UPDATE_TICKS)
 	{
 		m_dmac.ResumeDma(4);
 		m_dmac.ResumeDma(8);
-		m_dmaUpdateTicks -= g_dmaUpdateDelay;
+		m_dmaUpdateTicks -= DMA_UPDATE_TICKS;
 	}
 	{
 		bool irqPending = false;
@@ -279,6 +285,18 @@ void CSubSystem::CountTicks(int ticks)
 	}
 }
 
+uint32 CSubSystem::GetTicksUntilNextEvent()
+{
+	uint32 result = std::min<uint32>(m_counters.GetTicksUntilNextInterrupt(), m_bios->GetTicksUntilNextEvent());
+	if(m_dmac.IsDmaActive(4) || m_dmac.IsDmaActive(8))
+	{
+		//SPU transfers are resumed periodically
+		uint32 dmaTicks = (m_dmaUpdateTicks < DMA_UPDATE_TICKS) ? (DMA_UPDATE_TICKS - m_dmaUpdateTicks) : 0;
+		result = std::min<uint32>(result, dmaTicks);
+	}
+	return result;
+}
+
 int CSubSystem::ExecuteCpu(int quota)
 {
 	int executed = 0;
@@ -27,14 +27,15 @@ namespace Iop
 		int					ExecuteCpu(int);
 		bool				IsCpuIdle();
 		void				CountTicks(int);
+		uint32				GetTicksUntilNextEvent();
 
 		void				SetBios(const BiosBasePtr&);
 
 		void				NotifyVBlankStart();
 		void				NotifyVBlankEnd();
 
-		void				SaveState(Framework::CZipArchiveWriter&);
-		void				LoadState(Framework::CZipArchiveReader&);
+		void				SaveState(Framework::CZipArchiveWriter&, bool = true);
+		void				LoadState(Framework::CZipArchiveReader&, bool = true);
 
 		uint8*				m_ram;
 		uint8*				m_scratchPad;
@@ -62,6 +63,11 @@ namespace Iop
 			HW_REG_END		= 0x1F9FFFFF
 		};
 
+		enum
+		{
+			DMA_UPDATE_TICKS	= 10000,
+		};
+
 		uint32				ReadIoRegister(uint32);
 		uint32				WriteIoRegister(uint32, uint32);
 
@@ -117,7 +117,7 @@ extern "C" JNIEXPORT void JNICALL Java_com_virtualapplications_play_NativeIntero
 	if(g_virtualMachine == nullptr) return;
 	Framework::PathUtils::EnsurePathExists(GetStateDirectoryPath());
 	auto stateFilePath = GenerateStatePath(slot);
-	if(g_virtualMachine->SaveState(stateFilePath.string().c_str()) != 0)
+	if(!g_virtualMachine->SaveState(stateFilePath.string().c_str()).get())
 	{
 		jclass exceptionClass = env->FindClass("java/lang/Exception");
 		env->ThrowNew(exceptionClass, "SaveState failed.");
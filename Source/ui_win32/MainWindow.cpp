@@ -435,7 +435,7 @@ void CMainWindow::SaveState()
 	if(m_virtualMachine.m_ee->m_os->GetELF() == nullptr) return;
 
 	Framework::PathUtils::EnsurePathExists(GetStateDirectoryPath());
-	if(m_virtualMachine.SaveState(GenerateStatePath().string().c_str()) == 0)
+	if(m_virtualMachine.SaveState(GenerateStatePath().string().c_str()).get())
 	{
 		PrintStatusTextA("Saved state to slot %i.", m_stateSlot);
 	}
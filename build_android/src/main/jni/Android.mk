@@ -40,6 +40,8 @@ include $(CLEAR_VARS)
 LOCAL_MODULE			:= libPlay
 LOCAL_SRC_FILES			:=	$(PROJECT_PATH)/Source/AppConfig.cpp \
 							$(PROJECT_PATH)/Source/BasicBlock.cpp \
+							$(PROJECT_PATH)/Source/BlockCodeCache.cpp \
+							$(PROJECT_PATH)/Source/CommandRing.cpp \
 							$(PROJECT_PATH)/Source/ControllerInfo.cpp \
 							$(PROJECT_PATH)/Source/COP_FPU.cpp \
 							$(PROJECT_PATH)/Source/COP_FPU_Reflection.cpp \
@@ -60,6 +62,7 @@ LOCAL_SRC_FILES			:=	$(PROJECT_PATH)/Source/AppConfig.cpp \
 							$(PROJECT_PATH)/Source/ee/INTC.cpp \
 							$(PROJECT_PATH)/Source/ee/IPU.cpp \
 							$(PROJECT_PATH)/Source/ee/IPU_DmVectorTable.cpp \
+							$(PROJECT_PATH)/Source/ee/IPU_FastIdct.cpp \
 							$(PROJECT_PATH)/Source/ee/IPU_MacroblockAddressIncrementTable.cpp \
 							$(PROJECT_PATH)/Source/ee/IPU_MacroblockTypeBTable.cpp \
 							$(PROJECT_PATH)/Source/ee/IPU_MacroblockTypeITable.cpp \
@@ -88,6 +91,7 @@ LOCAL_SRC_FILES			:=	$(PROJECT_PATH)/Source/AppConfig.cpp \
 							$(PROJECT_PATH)/Source/FrameDump.cpp \
 							$(PROJECT_PATH)/Source/gs/GsCachedArea.cpp \
 							$(PROJECT_PATH)/Source/gs/GSH_Null.cpp \
+							$(PROJECT_PATH)/Source/gs/GSH_Software.cpp \
 							$(PROJECT_PATH)/Source/gs/GSHandler.cpp \
 							$(PROJECT_PATH)/Source/gs/GSH_OpenGL/GSH_OpenGL.cpp \
 							$(PROJECT_PATH)/Source/gs/GSH_OpenGL/GSH_OpenGL_Shader.cpp \
@@ -140,12 +144,15 @@ LOCAL_SRC_FILES			:=	$(PROJECT_PATH)/Source/AppConfig.cpp \
 							$(PROJECT_PATH)/Source/iop/IopBios.cpp \
 							$(PROJECT_PATH)/Source/iop/IsoDevice.cpp \
 							$(PROJECT_PATH)/Source/ISO9660/DirectoryRecord.cpp \
+							$(PROJECT_PATH)/Source/ISO9660/BlockProviderMapped.cpp \
 							$(PROJECT_PATH)/Source/ISO9660/File.cpp \
 							$(PROJECT_PATH)/Source/ISO9660/ISO9660.cpp \
 							$(PROJECT_PATH)/Source/ISO9660/PathTable.cpp \
 							$(PROJECT_PATH)/Source/ISO9660/PathTableRecord.cpp \
 							$(PROJECT_PATH)/Source/ISO9660/VolumeDescriptor.cpp \
 							$(PROJECT_PATH)/Source/IszImageStream.cpp \
+							$(PROJECT_PATH)/Source/ImageBlockCache.cpp \
+							$(PROJECT_PATH)/Source/RewindBuffer.cpp \
 							$(PROJECT_PATH)/Source/Log.cpp \
 							$(PROJECT_PATH)/Source/MA_MIPSIV.cpp \
 							$(PROJECT_PATH)/Source/MA_MIPSIV_Reflection.cpp \
@@ -166,8 +173,11 @@ LOCAL_SRC_FILES			:=	$(PROJECT_PATH)/Source/AppConfig.cpp \
 							$(PROJECT_PATH)/Source/MIPSTags.cpp \
 							$(PROJECT_PATH)/Source/PadHandler.cpp \
 							$(PROJECT_PATH)/Source/PadListener.cpp \
+							$(PROJECT_PATH)/Source/PerfMap.cpp \
 							$(PROJECT_PATH)/Source/PH_Generic.cpp \
 							$(PROJECT_PATH)/Source/Profiler.cpp \
+							$(PROJECT_PATH)/Source/SubSystemThread.cpp \
+							$(PROJECT_PATH)/Source/SuperBlock.cpp \
 							$(PROJECT_PATH)/Source/PS2VM.cpp \
 							$(PROJECT_PATH)/Source/RegisterStateFile.cpp \
 							$(PROJECT_PATH)/Source/StructCollectionStateFile.cpp \
@@ -0,0 +1,308 @@
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <boost/filesystem.hpp>
+#include "PS2VM.h"
+#include "PS2VM_Preferences.h"
+#include "AppConfig.h"
+#include "BasicBlock.h"
+#include "gs/GSH_Null.h"
+#include "gs/GSH_Software.h"
+
+#define DEFAULT_FRAME_COUNT	(600)
+#define DEFAULT_TIMEOUT		(600)
+
+struct BENCHMARK_RESULT
+{
+	bool								completed = false;
+	uint32								frameCount = 0;
+	double								elapsedTime = 0;
+	CPS2VM::EXECUTION_STATS				executionStats;
+	CBasicBlock::COMPILE_STATS			compileStats;
+	std::map<std::string, uint64>		zoneTimes;
+};
+
+static std::string EscapeJsonString(const std::string& input)
+{
+	std::string result;
+	for(auto character : input)
+	{
+		switch(character)
+		{
+		case '"':
+			result += "\\\"";
+			break;
+		case '\\':
+			result += "\\\\";
+			break;
+		default:
+			if(static_cast<unsigned char>(character) < 0x20)
+			{
+				char escape[8];
+				sprintf(escape, "\\u%04x", character);
+				result += escape;
+			}
+			else
+			{
+				result += character;
+			}
+			break;
+		}
+	}
+	return result;
+}
+
+static void WriteResult(FILE* output, const std::string& path, const BENCHMARK_RESULT& result)
+{
+	double elapsedTime = std::max(result.elapsedTime, 1e-9);
+	const auto& stats = result.executionStats;
+	uint64 eeExecutedTicks = stats.eeTotalTicks - stats.eeIdleTicks;
+	uint64 iopExecutedTicks = stats.iopTotalTicks - stats.iopIdleTicks;
+
+	fprintf(output, "{\n");
+	fprintf(output, "\t\"path\": \"%s\",\n", EscapeJsonString(path).c_str());
+	fprintf(output, "\t\"frames\": %u,\n", result.frameCount);
+	fprintf(output, "\t\"elapsedSeconds\": %f,\n", result.elapsedTime);
+	fprintf(output, "\t\"framesPerSecond\": %f,\n", static_cast<double>(result.frameCount) / elapsedTime);
+	fprintf(output, "\t\"ee\": { \"cycles\": %llu, \"idleCycles\": %llu, \"cyclesPerSecond\": %f, \"executedCyclesPerSecond\": %f },\n",
+		static_cast<unsigned long long>(stats.eeTotalTicks), static_cast<unsigned long long>(stats.eeIdleTicks),
+		static_cast<double>(stats.eeTotalTicks) / elapsedTime, static_cast<double>(eeExecutedTicks) / elapsedTime);
+	fprintf(output, "\t\"iop\": { \"cycles\": %llu, \"idleCycles\": %llu, \"cyclesPerSecond\": %f, \"executedCyclesPerSecond\": %f },\n",
+		static_cast<unsigned long long>(stats.iopTotalTicks), static_cast<unsigned long long>(stats.iopIdleTicks),
+		static_cast<double>(stats.iopTotalTicks) / elapsedTime, static_cast<double>(iopExecutedTicks) / elapsedTime);
+	fprintf(output, "\t\"jit\": { \"blocks\": %llu, \"compileSeconds\": %f },\n",
+		static_cast<unsigned long long>(result.compileStats.blockCount), static_cast<double>(result.compileStats.compileTime) / 1000000.0);
+	fprintf(output, "\t\"zones\": [");
+	bool firstZone = true;
+	for(const auto& zoneTime : result.zoneTimes)
+	{
+		fprintf(output, "%s\n\t\t{ \"name\": \"%s\", \"seconds\": %f }", firstZone ? "" : ",",
+			EscapeJsonString(zoneTime.first).c_str(), static_cast<double>(zoneTime.second) / 1000000000.0);
+		firstZone = false;
+	}
+	fprintf(output, "%s]\n", firstZone ? "" : "\n\t");
+	fprintf(output, "}\n");
+}
+
+static BENCHMARK_RESULT ExecuteBenchmark(const boost::filesystem::path& executablePath, bool isDiscImage, uint32 frameCount, uint32 timeout, bool useSoftwareRenderer, bool useBackgroundCompile)
+{
+	BENCHMARK_RESULT result;
+	std::mutex resultMutex;
+	std::atomic<bool> benchmarkDone(false);
+	uint32 currentFrame = 0;
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	std::string previousCdrom0Path;
+	if(isDiscImage)
+	{
+		auto& appConfig = CAppConfig::GetInstance();
+		appConfig.RegisterPreferenceString(PS2VM_CDROM0PATH, "");
+		previousCdrom0Path = appConfig.GetPreferenceString(PS2VM_CDROM0PATH);
+		appConfig.SetPreferenceString(PS2VM_CDROM0PATH, executablePath.string().c_str());
+	}
+
+	//Setup virtual machine
+	CPS2VM virtualMachine;
+	bool previousBackgroundCompile = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_JIT_BACKGROUNDCOMPILE);
+	CAppConfig::GetInstance().SetPreferenceBoolean(PREF_PS2_JIT_BACKGROUNDCOMPILE, useBackgroundCompile);
+	virtualMachine.Initialize();
+	virtualMachine.Reset();
+	virtualMachine.CreateGSHandler(useSoftwareRenderer ? CGSH_Software::GetFactoryFunction() : CGSH_Null::GetFactoryFunction());
+
+	//Both signals are raised by the emulation thread
+	auto newFrameConnection = virtualMachine.OnNewFrame.connect(
+		[&] ()
+		{
+			if(benchmarkDone) return;
+			currentFrame++;
+			if(currentFrame != frameCount) return;
+			auto endTime = std::chrono::high_resolution_clock::now();
+			std::lock_guard<std::mutex> resultLock(resultMutex);
+			result.completed = true;
+			result.frameCount = currentFrame;
+			result.elapsedTime = std::chrono::duration<double>(endTime - startTime).count();
+			result.executionStats = virtualMachine.GetExecutionStats();
+			result.compileStats = CBasicBlock::GetCompileStats();
+			benchmarkDone = true;
+		}
+	);
+	auto profileFrameDoneConnection = virtualMachine.ProfileFrameDone.connect(
+		[&] (const CProfiler::ZoneArray& zones)
+		{
+			if(benchmarkDone) return;
+			std::lock_guard<std::mutex> resultLock(resultMutex);
+			for(const auto& zone : zones)
+			{
+				result.zoneTimes[zone.name] += zone.totalTime;
+			}
+		}
+	);
+
+	if(isDiscImage)
+	{
+		virtualMachine.m_ee->m_os->BootFromCDROM();
+	}
+	else
+	{
+		virtualMachine.m_ee->m_os->BootFromFile(executablePath.string().c_str());
+	}
+
+	CBasicBlock::ResetCompileStats();
+	startTime = std::chrono::high_resolution_clock::now();
+	virtualMachine.Resume();
+
+	//Games can hang or the machine can stop by itself, don't wait forever for the last frame
+	auto timeoutTime = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+	while(!benchmarkDone)
+	{
+		if(virtualMachine.GetStatus() == CVirtualMachine::PAUSED) break;
+		if(std::chrono::steady_clock::now() >= timeoutTime) break;
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	virtualMachine.Pause();
+	benchmarkDone = true;
+	newFrameConnection.disconnect();
+	profileFrameDoneConnection.disconnect();
+	virtualMachine.DestroyGSHandler();
+	virtualMachine.Destroy();
+	CAppConfig::GetInstance().SetPreferenceBoolean(PREF_PS2_JIT_BACKGROUNDCOMPILE, previousBackgroundCompile);
+
+	if(isDiscImage)
+	{
+		CAppConfig::GetInstance().SetPreferenceString(PS2VM_CDROM0PATH, previousCdrom0Path.c_str());
+	}
+
+	std::lock_guard<std::mutex> resultLock(resultMutex);
+	if(!result.completed)
+	{
+		result.frameCount = currentFrame;
+	}
+	return result;
+}
+
+int main(int argc, const char** argv)
+{
+	if(argc < 2)
+	{
+		printf("Usage: Benchmark [options] <executable.elf | disc image>\r\n");
+		printf("Options: \r\n");
+		printf("\t --frames <count>\t Number of frames to emulate (default: %d).\r\n", DEFAULT_FRAME_COUNT);
+		printf("\t --timeout <seconds>\t Gives up if frames aren't emulated within this time (default: %d).\r\n", DEFAULT_TIMEOUT);
+		printf("\t --output <path>\t Writes the JSON report at <path> instead of the standard output.\r\n");
+		printf("\t --software-renderer\t Renders with the software GS handler instead of discarding draws.\r\n");
+		printf("\t --background-compile\t Compiles blocks on background threads.\r\n");
+		return -1;
+	}
+
+	uint32 frameCount = DEFAULT_FRAME_COUNT;
+	uint32 timeout = DEFAULT_TIMEOUT;
+	boost::filesystem::path executablePath;
+	boost::filesystem::path outputPath;
+	bool useSoftwareRenderer = false;
+	bool useBackgroundCompile = false;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(!strcmp(argv[i], "--frames"))
+		{
+			if((i + 1) >= argc)
+			{
+				printf("Error: Count must be specified for --frames option.\r\n");
+				return -1;
+			}
+			frameCount = strtoul(argv[i + 1], nullptr, 10);
+			if(frameCount == 0)
+			{
+				printf("Error: Frame count must be greater than 0.\r\n");
+				return -1;
+			}
+			i++;
+		}
+		else if(!strcmp(argv[i], "--timeout"))
+		{
+			if((i + 1) >= argc)
+			{
+				printf("Error: Time must be specified for --timeout option.\r\n");
+				return -1;
+			}
+			timeout = strtoul(argv[i + 1], nullptr, 10);
+			if(timeout == 0)
+			{
+				printf("Error: Timeout must be greater than 0.\r\n");
+				return -1;
+			}
+			i++;
+		}
+		else if(!strcmp(argv[i], "--output"))
+		{
+			if((i + 1) >= argc)
+			{
+				printf("Error: Path must be specified for --output option.\r\n");
+				return -1;
+			}
+			outputPath = boost::filesystem::path(argv[i + 1]);
+			i++;
+		}
+		else if(!strcmp(argv[i], "--software-renderer"))
+		{
+			useSoftwareRenderer = true;
+		}
+		else if(!strcmp(argv[i], "--background-compile"))
+		{
+			useBackgroundCompile = true;
+		}
+		else
+		{
+			executablePath = boost::filesystem::path(argv[i]);
+		}
+	}
+
+	if(executablePath.empty())
+	{
+		printf("Error: No executable or disc image specified.\r\n");
+		return -1;
+	}
+
+	bool isDiscImage = (executablePath.extension() != ".elf") && (executablePath.extension() != ".ELF");
+	BENCHMARK_RESULT result;
+	try
+	{
+		result = ExecuteBenchmark(executablePath, isDiscImage, frameCount, timeout, useSoftwareRenderer, useBackgroundCompile);
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Error: Failed to run '%s': %s\r\n", executablePath.string().c_str(), exception.what());
+		return -1;
+	}
+
+	if(!result.completed)
+	{
+		printf("Error: Emulation stopped or timed out after %u of %u frames.\r\n", result.frameCount, frameCount);
+		return -1;
+	}
+
+	FILE* output = stdout;
+	if(!outputPath.empty())
+	{
+		output = fopen(outputPath.string().c_str(), "wb");
+		if(output == nullptr)
+		{
+			printf("Error: Failed to open '%s' for writing.\r\n", outputPath.string().c_str());
+			return -1;
+		}
+	}
+	WriteResult(output, executablePath.string(), result);
+	if(output != stdout)
+	{
+		fclose(output);
+	}
+
+	return 0;
+}
@@ -0,0 +1,236 @@
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "gs/GSH_Software.h"
+
+#define FRAME_WIDTH (256)
+#define FRAME_HEIGHT (128)
+#define TEXTURE_SIZE (16)
+#define TEXTURE_BUFPTR (0x800)
+
+//Hash of the framebuffer drawn by DrawScene, update it when rasterization rules change on purpose
+#define EXPECTED_HASH (0xB9C47346)
+
+typedef std::vector<CGSHandler::RegisterWrite> WriteList;
+typedef std::vector<uint8> Framebuffer;
+
+static uint64 MakeXyz(int32 x, int32 y, uint32 z)
+{
+	return static_cast<uint64>((x * 16) & 0xFFFF) | (static_cast<uint64>((y * 16) & 0xFFFF) << 16) | (static_cast<uint64>(z) << 32);
+}
+
+static uint64 MakeUv(int32 u, int32 v)
+{
+	return static_cast<uint64>((u * 16) & 0x3FFF) | (static_cast<uint64>((v * 16) & 0x3FFF) << 16);
+}
+
+static uint64 MakeRgbaq(uint8 r, uint8 g, uint8 b, uint8 a)
+{
+	auto rgbaq = make_convertible<CGSHandler::RGBAQ>(static_cast<uint64>(0));
+	rgbaq.nR = r;
+	rgbaq.nG = g;
+	rgbaq.nB = b;
+	rgbaq.nA = a;
+	rgbaq.nQ = 1.0f;
+	return rgbaq;
+}
+
+static uint64 MakePrim(unsigned int type, bool gouraud, bool textured)
+{
+	auto prim = make_convertible<CGSHandler::PRIM>(static_cast<uint64>(0));
+	prim.nType = type;
+	prim.nShading = gouraud ? 1 : 0;
+	prim.nTexture = textured ? 1 : 0;
+	prim.nUseUV = 1;
+	return prim;
+}
+
+static void WritePrivRegister64(CGSHandler& gs, uint32 address, uint64 value)
+{
+	gs.WritePrivRegister(address + 0, static_cast<uint32>(value));
+	gs.WritePrivRegister(address + 4, static_cast<uint32>(value >> 32));
+}
+
+static void SetupDisplay(CGSHandler& gs)
+{
+	gs.SetCrt(false, 2, false);
+
+	//DISPFB: FBW, DISPLAY: DW and DH
+	uint64 dispfb = static_cast<uint64>(FRAME_WIDTH / 64) << 9;
+	uint64 display = (static_cast<uint64>(FRAME_WIDTH - 1) << 32) | (static_cast<uint64>(FRAME_HEIGHT - 1) << 44);
+
+	WritePrivRegister64(gs, CGSHandler::GS_PMODE, 1);
+	WritePrivRegister64(gs, CGSHandler::GS_DISPFB1, dispfb);
+	WritePrivRegister64(gs, CGSHandler::GS_DISPLAY1, display);
+}
+
+static WriteList MakeSetupWrites()
+{
+	auto frame = make_convertible<CGSHandler::FRAME>(static_cast<uint64>(0));
+	frame.nWidth = FRAME_WIDTH / 64;
+
+	auto zbuf = make_convertible<CGSHandler::ZBUF>(static_cast<uint64>(0));
+	zbuf.nPtr = 0x40;
+	zbuf.nMask = 1;
+
+	auto test = make_convertible<CGSHandler::TEST>(static_cast<uint64>(0));
+	test.nDepthEnabled = 1;
+	test.nDepthMethod = 1;
+
+	auto scissor = make_convertible<CGSHandler::SCISSOR>(static_cast<uint64>(0));
+	scissor.scax1 = FRAME_WIDTH - 1;
+	scissor.scay1 = FRAME_HEIGHT - 1;
+
+	auto tex0 = make_convertible<CGSHandler::TEX0>(static_cast<uint64>(0));
+	tex0.nBufPtr = TEXTURE_BUFPTR;
+	tex0.nBufWidth = 1;
+	tex0.nWidth = 4;
+	tex0.nPad1 = 1;
+	tex0.nColorComp = 1;
+
+	WriteList writes;
+	writes.emplace_back(GS_REG_PRMODECONT, 1);
+	writes.emplace_back(GS_REG_FRAME_1, frame);
+	writes.emplace_back(GS_REG_ZBUF_1, zbuf);
+	writes.emplace_back(GS_REG_TEST_1, test);
+	writes.emplace_back(GS_REG_SCISSOR_1, scissor);
+	writes.emplace_back(GS_REG_XYOFFSET_1, 0);
+	writes.emplace_back(GS_REG_TEX0_1, tex0);
+	return writes;
+}
+
+static void UploadTexture(CGSHandler& gs)
+{
+	auto bitbltbuf = make_convertible<CGSHandler::BITBLTBUF>(static_cast<uint64>(0));
+	bitbltbuf.nDstPtr = TEXTURE_BUFPTR;
+	bitbltbuf.nDstWidth = 1;
+
+	auto trxreg = make_convertible<CGSHandler::TRXREG>(static_cast<uint64>(0));
+	trxreg.nRRW = TEXTURE_SIZE;
+	trxreg.nRRH = TEXTURE_SIZE;
+
+	WriteList writes;
+	writes.emplace_back(GS_REG_BITBLTBUF, bitbltbuf);
+	writes.emplace_back(GS_REG_TRXPOS, 0);
+	writes.emplace_back(GS_REG_TRXREG, trxreg);
+	writes.emplace_back(GS_REG_TRXDIR, 0);
+	gs.WriteRegisterMassively(writes.data(), static_cast<unsigned int>(writes.size()), nullptr);
+
+	//Checkerboard with a gradient in each cell
+	uint32 texels[TEXTURE_SIZE * TEXTURE_SIZE];
+	for(uint32 y = 0; y < TEXTURE_SIZE; y++)
+	{
+		for(uint32 x = 0; x < TEXTURE_SIZE; x++)
+		{
+			bool odd = ((x / 4) ^ (y / 4)) & 1;
+			uint32 shade = (x * 16) & 0xFF;
+			texels[(y * TEXTURE_SIZE) + x] = odd ? (0x80000000 | (shade << 8) | 0xFF) : (0x80000000 | (shade << 16));
+		}
+	}
+	gs.FeedImageData(texels, sizeof(texels));
+}
+
+//Each element is drawn in its own packet, pending primitives need to carry over to the next one
+static std::vector<WriteList> MakeScenePackets()
+{
+	std::vector<WriteList> packets;
+
+	//Background
+	{
+		WriteList writes;
+		writes.emplace_back(GS_REG_PRIM, MakePrim(CGSHandler::PRIM_SPRITE, false, false));
+		writes.emplace_back(GS_REG_RGBAQ, MakeRgbaq(0x10, 0x20, 0x40, 0x80));
+		writes.emplace_back(GS_REG_XYZ2, MakeXyz(0, 0, 0));
+		writes.emplace_back(GS_REG_XYZ2, MakeXyz(FRAME_WIDTH, FRAME_HEIGHT, 0));
+		packets.push_back(writes);
+	}
+
+	//Flat triangle
+	{
+		WriteList writes;
+		writes.emplace_back(GS_REG_PRIM, MakePrim(CGSHandler::PRIM_TRIANGLE, false, false));
+		writes.emplace_back(GS_REG_RGBAQ, MakeRgbaq(0xFF, 0x40, 0x20, 0x80));
+		writes.emplace_back(GS_REG_XYZ2, MakeXyz(8, 8, 0));
+		writes.emplace_back(GS_REG_XYZ2, MakeXyz(120, 20, 0));
+		writes.emplace_back(GS_REG_XYZ2, MakeXyz(40, 110, 0));
+		packets.push_back(writes);
+	}
+
+	//Gouraud shaded textured triangle, overlaps the flat one and crosses tile boundaries
+	{
+		WriteList writes;
+		writes.emplace_back(GS_REG_PRIM, MakePrim(CGSHandler::PRIM_TRIANGLE, true, true));
+		writes.emplace_back(GS_REG_RGBAQ, MakeRgbaq(0x80, 0x80, 0x80, 0x80));
+		writes.emplace_back(GS_REG_UV, MakeUv(0, 0));
+		writes.emplace_back(GS_REG_XYZ2, MakeXyz(60, 4, 0));
+		writes.emplace_back(GS_REG_RGBAQ, MakeRgbaq(0x40, 0x80, 0x20, 0x80));
+		writes.emplace_back(GS_REG_UV, MakeUv(32, 0));
+		writes.emplace_back(GS_REG_XYZ2, MakeXyz(250, 60, 0));
+		writes.emplace_back(GS_REG_RGBAQ, MakeRgbaq(0x20, 0x40, 0x80, 0x80));
+		writes.emplace_back(GS_REG_UV, MakeUv(0, 32));
+		writes.emplace_back(GS_REG_XYZ2, MakeXyz(90, 124, 0));
+		packets.push_back(writes);
+	}
+
+	return packets;
+}
+
+static Framebuffer DrawScene(bool singlePacket)
+{
+	auto gs = std::make_unique<CGSH_Software>();
+	gs->Initialize();
+	gs->Reset();
+	SetupDisplay(*gs);
+
+	auto setupWrites = MakeSetupWrites();
+	gs->WriteRegisterMassively(setupWrites.data(), static_cast<unsigned int>(setupWrites.size()), nullptr);
+	UploadTexture(*gs);
+
+	auto packets = MakeScenePackets();
+	if(singlePacket)
+	{
+		WriteList writes;
+		for(const auto& packet : packets)
+		{
+			writes.insert(writes.end(), packet.begin(), packet.end());
+		}
+		packets = { writes };
+	}
+	for(const auto& packet : packets)
+	{
+		gs->WriteRegisterMassively(packet.data(), static_cast<unsigned int>(packet.size()), nullptr);
+	}
+
+	Framebuffer framebuffer(FRAME_WIDTH * FRAME_HEIGHT * 3);
+	gs->ReadFramebuffer(FRAME_WIDTH, FRAME_HEIGHT, framebuffer.data());
+	gs->Release();
+	return framebuffer;
+}
+
+static uint32 HashFramebuffer(const Framebuffer& framebuffer)
+{
+	//FNV-1a
+	uint32 hash = 0x811C9DC5;
+	for(auto value : framebuffer)
+	{
+		hash ^= value;
+		hash *= 0x01000193;
+	}
+	return hash;
+}
+
+int main(int argc, const char** argv)
+{
+	auto splitFramebuffer = DrawScene(false);
+	auto singleFramebuffer = DrawScene(true);
+
+	uint32 hash = HashFramebuffer(splitFramebuffer);
+	bool hashMatches = (hash == EXPECTED_HASH);
+	bool packetsMatch = (splitFramebuffer == singleFramebuffer);
+
+	printf("Framebuffer hash 0x%08X (expected 0x%08X) - %s.\r\n", hash, EXPECTED_HASH, hashMatches ? "passed" : "failed");
+	printf("Split and single packet scenes - %s.\r\n", packetsMatch ? "passed" : "failed");
+
+	return (hashMatches && packetsMatch) ? 0 : 1;
+}
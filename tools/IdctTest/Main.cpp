@@ -0,0 +1,178 @@
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include "ee/IPU_FastIdct.h"
+
+//Accuracy test described in IEEE Std 1180-1990
+#define BLOCK_COUNT (10000)
+#define MAX_PEAK_ERROR (1)
+#define MAX_PIXEL_MSE (0.06)
+#define MAX_OVERALL_MSE (0.02)
+#define MAX_PIXEL_MEAN_ERROR (0.015)
+#define MAX_OVERALL_MEAN_ERROR (0.0015)
+
+static const double g_pi = 3.14159265358979323846;
+
+//Random number generator specified by the standard
+class CRandom
+{
+public:
+	int32 Next(int32 low, int32 high)
+	{
+		m_state = (m_state * 1103515245) + 12345;
+		int32 value = static_cast<int32>(m_state & 0x7FFFFFFE);
+		double scaled = static_cast<double>(value) / static_cast<double>(0x7FFFFFFF);
+		scaled *= (low + high + 1);
+		return static_cast<int32>(scaled) - low;
+	}
+
+private:
+	uint32 m_state = 1;
+};
+
+static double g_cosTable[8][8];
+
+static void InitCosTable()
+{
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		double scale = (i == 0) ? sqrt(0.125) : 0.5;
+		for(unsigned int j = 0; j < 8; j++)
+		{
+			g_cosTable[i][j] = scale * cos(g_pi * i * ((2.0 * j) + 1.0) / 16.0);
+		}
+	}
+}
+
+static void ForwardDct(const int16* input, int16* output)
+{
+	for(unsigned int v = 0; v < 8; v++)
+	{
+		for(unsigned int u = 0; u < 8; u++)
+		{
+			double sum = 0;
+			for(unsigned int y = 0; y < 8; y++)
+			{
+				for(unsigned int x = 0; x < 8; x++)
+				{
+					sum += g_cosTable[v][y] * g_cosTable[u][x] * input[(y * 8) + x];
+				}
+			}
+			double value = floor(sum + 0.5);
+			output[(v * 8) + u] = static_cast<int16>(std::min(std::max(value, -2048.0), 2047.0));
+		}
+	}
+}
+
+static void ReferenceIdct(const int16* input, int16* output)
+{
+	for(unsigned int y = 0; y < 8; y++)
+	{
+		for(unsigned int x = 0; x < 8; x++)
+		{
+			double sum = 0;
+			for(unsigned int v = 0; v < 8; v++)
+			{
+				for(unsigned int u = 0; u < 8; u++)
+				{
+					sum += g_cosTable[v][y] * g_cosTable[u][x] * input[(v * 8) + u];
+				}
+			}
+			double value = floor(sum + 0.5);
+			output[(y * 8) + x] = static_cast<int16>(std::min(std::max(value, -256.0), 255.0));
+		}
+	}
+}
+
+static bool RunTest(int32 low, int32 high, int32 sign)
+{
+	CRandom random;
+	int32 peakError = 0;
+	int64 errorSums[0x40] = {};
+	int64 squaredErrorSums[0x40] = {};
+
+	for(unsigned int i = 0; i < BLOCK_COUNT; i++)
+	{
+		int16 source[0x40];
+		for(unsigned int j = 0; j < 0x40; j++)
+		{
+			source[j] = static_cast<int16>(random.Next(low, high) * sign);
+		}
+
+		int16 coefficients[0x40];
+		int16 referenceResult[0x40];
+		int16 testResult[0x40];
+		ForwardDct(source, coefficients);
+		ReferenceIdct(coefficients, referenceResult);
+		IPU::CFastIdct::Transform(coefficients, testResult);
+
+		for(unsigned int j = 0; j < 0x40; j++)
+		{
+			int32 error = testResult[j] - referenceResult[j];
+			peakError = std::max(peakError, std::abs(error));
+			errorSums[j] += error;
+			squaredErrorSums[j] += error * error;
+		}
+	}
+
+	double worstPixelMse = 0;
+	double worstPixelMeanError = 0;
+	double overallMse = 0;
+	double overallMeanError = 0;
+	for(unsigned int j = 0; j < 0x40; j++)
+	{
+		double pixelMse = static_cast<double>(squaredErrorSums[j]) / BLOCK_COUNT;
+		double pixelMeanError = static_cast<double>(errorSums[j]) / BLOCK_COUNT;
+		worstPixelMse = std::max(worstPixelMse, pixelMse);
+		worstPixelMeanError = std::max(worstPixelMeanError, fabs(pixelMeanError));
+		overallMse += pixelMse;
+		overallMeanError += pixelMeanError;
+	}
+	overallMse /= 0x40;
+	overallMeanError /= 0x40;
+
+	bool succeeded =
+		(peakError <= MAX_PEAK_ERROR) &&
+		(worstPixelMse <= MAX_PIXEL_MSE) &&
+		(overallMse <= MAX_OVERALL_MSE) &&
+		(worstPixelMeanError <= MAX_PIXEL_MEAN_ERROR) &&
+		(fabs(overallMeanError) <= MAX_OVERALL_MEAN_ERROR);
+
+	printf("Range [%d, %d], sign %+d: peak error %d, pixel mse %f, overall mse %f, pixel mean error %f, overall mean error %f - %s.\r\n",
+		-low, high, sign, peakError, worstPixelMse, overallMse, worstPixelMeanError, overallMeanError,
+		succeeded ? "passed" : "failed");
+
+	return succeeded;
+}
+
+static bool RunZeroTest()
+{
+	int16 coefficients[0x40] = {};
+	int16 result[0x40];
+	IPU::CFastIdct::Transform(coefficients, result);
+	bool succeeded = std::all_of(result, result + 0x40, [] (int16 value) { return value == 0; });
+	printf("Zero input - %s.\r\n", succeeded ? "passed" : "failed");
+	return succeeded;
+}
+
+int main(int argc, const char** argv)
+{
+	InitCosTable();
+
+	static const int32 ranges[][2] =
+	{
+		{ 256, 255 },
+		{ 5, 5 },
+		{ 300, 300 },
+	};
+
+	bool succeeded = true;
+	for(const auto& range : ranges)
+	{
+		succeeded &= RunTest(range[0], range[1], 1);
+		succeeded &= RunTest(range[0], range[1], -1);
+	}
+	succeeded &= RunZeroTest();
+
+	return succeeded ? 0 : 1;
+}
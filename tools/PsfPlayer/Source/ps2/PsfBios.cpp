@@ -69,6 +69,11 @@ bool CPsfBios::IsIdle()
 	return m_bios.IsIdle();
 }
 
+uint32 CPsfBios::GetTicksUntilNextEvent()
+{
+	return m_bios.GetTicksUntilNextEvent();
+}
+
 #ifdef DEBUGGER_INCLUDED
 
 void CPsfBios::LoadDebugTags(Framework::Xml::CNode* root)
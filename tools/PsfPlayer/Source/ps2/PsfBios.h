@@ -23,6 +23,7 @@ namespace PS2
 		void						NotifyVBlankEnd() override;
 
 		bool						IsIdle() override;
+		uint32						GetTicksUntilNextEvent() override;
 
 #ifdef DEBUGGER_INCLUDED
 		void						LoadDebugTags(Framework::Xml::CNode*) override;
@@ -140,6 +140,11 @@ bool CPsxBios::IsIdle()
 	return false;
 }
 
+uint32 CPsxBios::GetTicksUntilNextEvent()
+{
+	return ~0U;
+}
+
 #ifdef DEBUGGER_INCLUDED
 
 void CPsxBios::LoadDebugTags(Framework::Xml::CNode* root)
@@ -47,6 +47,7 @@ public:
 	void						NotifyVBlankEnd() override;
 
 	bool						IsIdle() override;
+	uint32						GetTicksUntilNextEvent() override;
 
 #ifdef DEBUGGER_INCLUDED
 	void						LoadDebugTags(Framework::Xml::CNode*) override;
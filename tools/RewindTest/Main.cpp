@@ -0,0 +1,130 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "RewindBuffer.h"
+
+#define PAGE_COUNT (8)
+#define REGION_SIZE (PAGE_COUNT * CRewindBuffer::PAGE_SIZE)
+
+typedef std::vector<uint8> Memory;
+
+static uint8 g_region0[REGION_SIZE];
+static uint8 g_region1[REGION_SIZE];
+
+static void FillPage(uint8* region, unsigned int page, uint8 value)
+{
+	memset(region + (page * CRewindBuffer::PAGE_SIZE), value, CRewindBuffer::PAGE_SIZE);
+}
+
+static Memory GetMemory()
+{
+	Memory memory(g_region0, g_region0 + REGION_SIZE);
+	memory.insert(std::end(memory), g_region1, g_region1 + REGION_SIZE);
+	return memory;
+}
+
+static void Capture(CRewindBuffer& rewindBuffer, uint8 stateValue)
+{
+	uint8 state[0x10];
+	memset(state, stateValue, sizeof(state));
+	rewindBuffer.Capture(state, sizeof(state));
+}
+
+static bool CheckRestore(CRewindBuffer& rewindBuffer, const Memory& expectedMemory, uint8 expectedStateValue)
+{
+	//Scribble over everything, restore must bring back every page
+	memset(g_region0, 0xCC, REGION_SIZE);
+	memset(g_region1, 0xCC, REGION_SIZE);
+
+	CRewindBuffer::StateData state;
+	if(!rewindBuffer.Restore(state)) return false;
+	if((state.size() != 0x10) || (state[0] != expectedStateValue)) return false;
+	return GetMemory() == expectedMemory;
+}
+
+static bool RunSequenceTest()
+{
+	memset(g_region0, 0, REGION_SIZE);
+	memset(g_region1, 0, REGION_SIZE);
+
+	CRewindBuffer rewindBuffer;
+	rewindBuffer.AddRegion(g_region0, REGION_SIZE);
+	rewindBuffer.AddRegion(g_region1, REGION_SIZE);
+
+	Capture(rewindBuffer, 1);
+	auto memory1 = GetMemory();
+
+	FillPage(g_region0, 1, 0x11);
+	FillPage(g_region1, 7, 0x17);
+	Capture(rewindBuffer, 2);
+	auto memory2 = GetMemory();
+
+	FillPage(g_region0, 1, 0x21);
+	FillPage(g_region0, 2, 0x22);
+	g_region1[5] = 0x25;
+	Capture(rewindBuffer, 3);
+	auto memory3 = GetMemory();
+
+	bool succeeded = (rewindBuffer.GetSnapshotCount() == 3);
+	succeeded &= CheckRestore(rewindBuffer, memory3, 3);
+	succeeded &= CheckRestore(rewindBuffer, memory2, 2);
+
+	//Continue from the restored state
+	memcpy(g_region0, memory2.data(), REGION_SIZE);
+	memcpy(g_region1, memory2.data() + REGION_SIZE, REGION_SIZE);
+	FillPage(g_region0, 4, 0x44);
+	Capture(rewindBuffer, 4);
+	auto memory4 = GetMemory();
+
+	succeeded &= CheckRestore(rewindBuffer, memory4, 4);
+	succeeded &= CheckRestore(rewindBuffer, memory1, 1);
+
+	CRewindBuffer::StateData state;
+	succeeded &= !rewindBuffer.Restore(state);
+	succeeded &= (rewindBuffer.GetMemoryUsage() == 0);
+
+	printf("Sequence - %s.\r\n", succeeded ? "passed" : "failed");
+	return succeeded;
+}
+
+static bool RunBudgetTest()
+{
+	memset(g_region0, 0, REGION_SIZE);
+	memset(g_region1, 0, REGION_SIZE);
+
+	//Enough room for a few snapshots with two changed pages each
+	CRewindBuffer rewindBuffer(CRewindBuffer::PAGE_SIZE * 7);
+	rewindBuffer.AddRegion(g_region0, REGION_SIZE);
+	rewindBuffer.AddRegion(g_region1, REGION_SIZE);
+
+	bool succeeded = true;
+	std::vector<Memory> memories;
+	for(unsigned int i = 0; i < 32; i++)
+	{
+		FillPage(g_region0, i % PAGE_COUNT, static_cast<uint8>(i));
+		FillPage(g_region1, (i * 3) % PAGE_COUNT, static_cast<uint8>(i));
+		Capture(rewindBuffer, static_cast<uint8>(i));
+		memories.push_back(GetMemory());
+		succeeded &= (rewindBuffer.GetMemoryUsage() <= (CRewindBuffer::PAGE_SIZE * 7));
+	}
+
+	unsigned int snapshotCount = rewindBuffer.GetSnapshotCount();
+	succeeded &= (snapshotCount > 1) && (snapshotCount < 32);
+
+	for(unsigned int i = 0; i < snapshotCount; i++)
+	{
+		unsigned int index = 31 - i;
+		succeeded &= CheckRestore(rewindBuffer, memories[index], static_cast<uint8>(index));
+	}
+
+	printf("Budget (%d snapshots kept) - %s.\r\n", snapshotCount, succeeded ? "passed" : "failed");
+	return succeeded;
+}
+
+int main(int argc, const char** argv)
+{
+	bool succeeded = true;
+	succeeded &= RunSequenceTest();
+	succeeded &= RunBudgetTest();
+	return succeeded ? 0 : 1;
+}
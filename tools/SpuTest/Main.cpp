@@ -0,0 +1,242 @@
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include "iop/Iop_SpuBase.h"
+
+#define RAM_SIZE (0x200000)
+#define SAMPLE_DATA_ADDRESS (0x10000)
+#define SAMPLE_DATA_BLOCKS (0x800)
+#define REVERB_WORK_ADDRESS_START (0x100000)
+#define REVERB_WORK_ADDRESS_END (0x10FFFF)
+#define RENDER_SAMPLE_COUNT (0x2E0)
+#define RENDER_CALL_COUNT (400)
+#define SAMPLE_RATE (44100)
+
+//Expected results were produced by the sample-by-sample renderer the block renderer replaced.
+//Voices are mixed with integer arithmetic, any change to their hash means that the output of the SPU changed.
+//Reverb is computed with floats and can vary slightly with the compiler, its level is compared with a tolerance.
+#define EXPECTED_VOICE_HASH (0xF30891D8C17BF836ULL)
+#define EXPECTED_IRQ_COUNT (101)
+#define EXPECTED_REVERB_LEVEL (10251.957)
+#define REVERB_LEVEL_TOLERANCE (0.001)
+
+class CRandom
+{
+public:
+	CRandom(uint32 seed)
+		: m_state(seed)
+	{
+
+	}
+
+	uint32 Next()
+	{
+		m_state = (m_state * 1103515245) + 12345;
+		return (m_state >> 8);
+	}
+
+	uint32 Next(uint32 range)
+	{
+		return Next() % range;
+	}
+
+private:
+	uint32 m_state;
+};
+
+static void WriteSampleData(uint8* ram, CRandom& random)
+{
+	//Random ADPCM data split in segments of looping and non-looping sounds
+	for(unsigned int i = 0; i < SAMPLE_DATA_BLOCKS; i++)
+	{
+		uint8* block = ram + SAMPLE_DATA_ADDRESS + (i * 0x10);
+		uint8 shiftFactor = static_cast<uint8>(random.Next(13));
+		uint8 predictNumber = static_cast<uint8>(random.Next(5));
+		uint8 flags = 0;
+		switch(i % 0x40)
+		{
+		case 0x00:
+			flags = 0x04;
+			break;
+		case 0x1F:
+			flags = 0x01;
+			break;
+		case 0x3F:
+			flags = 0x03;
+			break;
+		}
+		block[0] = static_cast<uint8>((predictNumber << 4) | shiftFactor);
+		block[1] = flags;
+		for(unsigned int j = 2; j < 0x10; j++)
+		{
+			block[j] = static_cast<uint8>(random.Next(0x100));
+		}
+	}
+}
+
+static void SetupChannels(Iop::CSpuBase& spu, CRandom& random)
+{
+	for(unsigned int i = 0; i < Iop::CSpuBase::MAX_CHANNEL; i++)
+	{
+		auto& channel = spu.GetChannel(i);
+		uint32 segment = random.Next(SAMPLE_DATA_BLOCKS / 0x40);
+		uint32 segmentOffset = (random.Next(2) == 0) ? 0x20 : 0;
+		channel.address = SAMPLE_DATA_ADDRESS + (((segment * 0x40) + segmentOffset) * 0x10);
+		channel.repeat = channel.address;
+		channel.pitch = static_cast<uint16>(0x400 + random.Next(0x3000));
+
+		channel.adsrLevel <<= static_cast<uint16>(random.Next(0x10000));
+		channel.adsrRate <<= static_cast<uint16>(random.Next(0x10000));
+		channel.adsrRate.releaseRate = 0x10 + random.Next(0x10);
+
+		//Channel registers were cleared by Reset
+		if((i % 4) == 3)
+		{
+			//Sweep volume
+			channel.volumeLeft.sweep.mode = 1;
+			channel.volumeLeft.sweep.decrease = random.Next(2);
+			channel.volumeLeft.sweep.volume = random.Next(0x80);
+			channel.volumeRight.sweep.mode = 1;
+			channel.volumeRight.sweep.volume = random.Next(0x80);
+		}
+		else
+		{
+			channel.volumeLeft.volume.volume = random.Next(0x4000);
+			channel.volumeLeft.volume.phase = random.Next(2);
+			channel.volumeRight.volume.volume = random.Next(0x4000);
+		}
+	}
+}
+
+static void SetupReverb(Iop::CSpuBase& spu, CRandom& random)
+{
+	spu.SetReverbWorkAddressStart(REVERB_WORK_ADDRESS_START);
+	spu.SetReverbWorkAddressEnd(REVERB_WORK_ADDRESS_END);
+	for(unsigned int i = 0; i < Iop::CSpuBase::REVERB_PARAM_COUNT; i++)
+	{
+		uint32 value = 0;
+		if(Iop::CSpuBase::g_reverbParamIsAddress[i])
+		{
+			//Keep offsets inside the work area, feedback sources smaller than destinations
+			bool isFeedbackSource = (i == Iop::CSpuBase::FB_SRC_A) || (i == Iop::CSpuBase::FB_SRC_B);
+			value = isFeedbackSource ? (0x100 + random.Next(0x400)) : (0x800 + random.Next(0x7000));
+			value &= ~0x01;
+		}
+		else
+		{
+			value = random.Next(0x10000);
+		}
+		spu.SetReverbParam(i, value);
+	}
+	spu.SetChannelReverbLo(static_cast<uint16>(random.Next(0x10000)));
+	spu.SetChannelReverbHi(static_cast<uint16>(random.Next(0x100)));
+}
+
+static std::vector<int16> RenderScene(bool reverbEnabled, uint32& irqCount)
+{
+	std::vector<uint8> ram(RAM_SIZE, 0);
+	CRandom random(0x50535531);
+
+	WriteSampleData(ram.data(), random);
+
+	Iop::CSpuBase spu(ram.data(), RAM_SIZE, 0);
+	spu.Reset();
+	spu.SetControl((reverbEnabled ? Iop::CSpuBase::CONTROL_REVERB : 0) | Iop::CSpuBase::CONTROL_IRQ | 0x8000);
+	spu.SetIrqAddress(SAMPLE_DATA_ADDRESS + (0x123 * 0x10));
+	SetupChannels(spu, random);
+	SetupReverb(spu, random);
+
+	irqCount = 0;
+	std::vector<int16> output(RENDER_SAMPLE_COUNT * RENDER_CALL_COUNT);
+	for(unsigned int i = 0; i < RENDER_CALL_COUNT; i++)
+	{
+		//Key on/off channels every now and then like a sound driver would
+		if((i % 50) == 0)
+		{
+			spu.SendKeyOn(random.Next(1 << Iop::CSpuBase::MAX_CHANNEL));
+		}
+		if((i % 50) == 30)
+		{
+			spu.SendKeyOff(random.Next(1 << Iop::CSpuBase::MAX_CHANNEL));
+		}
+
+		spu.Render(output.data() + (i * RENDER_SAMPLE_COUNT), RENDER_SAMPLE_COUNT, SAMPLE_RATE);
+
+		if(spu.GetIrqPending())
+		{
+			irqCount++;
+			spu.ClearIrqPending();
+		}
+	}
+
+	return output;
+}
+
+//Reports how long rendering takes compared to the duration of the rendered sound
+static void RunBenchmark(unsigned int iterationCount)
+{
+	double renderedSeconds = static_cast<double>(RENDER_SAMPLE_COUNT * RENDER_CALL_COUNT / 2) / static_cast<double>(SAMPLE_RATE);
+	for(unsigned int reverb = 0; reverb < 2; reverb++)
+	{
+		double bestTime = HUGE_VAL;
+		for(unsigned int i = 0; i < iterationCount; i++)
+		{
+			uint32 irqCount = 0;
+			auto startTime = std::chrono::high_resolution_clock::now();
+			RenderScene(reverb != 0, irqCount);
+			auto endTime = std::chrono::high_resolution_clock::now();
+			bestTime = std::min(bestTime, std::chrono::duration<double>(endTime - startTime).count());
+		}
+		printf("Reverb %s: %f ms per second of sound.\r\n", reverb ? "on" : "off", bestTime * 1000.0 / renderedSeconds);
+	}
+}
+
+int main(int argc, const char** argv)
+{
+	if((argc >= 2) && !strcmp(argv[1], "--benchmark"))
+	{
+		unsigned int iterationCount = (argc >= 3) ? strtoul(argv[2], nullptr, 10) : 20;
+		RunBenchmark(std::max<unsigned int>(iterationCount, 1));
+		return 0;
+	}
+
+	uint32 irqCount = 0;
+	auto voiceOutput = RenderScene(false, irqCount);
+
+	uint64 voiceHash = 0xCBF29CE484222325ULL;
+	for(auto sample : voiceOutput)
+	{
+		voiceHash ^= static_cast<uint16>(sample);
+		voiceHash *= 0x100000001B3ULL;
+	}
+
+	//Reverb level is the RMS of what enabling reverb adds to the voices
+	uint32 reverbIrqCount = 0;
+	auto reverbOutput = RenderScene(true, reverbIrqCount);
+
+	double reverbSquareSum = 0;
+	for(size_t i = 0; i < reverbOutput.size(); i++)
+	{
+		double difference = static_cast<double>(reverbOutput[i]) - static_cast<double>(voiceOutput[i]);
+		reverbSquareSum += difference * difference;
+	}
+	double reverbLevel = sqrt(reverbSquareSum / reverbOutput.size());
+
+	printf("Voice hash: 0x%016llX, IRQ count: %d, reverb level: %f.\r\n", static_cast<unsigned long long>(voiceHash), irqCount, reverbLevel);
+
+	bool succeeded =
+		(voiceHash == EXPECTED_VOICE_HASH) &&
+		(irqCount == EXPECTED_IRQ_COUNT) &&
+		(fabs(reverbLevel - EXPECTED_REVERB_LEVEL) <= (EXPECTED_REVERB_LEVEL * REVERB_LEVEL_TOLERANCE));
+	if(!succeeded)
+	{
+		printf("Failed: Expected voice hash 0x%016llX, IRQ count: %d, reverb level: %f.\r\n", EXPECTED_VOICE_HASH, EXPECTED_IRQ_COUNT, EXPECTED_REVERB_LEVEL);
+		return 1;
+	}
+
+	return 0;
+}
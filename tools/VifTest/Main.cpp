@@ -0,0 +1,323 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "Ps2Const.h"
+#include "MIPS.h"
+#include "ee/GIF.h"
+#include "ee/Vpu.h"
+#include "ee/Vif.h"
+
+//Runs UNPACK commands through the VIF with their data starting at every alignment and split
+//across several DMA transfers, then compares VU memory with an element by element reference
+//that follows what the VIF did before it read from the stream's memory directly
+
+#define VU_ADDRESS (8)
+#define UNPACK_NUM (50)
+
+enum
+{
+	MODE_OFFSET = 1,
+	MODE_DIFFERENCE = 2,
+};
+
+struct UNPACK_TEST
+{
+	uint8		dataType;
+	bool		usn;
+	bool		useMask;
+	uint32		mode;
+	uint32		cl;
+	uint32		wl;
+	uint32		padWords;
+};
+
+struct REFSTATE
+{
+	uint32		row[4];
+	uint32		col[4];
+	uint32		mask;
+};
+
+static const uint8 g_dataTypes[] =
+{
+	0x00, 0x01, 0x02,
+	0x04, 0x05, 0x06,
+	0x08, 0x09, 0x0A,
+	0x0C, 0x0D, 0x0E,
+	0x0F,
+};
+
+static const uint32 g_cycles[][2] =
+{
+	{ 4, 4 },
+	{ 4, 2 },
+	{ 2, 4 },
+};
+
+static uint32 GetElementSize(uint8 dataType)
+{
+	if(dataType == 0x0F) return 2;
+	return (4 >> (dataType & 0x03)) * ((dataType >> 2) + 1);
+}
+
+static uint32 GetReadCount(const UNPACK_TEST& test)
+{
+	if(test.cl >= test.wl) return UNPACK_NUM;
+	return ((UNPACK_NUM / test.wl) * test.cl) + std::min<uint32>(UNPACK_NUM % test.wl, test.cl);
+}
+
+static void ReadReferenceValue(const UNPACK_TEST& test, const uint8*& src, uint128& result)
+{
+	if(test.dataType == 0x0F)
+	{
+		uint16 color = 0;
+		memcpy(&color, src, 2);
+		src += 2;
+		result.nV0 = ((color >>  0) & 0x1F) << 3;
+		result.nV1 = ((color >>  5) & 0x1F) << 3;
+		result.nV2 = ((color >> 10) & 0x1F) << 3;
+		result.nV3 = ((color >> 15) & 0x01) << 7;
+		return;
+	}
+
+	unsigned int fieldCount = (test.dataType >> 2) + 1;
+	for(unsigned int i = 0; i < fieldCount; i++)
+	{
+		uint32 value = 0;
+		switch(test.dataType & 0x03)
+		{
+		case 0:
+			memcpy(&value, src, 4);
+			src += 4;
+			break;
+		case 1:
+			memcpy(&value, src, 2);
+			src += 2;
+			if(!test.usn) value = static_cast<int16>(value);
+			break;
+		case 2:
+			memcpy(&value, src, 1);
+			src += 1;
+			if(!test.usn) value = static_cast<int8>(value);
+			break;
+		}
+		result.nV[i] = value;
+	}
+
+	if(fieldCount == 1)
+	{
+		result.nV1 = result.nV0;
+		result.nV2 = result.nV0;
+		result.nV3 = result.nV0;
+	}
+}
+
+static void ReferenceUnpack(const UNPACK_TEST& test, REFSTATE state, const uint8* src, uint8* vuMem)
+{
+	uint32 readTick = 0;
+	uint32 writeTick = 0;
+	uint32 dstAddr = VU_ADDRESS * 0x10;
+	uint32 currentNum = UNPACK_NUM;
+	while(currentNum != 0)
+	{
+		bool mustWrite = false;
+		uint128 writeValue;
+		memset(&writeValue, 0, sizeof(writeValue));
+
+		if(test.cl >= test.wl)
+		{
+			if(readTick < test.wl)
+			{
+				ReadReferenceValue(test, src, writeValue);
+				mustWrite = true;
+			}
+		}
+		else
+		{
+			if(writeTick < test.cl)
+			{
+				ReadReferenceValue(test, src, writeValue);
+			}
+			mustWrite = true;
+		}
+
+		if(mustWrite)
+		{
+			auto dst = reinterpret_cast<uint128*>(vuMem + dstAddr);
+			for(unsigned int i = 0; i < 4; i++)
+			{
+				uint32 maskOp = 0;
+				if(test.useMask)
+				{
+					unsigned int col = std::min<uint32>(writeTick, 3);
+					maskOp = (state.mask >> (((col * 4) + i) * 2)) & 0x03;
+				}
+				switch(maskOp)
+				{
+				case 0:
+					if(test.mode == MODE_OFFSET)
+					{
+						writeValue.nV[i] += state.row[i];
+					}
+					else if(test.mode == MODE_DIFFERENCE)
+					{
+						writeValue.nV[i] += state.row[i];
+						state.row[i] = writeValue.nV[i];
+					}
+					dst->nV[i] = writeValue.nV[i];
+					break;
+				case 1:
+					dst->nV[i] = state.row[i];
+					break;
+				case 2:
+					dst->nV[i] = state.col[std::min<uint32>(writeTick, 3)];
+					break;
+				case 3:
+					break;
+				}
+			}
+			currentNum--;
+		}
+
+		writeTick = std::min<uint32>(writeTick + 1, test.wl);
+		readTick = std::min<uint32>(readTick + 1, test.cl);
+		if(((test.cl >= test.wl) && (readTick == test.cl)) || ((test.cl < test.wl) && (writeTick == test.wl)))
+		{
+			writeTick = 0;
+			readTick = 0;
+		}
+
+		dstAddr += 0x10;
+		dstAddr &= (PS2::VUMEM0SIZE - 1);
+	}
+}
+
+static std::vector<uint32> MakePacket(const UNPACK_TEST& test, const REFSTATE& state, const std::vector<uint8>& data)
+{
+	std::vector<uint32> packet;
+	packet.push_back(0x30 << 24);
+	packet.insert(std::end(packet), std::begin(state.row), std::end(state.row));
+	packet.push_back(0x31 << 24);
+	packet.insert(std::end(packet), std::begin(state.col), std::end(state.col));
+	packet.push_back(0x20 << 24);
+	packet.push_back(state.mask);
+	packet.push_back((0x05 << 24) | test.mode);
+	packet.push_back((0x01 << 24) | (test.wl << 8) | test.cl);
+	packet.insert(std::end(packet), test.padWords, 0);
+
+	uint32 command = 0x60 | (test.useMask ? 0x10 : 0) | test.dataType;
+	packet.push_back((command << 24) | (UNPACK_NUM << 16) | (test.usn ? 0x4000 : 0) | VU_ADDRESS);
+	size_t dataOffset = packet.size();
+	packet.resize(dataOffset + ((data.size() + 3) / 4));
+	memcpy(packet.data() + dataOffset, data.data(), data.size());
+
+	//DMA transfers whole quadwords, pad with NOPs
+	packet.resize((packet.size() + 3) & ~3);
+	return packet;
+}
+
+static std::vector<UNPACK_TEST> MakeTests()
+{
+	std::vector<UNPACK_TEST> tests;
+	for(auto dataType : g_dataTypes)
+	{
+		for(const auto& cycle : g_cycles)
+		{
+			for(uint32 flags = 0; flags < 4; flags++)
+			{
+				for(uint32 mode = 0; mode < 3; mode++)
+				{
+					for(uint32 padWords = 0; padWords < 4; padWords++)
+					{
+						UNPACK_TEST test;
+						test.dataType = dataType;
+						test.usn = (flags & 1) != 0;
+						test.useMask = (flags & 2) != 0;
+						test.mode = mode;
+						test.cl = cycle[0];
+						test.wl = cycle[1];
+						test.padWords = padWords;
+						tests.push_back(test);
+					}
+				}
+			}
+		}
+	}
+	return tests;
+}
+
+static bool Transfer(CVif& vif, uint32 qwc, uint32 chunkSize)
+{
+	uint32 address = 0;
+	while(qwc != 0)
+	{
+		uint32 transferred = vif.ReceiveDMA(address, std::min(qwc, chunkSize), 0, false);
+		if(transferred == 0) return false;
+		address += transferred * 0x10;
+		qwc -= transferred;
+	}
+	return true;
+}
+
+int main(int argc, const char** argv)
+{
+	std::vector<uint8> ram(PS2::EE_RAM_SIZE);
+	std::vector<uint8> spr(PS2::EE_SPR_SIZE);
+	std::vector<uint8> vuMem(PS2::VUMEM0SIZE);
+	std::vector<uint8> microMem(PS2::MICROMEM0SIZE);
+	std::vector<uint8> expectedVuMem(PS2::VUMEM0SIZE);
+
+	CMIPS context(MEMORYMAP_ENDIAN_LSBF);
+	CGSHandler* gs = nullptr;
+	CGIF gif(gs, ram.data(), spr.data());
+	CVpu vpu(0, CVpu::VPUINIT(microMem.data(), vuMem.data(), &context), gif, ram.data(), spr.data());
+
+	REFSTATE state;
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		state.row[i] = 0x10000 * (i + 1);
+		state.col[i] = 0xC0000000 | i;
+	}
+	state.mask = 0x1B6C93E4;
+
+	uint32 seed = 1;
+	unsigned int failureCount = 0;
+	unsigned int testCount = 0;
+	for(const auto& test : MakeTests())
+	{
+		std::vector<uint8> data(GetReadCount(test) * GetElementSize(test.dataType));
+		for(auto& value : data)
+		{
+			seed = (seed * 1103515245) + 12345;
+			value = static_cast<uint8>(seed >> 16);
+		}
+
+		std::fill(std::begin(expectedVuMem), std::end(expectedVuMem), 0);
+		ReferenceUnpack(test, state, data.data(), expectedVuMem.data());
+
+		auto packet = MakePacket(test, state, data);
+		memcpy(ram.data(), packet.data(), packet.size() * 4);
+		uint32 qwc = static_cast<uint32>(packet.size() / 4);
+
+		//Whole packet in one transfer, then one quadword per transfer to split elements across transfers
+		const uint32 chunkSizes[] = { qwc, 1 };
+		for(auto chunkSize : chunkSizes)
+		{
+			vpu.Reset();
+			std::fill(std::begin(vuMem), std::end(vuMem), 0);
+
+			bool succeeded = Transfer(vpu.GetVif(), qwc, chunkSize) && (vuMem == expectedVuMem);
+			if(!succeeded)
+			{
+				printf("UNPACK 0x%02X (usn %d, mask %d, mode %d, cl %d, wl %d, pad %d, chunk %d) - failed.\r\n",
+					test.dataType, test.usn, test.useMask, test.mode, test.cl, test.wl, test.padWords, chunkSize);
+				failureCount++;
+			}
+			testCount++;
+		}
+	}
+
+	printf("%d/%d tests passed.\r\n", testCount - failureCount, testCount);
+	return (failureCount == 0) ? 0 : 1;
+}